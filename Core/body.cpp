@@ -10,28 +10,45 @@ namespace CrashAndSqueeze
 
     namespace Core
     {
-        // creates rigid body from all given vertices
-        Body::Body(PhysicalVertexArray &all_vertices)
-            : vertices(all_vertices.size())
+        namespace
         {
-            set_initial_values();
+            // Sums `items_num` items in a fixed order of a binary tree: halves are summed separately
+            // and then added, so that rounding errors grow slower than in a sum from left to right
+            template<class T>
+            T tree_sum(const T * items, int items_num)
+            {
+                if(items_num <= 0)
+                    return T::ZERO;
+                if(1 == items_num)
+                    return items[0];
 
-            for(int i = 0; i < all_vertices.size(); ++i)
-                add_vertex(all_vertices[i]);
+                int half = items_num/2;
+                return tree_sum(items, half) + tree_sum(items + half, items_num - half);
+            }
+        }
 
-            vertices.freeze();
+        // creates rigid body from all vertices of the store
+        Body::Body(PhysicalVertexStore &store)
+            : store(&store), indices(NULL), vertices_count(store.get_size())
+        {
+            set_initial_values();
         }
         
-        // creates rigid body only from vertices defined by body_indices
-        Body::Body(PhysicalVertexArray &all_vertices, const IndexArray &body_indices)
-            : vertices(body_indices.size())
+        // creates rigid body only from vertices of the store defined by body_indices
+        Body::Body(PhysicalVertexStore &store, const IndexArray &body_indices)
+            : store(&store), indices(NULL), vertices_count(body_indices.size())
         {
-            set_initial_values();
-
-            for(int i = 0; i < body_indices.size(); ++i)
-                add_vertex(all_vertices[ body_indices[i] ]);
+            indices = new int[vertices_count];
+            for(int i = 0; i < vertices_count; ++i)
+            {
+                if(body_indices[i] < 0 || body_indices[i] >= store.get_size())
+                {
+                    Logger::error("in Body::Body: vertex index out of range", __FILE__, __LINE__);
+                }
+                indices[i] = body_indices[i];
+            }
 
-            vertices.freeze();
+            set_initial_values();
         }
 
         void Body::set_initial_values()
@@ -43,12 +60,10 @@ namespace CrashAndSqueeze
               angular_velocity = Vector::ZERO;
               linear_velocity_addition = Vector::ZERO;
               angular_velocity_addition = Vector::ZERO;
-        }
 
-        void Body::add_vertex(PhysicalVertex &v)
-        {
-            vertices.push_back( &v );
-            total_mass += v.get_mass();
+              const Real * masses = store->get_masses();
+              for(int i = 0; i < vertices_count; ++i)
+                  total_mass += masses[vertex_index(i)];
         }
 
         bool Body::check_total_mass() const
@@ -65,49 +80,96 @@ namespace CrashAndSqueeze
         {
             if( false == check_total_mass() )
                 return false;
-            
-            center_of_mass = Vector::ZERO;
-            for(int i = 0; i < vertices.size(); ++i)
+
+            Vector center_of_mass_sum = sum_center_of_mass(0, vertices_count);
+            if( false == set_center_of_mass(&center_of_mass_sum, 1) )
+                return false;
+
+            Matrix inertia_tensor_sum = sum_inertia_tensor(0, vertices_count);
+            set_inertia_tensor(&inertia_tensor_sum, 1);
+            return true;
+        }
+
+        Vector Body::sum_center_of_mass(int start_vertex, int vertices_num) const
+        {
+            const Vector * positions = store->get_positions();
+            const Real * masses = store->get_masses();
+
+            Vector sum = Vector::ZERO;
+            for(int i = start_vertex; i < start_vertex + vertices_num; ++i)
             {
-                const PhysicalVertex &v = *vertices[i];
+                int v = vertex_index(i);
                 
-                center_of_mass += v.get_pos()*(v.get_mass()/total_mass);
+                sum += positions[v]*(masses[v]/total_mass);
             }
+            return sum;
+        }
+
+        bool Body::set_center_of_mass(const Vector * center_of_mass_sums, int parts_num)
+        {
+            if( false == check_total_mass() )
+                return false;
 
-            inertia_tensor = Matrix::ZERO;
-            for(int i = 0; i < vertices.size(); ++i)
+            center_of_mass = tree_sum(center_of_mass_sums, parts_num);
+            return true;
+        }
+
+        Matrix Body::sum_inertia_tensor(int start_vertex, int vertices_num) const
+        {
+            const Vector * positions = store->get_positions();
+            const Real * masses = store->get_masses();
+
+            Matrix sum = Matrix::ZERO;
+            for(int i = start_vertex; i < start_vertex + vertices_num; ++i)
             {
-                const PhysicalVertex &v = *vertices[i];
-                Vector offset = v.get_pos() - center_of_mass;
+                int v = vertex_index(i);
+                Vector offset = positions[v] - center_of_mass;
                 
-                inertia_tensor += v.get_mass() * ( (offset*offset)*Matrix::IDENTITY - Matrix(offset, offset) );
+                sum += masses[v] * ( (offset*offset)*Matrix::IDENTITY - Matrix(offset, offset) );
             }
+            return sum;
+        }
 
-            return true;
+        void Body::set_inertia_tensor(const Matrix * inertia_tensor_sums, int parts_num)
+        {
+            inertia_tensor = tree_sum(inertia_tensor_sums, parts_num);
         }
 
-        bool Body::abstract_compute_velocities(VelocityFunc velocity_func,
-                                               /*out*/ Vector & res_velocity,
-                                               /*out*/ Vector & res_angular_velocity)
+        void Body::abstract_sum_velocities(const Vector * velocities, int start_vertex, int vertices_num,
+                                           /*out*/ Vector & linear_velocity_sum,
+                                           /*out*/ Vector & angular_momentum_sum) const
         {
-            if( false == check_total_mass() )
-                return false;
+            const Vector * positions = store->get_positions();
+            const Real * masses = store->get_masses();
 
-            res_velocity = Vector::ZERO;
-            Vector angular_momentum = Vector::ZERO;
+            linear_velocity_sum = Vector::ZERO;
+            angular_momentum_sum = Vector::ZERO;
             
-            for(int i = 0; i < vertices.size(); ++i)
+            for(int i = start_vertex; i < start_vertex + vertices_num; ++i)
             {
-                const PhysicalVertex &vertex = *vertices[i];
-                const Vector &velocity = (vertex.*velocity_func)();
+                int v = vertex_index(i);
+                const Vector &velocity = velocities[v];
                 
-                res_velocity += velocity*(vertex.get_mass()/total_mass);
-                angular_momentum += vertex.get_mass() * cross_product(vertex.get_pos() - center_of_mass, velocity);
+                linear_velocity_sum += velocity*(masses[v]/total_mass);
+                angular_momentum_sum += masses[v] * cross_product(positions[v] - center_of_mass, velocity);
             }
+        }
+
+        bool Body::abstract_set_velocities(const Vector * linear_velocity_sums,
+                                           const Vector * angular_momentum_sums,
+                                           int parts_num,
+                                           /*out*/ Vector & res_velocity,
+                                           /*out*/ Vector & res_angular_velocity)
+        {
+            if( false == check_total_mass() )
+                return false;
+
+            res_velocity = tree_sum(linear_velocity_sums, parts_num);
+            Vector angular_momentum = tree_sum(angular_momentum_sums, parts_num);
 
             if( ! inertia_tensor.is_invertible() )
             {
-                Logger::error("in Body::abstract_compute_velocities: inertia_tensor is singular, cannot invert to find angular velocity", __FILE__, __LINE__);
+                Logger::error("in Body::abstract_set_velocities: inertia_tensor is singular, cannot invert to find angular velocity", __FILE__, __LINE__);
                 return false;
             }
             res_angular_velocity = inertia_tensor.inverted()*angular_momentum;
@@ -117,34 +179,80 @@ namespace CrashAndSqueeze
         // computes velocity of center of mass and angular velocity
         bool Body::compute_velocities()
         {
-            return abstract_compute_velocities(&PhysicalVertex::get_velocity,
-                                               linear_velocity,
-                                               angular_velocity);
+            Vector linear_velocity_sum, angular_momentum_sum;
+            sum_velocities(0, vertices_count, linear_velocity_sum, angular_momentum_sum);
+            return set_velocities(&linear_velocity_sum, &angular_momentum_sum, 1);
         }
 
         // computes additions of velocity of center of mass and angular velocity
         bool Body::compute_velocity_additions()
         {
-            for(int i = 0; i < vertices.size(); ++i)
+            Vector linear_velocity_sum, angular_momentum_sum;
+            if( false == sum_velocity_additions(0, vertices_count, linear_velocity_sum, angular_momentum_sum) )
+                return false;
+            return set_velocity_additions(&linear_velocity_sum, &angular_momentum_sum, 1);
+        }
+
+        void Body::sum_velocities(int start_vertex, int vertices_num,
+                                  /*out*/ Vector & linear_velocity_sum,
+                                  /*out*/ Vector & angular_momentum_sum) const
+        {
+            abstract_sum_velocities(store->get_velocities(), start_vertex, vertices_num,
+                                    linear_velocity_sum, angular_momentum_sum);
+        }
+
+        bool Body::set_velocities(const Vector * linear_velocity_sums, const Vector * angular_momentum_sums, int parts_num)
+        {
+            return abstract_set_velocities(linear_velocity_sums, angular_momentum_sums, parts_num,
+                                           linear_velocity, angular_velocity);
+        }
+
+        bool Body::sum_velocity_additions(int start_vertex, int vertices_num,
+                                          /*out*/ Vector & linear_velocity_sum,
+                                          /*out*/ Vector & angular_momentum_sum)
+        {
+            if(NULL == indices)
             {
-                if(false == vertices[i]->compute_velocity_addition())
+                if(false == store->compute_velocity_additions(start_vertex, vertices_num))
                     return false;
             }
+            else
+            {
+                for(int i = start_vertex; i < start_vertex + vertices_num; ++i)
+                {
+                    if(false == store->compute_velocity_additions(indices[i], 1))
+                        return false;
+                }
+            }
 
-            return abstract_compute_velocities(&PhysicalVertex::get_velocity_addition,
-                                               linear_velocity_addition,
-                                               angular_velocity_addition);
+            abstract_sum_velocities(store->get_velocity_additions(), start_vertex, vertices_num,
+                                    linear_velocity_sum, angular_momentum_sum);
+            return true;
+        }
+
+        bool Body::set_velocity_additions(const Vector * linear_velocity_sums, const Vector * angular_momentum_sums, int parts_num)
+        {
+            return abstract_set_velocities(linear_velocity_sums, angular_momentum_sums, parts_num,
+                                           linear_velocity_addition, angular_velocity_addition);
         }
         
         // compensates given linear and angular velocity 
         void Body::compensate_velocities(const Math::Vector &linear, const Math::Vector &angular)
         {
-            for(int i = 0; i < vertices.size(); ++i)
+            compensate_velocities(linear, angular, 0, vertices_count);
+        }
+
+        void Body::compensate_velocities(const Math::Vector &linear, const Math::Vector &angular, int start_vertex, int vertices_num)
+        {
+            const Vector * positions = store->get_positions();
+            Vector * velocities = store->get_velocities();
+
+            for(int i = start_vertex; i < start_vertex + vertices_num; ++i)
             {
-                PhysicalVertex &v = *vertices[i];
+                int v = vertex_index(i);
 
-                Vector correction = - linear - v.angular_velocity_to_linear(angular, center_of_mass);
-                v.add_to_velocity(correction);
+                Vector correction = - linear - cross_product(angular, positions[v] - center_of_mass);
+                velocities[v] += correction;
             }
         }
 
@@ -152,16 +260,28 @@ namespace CrashAndSqueeze
         
         void Body::set_rigid_motion(const IBody & body, Real coeff)
         {
-            for(int i = 0; i < vertices.size(); ++i)
+            set_rigid_motion(body, coeff, 0, vertices_count);
+        }
+
+        void Body::set_rigid_motion(const IBody & body, Real coeff, int start_vertex, int vertices_num)
+        {
+            const Vector * positions = store->get_positions();
+            Vector * velocities = store->get_velocities();
+
+            for(int i = start_vertex; i < start_vertex + vertices_num; ++i)
             {
-                PhysicalVertex &v = *vertices[i];
+                int v = vertex_index(i);
 
                 Vector rigid_velocity = body.get_linear_velocity()
-                                      + v.angular_velocity_to_linear(body.get_angular_velocity(),
-                                                                     body.get_position());
+                                      + cross_product(body.get_angular_velocity(), positions[v] - body.get_position());
 
-                v.set_velocity( coeff*rigid_velocity + (1 - coeff)*v.get_velocity() );
+                velocities[v] = coeff*rigid_velocity + (1 - coeff)*velocities[v];
             }
         }
+
+        Body::~Body()
+        {
+            delete[] indices;
+        }
     }
 }
@@ -12,7 +12,11 @@ namespace CrashAndSqueeze
         class Body : public IBody
         {
         private:
-            Collections::Array<PhysicalVertex *> vertices;
+            // vertices are read directly from streams of the store
+            PhysicalVertexStore * store;
+            // indices of vertices of the body in the store, or NULL if the body consists of all vertices of the store
+            int * indices;
+            int vertices_count;
 
             Math::Real total_mass;
             
@@ -28,24 +32,31 @@ namespace CrashAndSqueeze
             // -- init steps -- 
             
             void set_initial_values();
-            void add_vertex(PhysicalVertex &v);
             
             // -- internal helpers --
+
+            // index in the store of i'th vertex of the body
+            int vertex_index(int i) const { return (NULL == indices) ? i : indices[i]; }
             
             // self-control check
             bool check_total_mass() const;
 
-            typedef const Math::Vector & (PhysicalVertex::*VelocityFunc)() const;
-            // common code for compute_velocities and compute_velocities_additions
-            bool abstract_compute_velocities(VelocityFunc velocity_func,
-                                             /*out*/ Math::Vector & res_linear_velocity,
-                                             /*out*/ Math::Vector & res_angular_velocity);
+            // common code for sum_velocities and sum_velocity_additions (given stream of velocities from the store)
+            void abstract_sum_velocities(const Math::Vector * velocities, int start_vertex, int vertices_num,
+                                         /*out*/ Math::Vector & linear_velocity_sum,
+                                         /*out*/ Math::Vector & angular_momentum_sum) const;
+            // common code for set_velocities and set_velocity_additions
+            bool abstract_set_velocities(const Math::Vector * linear_velocity_sums,
+                                         const Math::Vector * angular_momentum_sums,
+                                         int parts_num,
+                                         /*out*/ Math::Vector & res_linear_velocity,
+                                         /*out*/ Math::Vector & res_angular_velocity);
 
         public:
-            // creates rigid body from all given vertices
-            Body(PhysicalVertexArray &all_vertices);
-            // creates rigid body only from vertices defined by body_indices
-            Body(PhysicalVertexArray &all_vertices, const IndexArray &body_indices);
+            // creates rigid body from all vertices of the store
+            Body(PhysicalVertexStore &store);
+            // creates rigid body only from vertices of the store defined by body_indices
+            Body(PhysicalVertexStore &store, const IndexArray &body_indices);
 
             // computes center of mass and inertia tensor
             bool compute_properties();
@@ -67,6 +78,39 @@ namespace CrashAndSqueeze
             // enforces rigid motion of body itself
             void set_rigid_motion(Math::Real coeff = MAX_RIGIDITY_COEFF) { set_rigid_motion(*this, coeff); }
 
+            // -- Computing in parts (for parallel computation) --
+            // Methods taking `start_vertex` and `vertices_num` process only this part of vertices of the body,
+            // so that different parts can be processed simultaneously. Methods named sum_* return
+            // sums over the part, and methods taking arrays of `parts_num` such sums combine them
+            // in a fixed order: pairwise, as a binary tree over parts (so the result doesn't depend
+            // on the order parts were computed in, only on their number).
+            // Methods above are equivalent to processing the whole body as one part.
+
+            int get_vertices_num() const { return vertices_count; }
+
+            // sum of mass-weighted positions divided by total mass
+            Math::Vector sum_center_of_mass(int start_vertex, int vertices_num) const;
+            bool set_center_of_mass(const Math::Vector * center_of_mass_sums, int parts_num);
+
+            // sum of inertia tensors of vertices (relative to center of mass, which should be already set)
+            Math::Matrix sum_inertia_tensor(int start_vertex, int vertices_num) const;
+            void set_inertia_tensor(const Math::Matrix * inertia_tensor_sums, int parts_num);
+
+            // sums of mass-weighted velocities divided by total mass and of angular momenta (relative to center of mass)
+            void sum_velocities(int start_vertex, int vertices_num,
+                                /*out*/ Math::Vector & linear_velocity_sum,
+                                /*out*/ Math::Vector & angular_momentum_sum) const;
+            bool set_velocities(const Math::Vector * linear_velocity_sums, const Math::Vector * angular_momentum_sums, int parts_num);
+
+            // the same for velocity additions: computes velocity additions of vertices first
+            bool sum_velocity_additions(int start_vertex, int vertices_num,
+                                        /*out*/ Math::Vector & linear_velocity_sum,
+                                        /*out*/ Math::Vector & angular_momentum_sum);
+            bool set_velocity_additions(const Math::Vector * linear_velocity_sums, const Math::Vector * angular_momentum_sums, int parts_num);
+
+            void compensate_velocities(const Math::Vector &linear, const Math::Vector &angular, int start_vertex, int vertices_num);
+            void set_rigid_motion(const IBody & body, Math::Real coeff, int start_vertex, int vertices_num);
+
             Math::Real get_total_mass() const { return total_mass; }
             const Math::Vector & get_center_of_mass() const { return center_of_mass; }
             const Math::Matrix & get_inertia_tensor() const { return inertia_tensor; }
@@ -75,6 +119,13 @@ namespace CrashAndSqueeze
             virtual /*override*/ const Math::Vector & get_angular_velocity() const { return angular_velocity; }
             const Math::Vector & get_linear_velocity_addition() const { return linear_velocity_addition; }
             const Math::Vector & get_angular_velocity_addition() const { return angular_velocity_addition; }
+
+            ~Body();
+
+        private:
+            // No copying!
+            Body(const Body &);
+            Body & operator=(const Body &);
         };
     }
 }
@@ -1,4 +1,5 @@
 #include "Core/cluster.h"
+#include "Core/regions.h"
 #include <cstring>
 #include <cstdio>
 
@@ -13,10 +14,11 @@ namespace CrashAndSqueeze
     using Math::cube_root;
     using Math::Vector;
     using Math::Matrix;
+    using Math::VECTOR_SIZE;
 #if CAS_QUADRATIC_EXTENSIONS_ENABLED
+    using Math::COMPONENTS_NUM;
     using Math::TriVector;
     using Math::TriMatrix;
-    using Math::NineMatrix;
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
 
     
@@ -50,12 +52,22 @@ namespace CrashAndSqueeze
 
         // plasticity paramter: a threshold of maximum allowed strain
         const Real Cluster::DEFAULT_MAX_DEFORMATION_CONSTANT = 1.5;
+
+        // maximum number of iterations of warm-started rotation extraction:
+        // 0 means full polar decomposition
+        const int Cluster::DEFAULT_ROTATION_EXTRACTION_ITERATIONS = 0;
+
+        // sleeping parameters: sleeping slightly changes motion of idle parts, so that
+        // it is disabled by default (0 steps), while thresholds correspond to speeds about 1 mm/s
+        const int Cluster::DEFAULT_SLEEP_STEPS = 0;
+        const Real Cluster::DEFAULT_SLEEP_ENERGY_CONSTANT = 1e-6;
+        const Real Cluster::DEFAULT_SLEEP_PLASTICITY_CONSTANT = 1e-6;
         
         void PhysicalVertexMappingInfo::setup_initial_values(const Vector & center_of_mass)
         {
             initial_offset_pos = vertex->get_pos() - center_of_mass;
             equilibrium_offset_pos = initial_offset_pos;
-            equilibrium_pos = vertex->get_pos();
+            vertex->set_equilibrium_pos(vertex->get_pos(), addition_index);
         }
 
         void GraphicalVertexMappingInfo::setup_initial_values(const Vector & center_of_mass)
@@ -70,10 +82,44 @@ namespace CrashAndSqueeze
             previous_state = *vertex;
         }
 
+        namespace
+        {
+            // writes `matrix` to columns starting from `first_column` of a row-major matrix `values`
+            void to_row_major(const Matrix & matrix, /*out*/ Real * values, int columns_num = VECTOR_SIZE, int first_column = 0)
+            {
+                for(int i = 0; i < VECTOR_SIZE; ++i)
+                    for(int j = 0; j < VECTOR_SIZE; ++j)
+                        values[i*columns_num + first_column + j] = matrix.get_at(i, j);
+            }
+
+            // reads `matrix` from columns starting from `first_column` of a row-major matrix `values`
+            void from_row_major(const Real * values, /*out*/ Matrix & matrix, int columns_num = VECTOR_SIZE, int first_column = 0)
+            {
+                for(int i = 0; i < VECTOR_SIZE; ++i)
+                    for(int j = 0; j < VECTOR_SIZE; ++j)
+                        matrix.set_at(i, j, values[i*columns_num + first_column + j]);
+            }
+
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            void to_row_major(const TriMatrix & matrix, /*out*/ Real * values)
+            {
+                for(int i = 0; i < COMPONENTS_NUM; ++i)
+                    to_row_major(matrix.matrices[i], values, VECTOR_SIZE*COMPONENTS_NUM, i*VECTOR_SIZE);
+            }
+
+            void from_row_major(const Real * values, /*out*/ TriMatrix & matrix)
+            {
+                for(int i = 0; i < COMPONENTS_NUM; ++i)
+                    from_row_major(values, matrix.matrices[i], VECTOR_SIZE*COMPONENTS_NUM, i*VECTOR_SIZE);
+            }
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+        }
+
         // -- Cluster methods --
 
         Cluster::Cluster()
             : physical_vertex_infos(INITIAL_ALLOCATED_VERTICES_NUM),
+              vertices_store(NULL),
               initial_characteristics_computed(true),
 
               total_mass(0),
@@ -87,6 +133,14 @@ namespace CrashAndSqueeze
               qx_creep_constant(DEFAULT_QX_CREEP_CONSTANT),
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED && CAS_QUADRATIC_PLASTICITY_ENABLED
               max_deformation_constant(DEFAULT_MAX_DEFORMATION_CONSTANT),
+              rotation_extraction_iterations(DEFAULT_ROTATION_EXTRACTION_ITERATIONS),
+              sleep_steps_constant(DEFAULT_SLEEP_STEPS),
+              sleep_energy_constant(DEFAULT_SLEEP_ENERGY_CONSTANT),
+              sleep_plasticity_constant(DEFAULT_SLEEP_PLASTICITY_CONSTANT),
+
+              sleeping(false),
+              idle_steps(0),
+              previous_plastic_deformation_measure(0),
 
               center_of_mass(Vector::ZERO),
               rotation(Matrix::IDENTITY),
@@ -101,18 +155,33 @@ namespace CrashAndSqueeze
               plasticity_state(Matrix::IDENTITY),
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED && CAS_QUADRATIC_PLASTICITY_ENABLED
               plasticity_state_inv_trans(Matrix::IDENTITY),
-              plastic_deformation_measure(0)
+              plastic_deformation_measure(0),
+
+              kernels(&ClusterKernels::get_best()),
+              streams_buffer(NULL),
+              vertex_masses(NULL)
         {
         }
 
         void Cluster::add_physical_vertex(PhysicalVertex &vertex)
         {
+            if(NULL == vertices_store)
+            {
+                vertices_store = &vertex.get_store();
+            }
+            else if(vertices_store != &vertex.get_store())
+            {
+                Logger::error("in Cluster::add_physical_vertex: all vertices of cluster must be in the same PhysicalVertexStore", __FILE__, __LINE__);
+                return;
+            }
+
             // update mass
             total_mass += vertex.get_mass();
 
             // add new vertex
             PhysicalVertexMappingInfo & info = physical_vertex_infos.create_item();
             info.vertex = &vertex;
+            info.vertex_index = vertex.get_index();
             
             // set addition index
             info.addition_index = vertex.get_next_addition_index();
@@ -133,6 +202,7 @@ namespace CrashAndSqueeze
         {
             physical_vertex_infos.freeze();
 
+            init_streams();
             update_center_of_mass();
             initial_center_of_mass = center_of_mass;
 
@@ -140,6 +210,7 @@ namespace CrashAndSqueeze
             {
                 physical_vertex_infos[i].setup_initial_values(center_of_mass);
             }
+            update_offsets_streams();
 
             for(int i = 0; i < get_graphical_vertices_num(); ++i)
             {
@@ -156,6 +227,7 @@ namespace CrashAndSqueeze
             if(0 == get_physical_vertices_num())
                 return;
 
+            gather_positions();
             update_center_of_mass();
             compute_transformations();
             update_equilibrium_positions(false);
@@ -164,42 +236,169 @@ namespace CrashAndSqueeze
             update_graphical_transformations();
         }            
 
-        void Cluster::update_center_of_mass()
+        Real Cluster::compute_kinetic_energy() const
         {
-            center_of_mass = Vector::ZERO;
-            if( 0 != total_mass )
+            if(0 == get_physical_vertices_num() || less_or_equal(total_mass, 0))
+                return 0;
+
+            const Vector * velocities = vertices_store->get_velocities();
+            Real energy = 0;
+            for(int i = 0; i < get_physical_vertices_num(); ++i)
+                energy += vertex_masses[i]*velocities[physical_vertex_infos[i].vertex_index].squared_norm();
+            return energy/2/total_mass;
+        }
+
+        bool Cluster::try_to_fall_asleep()
+        {
+            if(sleep_steps_constant <= 0 || 0 == get_physical_vertices_num())
+                return false;
+
+            Real plasticity_change = fabs(plastic_deformation_measure - previous_plastic_deformation_measure);
+            previous_plastic_deformation_measure = plastic_deformation_measure;
+
+            if(compute_kinetic_energy() < sleep_energy_constant && plasticity_change < sleep_plasticity_constant)
+                ++idle_steps;
+            else
+                idle_steps = 0;
+
+            if(idle_steps < sleep_steps_constant)
+                return false;
+
+            // velocity additions of a sleeping cluster would be applied again and again otherwise
+            for(int i = 0; i < get_physical_vertices_num(); ++i)
             {
+                const PhysicalVertexMappingInfo & info = physical_vertex_infos[i];
+                vertices_store->set_cluster_velocity_addition(info.vertex_index, info.addition_index, Vector::ZERO);
+            }
+            sleeping = true;
+            return true;
+        }
+
+        bool Cluster::is_disturbed(const ForcesArray & forces) const
+        {
+            if(compute_kinetic_energy() >= sleep_energy_constant)
+                return true;
+
+            const Vector * positions = vertices_store->get_positions();
+            for(int j = 0; j < forces.size(); ++j)
+            {
+                // a uniform force (like gravity) moves the whole cluster rigidly, so it needs no matching
+                if( ! forces[j]->is_active() || forces[j]->is_uniform() )
+                    continue;
+                Vector min_corner, max_corner;
+                bool bounded = forces[j]->get_bounding_box(min_corner, max_corner);
                 for(int i = 0; i < get_physical_vertices_num(); ++i)
                 {
-                    PhysicalVertex &v = get_physical_vertex(i);
-                    center_of_mass += v.get_mass()*v.get_pos()/total_mass;
+                    const Vector & position = positions[physical_vertex_infos[i].vertex_index];
+                    if(bounded && ! is_inside_box(position, min_corner, max_corner))
+                        continue;
+                    if(forces[j]->is_applied_to(position))
+                        return true;
                 }
             }
+            return false;
         }
 
-        void Cluster::update_equilibrium_positions(bool plasticity_state_changed)
+        void Cluster::wake_up()
+        {
+            sleeping = false;
+            idle_steps = 0;
+        }
+
+        void Cluster::init_streams()
+        {
+            int vertices_num = get_physical_vertices_num();
+            if(0 == vertices_num)
+                return;
+
+            delete[] streams_buffer;
+            streams_buffer = new Real[vertices_num*(1 + VECTOR_SIZE + OFFSET_SIZE + VECTOR_SIZE)];
+
+            Real * stream = streams_buffer;
+            vertex_masses = stream;
+            stream += vertices_num;
+            for(int c = 0; c < VECTOR_SIZE; ++c, stream += vertices_num)
+                vertex_positions[c] = stream;
+            for(int k = 0; k < OFFSET_SIZE; ++k, stream += vertices_num)
+                vertex_offsets[k] = stream;
+            for(int c = 0; c < VECTOR_SIZE; ++c, stream += vertices_num)
+                vertex_results[c] = stream;
+
+            const Real * masses = vertices_store->get_masses();
+            for(int i = 0; i < vertices_num; ++i)
+                vertex_masses[i] = masses[physical_vertex_infos[i].vertex_index];
+
+            gather_positions();
+        }
+
+        void Cluster::gather_positions()
+        {
+            const Vector * positions = vertices_store->get_positions();
+            for(int i = 0; i < get_physical_vertices_num(); ++i)
+            {
+                const Vector & pos = positions[physical_vertex_infos[i].vertex_index];
+                for(int c = 0; c < VECTOR_SIZE; ++c)
+                    vertex_positions[c][i] = pos[c];
+            }
+        }
+
+        void Cluster::update_offsets_streams()
         {
             for(int i = 0; i < get_physical_vertices_num(); ++i)
             {
-                Vector & equil_pos           = physical_vertex_infos[i].equilibrium_pos;
 #if CAS_QUADRATIC_EXTENSIONS_ENABLED
-                TriVector & equil_offset_pos = physical_vertex_infos[i].equilibrium_offset_pos;
-                if(plasticity_state_changed)
+                const TriVector & offset = physical_vertex_infos[i].equilibrium_offset_pos;
+                for(int k = 0; k < OFFSET_SIZE; ++k)
+                    vertex_offsets[k][i] = offset.vectors[k/VECTOR_SIZE][k%VECTOR_SIZE];
+#else
+                const Vector & offset = physical_vertex_infos[i].equilibrium_offset_pos;
+                for(int k = 0; k < OFFSET_SIZE; ++k)
+                    vertex_offsets[k][i] = offset[k];
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+            }
+        }
+
+        void Cluster::update_center_of_mass()
+        {
+            center_of_mass = Vector::ZERO;
+            if( 0 != total_mass )
+            {
+                Real sum[VECTOR_SIZE];
+                kernels->sum_weighted_points(vertex_masses, vertex_positions, get_physical_vertices_num(), sum);
+                for(int c = 0; c < VECTOR_SIZE; ++c)
+                    center_of_mass[c] = sum[c]/total_mass;
+            }
+        }
+
+        void Cluster::update_equilibrium_positions(bool plasticity_state_changed)
+        {
+            if(plasticity_state_changed)
+            {
+                for(int i = 0; i < get_physical_vertices_num(); ++i)
                 {
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+                    TriVector & equil_offset_pos = physical_vertex_infos[i].equilibrium_offset_pos;
                     equil_offset_pos.set_vector(plasticity_state * physical_vertex_infos[i].initial_offset_pos);
-                }
-                Vector new_equil_pos = center_of_mass + rotation * equil_offset_pos.to_vector();
 #else
-                Vector & equil_offset_pos    = physical_vertex_infos[i].equilibrium_offset_pos;
-                if(plasticity_state_changed)
-                {
+                    Vector & equil_offset_pos    = physical_vertex_infos[i].equilibrium_offset_pos;
                     equil_offset_pos = plasticity_state * physical_vertex_infos[i].initial_offset_pos;
-                }
-                Vector new_equil_pos = center_of_mass + rotation * equil_offset_pos;
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+                }
+                update_offsets_streams();
+            }
+
+            // new equilibrium positions: center_of_mass + rotation * (linear part of) equilibrium offset
+            Real rotation_values[VECTOR_SIZE*VECTOR_SIZE];
+            to_row_major(rotation, rotation_values);
+            Real center_values[VECTOR_SIZE] = { center_of_mass[0], center_of_mass[1], center_of_mass[2] };
+            kernels->transform_offsets(rotation_values, vertex_offsets, VECTOR_SIZE, center_values,
+                                       get_physical_vertices_num(), vertex_results);
 
-                get_physical_vertex(i).change_equilibrium_pos(new_equil_pos - equil_pos);
-                equil_pos = new_equil_pos;
+            for(int i = 0; i < get_physical_vertices_num(); ++i)
+            {
+                const PhysicalVertexMappingInfo & info = physical_vertex_infos[i];
+                Vector new_equil_pos(vertex_results[0][i], vertex_results[1][i], vertex_results[2][i]);
+                vertices_store->set_cluster_equilibrium_pos(info.vertex_index, info.addition_index, new_equil_pos);
             }
         }
 
@@ -241,31 +440,27 @@ namespace CrashAndSqueeze
 
         void Cluster::compute_asymmetric_term()
         {
-            asymmetric_term.set_all(0);
-            for(int i = 0; i < get_physical_vertices_num(); ++i)
-            {
-                PhysicalVertex &v = get_physical_vertex(i);
-
-#if CAS_QUADRATIC_EXTENSIONS_ENABLED
-                asymmetric_term += TriMatrix( v.get_mass()*(v.get_pos() - center_of_mass), get_equilibrium_offset_pos(i) );
-#else
-                asymmetric_term += Matrix( v.get_mass()*(v.get_pos() - center_of_mass), get_equilibrium_offset_pos(i) );
-#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
-            }
+            // Apq = sum of m*(p - center_of_mass)*transposed(q)
+            Real center_values[VECTOR_SIZE] = { center_of_mass[0], center_of_mass[1], center_of_mass[2] };
+            Real values[VECTOR_SIZE*OFFSET_SIZE];
+            kernels->sum_outer_products(vertex_masses, vertex_positions, center_values, vertex_offsets, OFFSET_SIZE,
+                                        get_physical_vertices_num(), values);
+            from_row_major(values, asymmetric_term);
         }
 
         void Cluster::compute_symmetric_term()
         {
             symmetric_term.set_all(0);
+            const Real * masses = (NULL != vertices_store) ? vertices_store->get_masses() : NULL;
             for(int i = 0; i < get_physical_vertices_num(); ++i)
             {
-                PhysicalVertex &v = get_physical_vertex(i);
+                Real mass = masses[physical_vertex_infos[i].vertex_index];
 #if CAS_QUADRATIC_EXTENSIONS_ENABLED
                 const TriVector & equilibrium_pos = get_equilibrium_offset_pos(i);
-                symmetric_term += NineMatrix( equilibrium_pos*v.get_mass(), equilibrium_pos );
+                symmetric_term.add_outer_product( equilibrium_pos, mass );
 #else
                 const Vector & equilibrium_pos = get_equilibrium_offset_pos(i);
-                symmetric_term += Matrix( v.get_mass()*equilibrium_pos, equilibrium_pos );
+                symmetric_term += Matrix( mass*equilibrium_pos, equilibrium_pos );
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
             }
             // Try to invert matrix, if not possible => mark cluster as not valid
@@ -281,19 +476,35 @@ namespace CrashAndSqueeze
             compute_optimal_transformation();
 
 #if CAS_QUADRATIC_EXTENSIONS_ENABLED
-            optimal_transformation.to_matrix().do_polar_decomposition(rotation, scale);
+            compute_rotation(optimal_transformation.to_matrix());
             // (1-b)*[A Q M] + b*[R 0 0]
             total_deformation = optimal_transformation;
             total_deformation *= (1 - linear_elasticity_constant);
             total_deformation.as_matrix() += linear_elasticity_constant*rotation;
 #else
-            optimal_transformation.do_polar_decomposition(rotation, scale);
+            compute_rotation(optimal_transformation);
             // (1-b)*A + b*R
             total_deformation = linear_elasticity_constant*rotation + (1 - linear_elasticity_constant)*optimal_transformation;
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
 
         }
 
+        void Cluster::compute_rotation(const Matrix & linear_transformation)
+        {
+            if(0 == rotation_extraction_iterations)
+            {
+                linear_transformation.do_polar_decomposition(rotation, scale);
+            }
+            else
+            {
+                linear_transformation.extract_rotation(rotation, rotation_extraction_iterations);
+                // S = R^T*A, symmetrized, because R is found approximately
+                scale = rotation.transposed()*linear_transformation;
+                scale += scale.transposed();
+                scale /= 2;
+            }
+        }
+
         void Cluster::compute_optimal_transformation()
         {
             // check that symmetric_term has been precomputed...
@@ -360,15 +571,19 @@ namespace CrashAndSqueeze
         {
             // -- find and apply velocity_addition --
 
+            // goal position = total_deformation*equilibrium_offset_pos + center_of_mass,
+            // velocity addition = goal_speed_constant*(goal_position - position)/dt
+            Real deformation_values[VECTOR_SIZE*OFFSET_SIZE];
+            to_row_major(total_deformation, deformation_values);
+            Real center_values[VECTOR_SIZE] = { center_of_mass[0], center_of_mass[1], center_of_mass[2] };
+            kernels->compute_goal_velocities(deformation_values, vertex_offsets, OFFSET_SIZE, center_values, vertex_positions,
+                                             goal_speed_constant/dt, get_physical_vertices_num(), vertex_results);
+
             for(int i = 0; i < get_physical_vertices_num(); ++i)
             {
-                PhysicalVertex &vertex = get_physical_vertex(i);
-
-                Vector goal_position = total_deformation*get_equilibrium_offset_pos(i) + center_of_mass;
-
-                Vector velocity_addition = goal_speed_constant*(goal_position - vertex.get_pos())/dt;
-
-                vertex.add_to_average_velocity_addition(velocity_addition, get_addition_index(i));
+                const PhysicalVertexMappingInfo & info = physical_vertex_infos[i];
+                Vector velocity_addition(vertex_results[0][i], vertex_results[1][i], vertex_results[2][i]);
+                vertices_store->set_cluster_velocity_addition(info.vertex_index, info.addition_index, velocity_addition);
             }
         }
 
@@ -454,6 +669,10 @@ namespace CrashAndSqueeze
             qx_creep_constant        = params.quadratic_creep_speed;
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED && CAS_QUADRATIC_PLASTICITY_ENABLED
             max_deformation_constant = params.max_deformation;
+            rotation_extraction_iterations = params.rotation_extraction_iterations;
+            sleep_steps_constant = params.sleep_steps;
+            sleep_energy_constant = params.sleep_energy_threshold;
+            sleep_plasticity_constant = params.sleep_plasticity_threshold;
         }
 
         void Cluster::get_simulation_params(SimulationParams /*out*/ & params) const
@@ -468,6 +687,10 @@ namespace CrashAndSqueeze
             params.quadratic_creep_speed = qx_creep_constant;
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED && CAS_QUADRATIC_PLASTICITY_ENABLED
             params.max_deformation       = max_deformation_constant;
+            params.rotation_extraction_iterations = rotation_extraction_iterations;
+            params.sleep_steps = sleep_steps_constant;
+            params.sleep_energy_threshold = sleep_energy_constant;
+            params.sleep_plasticity_threshold = sleep_plasticity_constant;
         }
 
         const PhysicalVertex & Cluster::get_physical_vertex(int index) const
@@ -508,6 +731,7 @@ namespace CrashAndSqueeze
 
         Cluster::~Cluster()
         {
+            delete[] streams_buffer;
         }
     }
 }
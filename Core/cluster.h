@@ -3,6 +3,7 @@
 #include "Core/physical_vertex.h"
 #include "Core/graphical_vertex.h"
 #include "Core/simulation_params.h"
+#include "Core/cluster_kernels.h"
 #include "Math/vector.h"
 #include "Math/matrix.h"
 #if CAS_QUADRATIC_EXTENSIONS_ENABLED
@@ -18,6 +19,8 @@ namespace CrashAndSqueeze
         struct PhysicalVertexMappingInfo
         {
             PhysicalVertex *vertex;
+            // index of vertex in its PhysicalVertexStore
+            int vertex_index;
 
             // initial position of vertex measured off
             // the cluster's center of mass
@@ -33,10 +36,8 @@ namespace CrashAndSqueeze
 #else
             Math::Vector    equilibrium_offset_pos;
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
-            // position in model coordinates (center_of_mass + rotation*equilibrium_offset_pos),
-            // used to update PhysicalVertex's equilibrium_pos (which, in turn, is used mainly for reactions)
-            Math::Vector equilibrium_pos;
-            // index for stroring velocity_addition in PhysicalVertex independently of other classes
+            // index for stroring velocity_addition and equilibrium position (center_of_mass + rotation*equilibrium_offset_pos,
+            // used mainly for reactions) in PhysicalVertexStore independently of other clusters
             int addition_index;
 
             void setup_initial_values(const Math::Vector & center_of_mass);
@@ -64,6 +65,8 @@ namespace CrashAndSqueeze
             // -- constant (at run-time) fields --
             
             Collections::Array<PhysicalVertexMappingInfo> physical_vertex_infos;
+            // the store of all physical vertices of the cluster: its streams are read directly
+            PhysicalVertexStore * vertices_store;
             
             Collections::Array<GraphicalVertexMappingInfo> graphical_vertex_infos;
 
@@ -105,8 +108,29 @@ namespace CrashAndSqueeze
             // plasticity parameter: a threshold of maximum allowed strain
             Math::Real max_deformation_constant;
 
+            // maximum number of iterations for extracting rotation from optimal
+            // transformation, warm-started from rotation of previous step
+            // (see Math::Matrix::extract_rotation). 0 means that full polar
+            // decomposition is done instead, which is slower but doesn't depend on history
+            int rotation_extraction_iterations;
+
+            // sleeping parameters: the cluster falls asleep after sleep_steps_constant idle steps, when kinetic
+            // energy (per unit of mass) of its vertices is below sleep_energy_constant and plastic deformation
+            // changes by less than sleep_plasticity_constant per step (0 steps means that the cluster never sleeps,
+            // and it is the default: see DEFAULT_SLEEP_STEPS)
+            int sleep_steps_constant;
+            Math::Real sleep_energy_constant;
+            Math::Real sleep_plasticity_constant;
+
             // -- variable (at run-time) fields --
 
+            // sleeping cluster is not matched: its vertices move only due to other clusters and forces
+            bool sleeping;
+            // number of consecutive idle steps
+            int idle_steps;
+            // plastic_deformation_measure at previous check of idleness
+            Math::Real previous_plastic_deformation_measure;
+
             // center of mass of vertices
             Math::Vector center_of_mass;
             // plastic deformation applied to initial shape
@@ -125,7 +149,7 @@ namespace CrashAndSqueeze
             // first (asymmetric) term of optimal_transformation (Apq~)
             Math::TriMatrix asymmetric_term;
             // second (symmetric) term of optimal_transformation (Aqq~)
-            Math::NineMatrix symmetric_term;
+            Math::SymNineMatrix symmetric_term;
 #else
             // optimal linear transformation satisfying shape matching (A)
             Math::Matrix    optimal_transformation;
@@ -151,10 +175,38 @@ namespace CrashAndSqueeze
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
             // normal transformation for graphical vertices (graphical_pos_transform inverted and transposed)
             Math::Matrix graphical_nrm_transform;
+
+            // -- physical vertices as a structure of arrays (streams), processed by kernels --
+
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            static const int OFFSET_SIZE = Math::VECTOR_SIZE*Math::COMPONENTS_NUM;
+#else
+            static const int OFFSET_SIZE = Math::VECTOR_SIZE;
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+
+            const ClusterKernels * kernels;
+            // a single allocation for all streams below
+            Math::Real * streams_buffer;
+            Math::Real * vertex_masses;
+            // positions, gathered from the store at the beginning of each step
+            Math::Real * vertex_positions[Math::VECTOR_SIZE];
+            // components of equilibrium_offset_pos
+            Math::Real * vertex_offsets[OFFSET_SIZE];
+            // results of kernels (equilibrium positions, velocity additions) to be written to the store
+            Math::Real * vertex_results[Math::VECTOR_SIZE];
             
             // -- access helpers --
             bool check_initial_characteristics() const;
             
+            // -- streams helpers --
+
+            // allocates streams and fills masses and offsets
+            void init_streams();
+            // copies positions of vertices from the store to vertex_positions
+            void gather_positions();
+            // copies equilibrium_offset_pos of vertices to vertex_offsets
+            void update_offsets_streams();
+
             // -- shape matching steps --
             
             // re-computes center of mass
@@ -165,6 +217,9 @@ namespace CrashAndSqueeze
             
             // computes optimal_transformation
             void compute_optimal_transformation();
+
+            // computes rotation and scale from linear part of optimal_transformation
+            void compute_rotation(const Math::Matrix & linear_transformation);
             
             // computes asymmetric_term (each step)
             void compute_asymmetric_term();
@@ -183,6 +238,11 @@ namespace CrashAndSqueeze
 
             // updates graphical_pos_transform & graphical_nrm_transform
             void update_graphical_transformations();
+
+            // -- sleeping helpers --
+
+            // returns kinetic energy of vertices per unit of mass
+            Math::Real compute_kinetic_energy() const;
         
         public:
             Cluster();
@@ -200,6 +260,19 @@ namespace CrashAndSqueeze
 
             void match_shape(Math::Real dt);
 
+            // -- sleeping --
+
+            // Checks if the (awake) cluster has been idle for enough steps: must be called once per step before
+            // shape matching. If so, the cluster falls asleep: its velocity additions are cleared, and it must not
+            // be matched until woken up. Returns true if the cluster has fallen asleep.
+            bool try_to_fall_asleep();
+            // Returns true if the sleeping cluster must be woken up: its vertices are moving (e.g. pushed by an awake
+            // neighbour) or some of non-uniform `forces` is applied to them. Uniform forces (see Force::is_uniform)
+            // move the whole model rigidly, which is subtracted as macroscopic motion, so they don't wake it up
+            bool is_disturbed(const ForcesArray & forces) const;
+            void wake_up();
+            bool is_sleeping() const { return sleeping; }
+
             // -- getters/setters --
 
             // Sets current simulation params given by corresponding fields of `params`.
@@ -231,11 +304,17 @@ namespace CrashAndSqueeze
             Math::Real get_linear_elasticity_constant() const { return linear_elasticity_constant; }
             Math::Real get_yield_constant() const { return yield_constant; }
             Math::Real get_creep_constant() const { return creep_constant; }
+            int get_rotation_extraction_iterations() const { return rotation_extraction_iterations; }
+            int get_sleep_steps() const { return sleep_steps_constant; }
+
+            // Sets kernels used in shape matching (by default the best ones supported by CPU)
+            void set_kernels(const ClusterKernels & kernels) { this->kernels = &kernels; }
+            const ClusterKernels & get_kernels() const { return *kernels; }
 
             const Math::Vector & get_center_of_mass() const { return center_of_mass; }
             const Math::Vector & get_initial_center_of_mass() const { return initial_center_of_mass; }
-            /*
             const Math::Matrix & get_rotation() const { return rotation; }
+            /*
             const Math::Matrix & get_total_deformation() const { return total_deformation; }
             const Math::Matrix & get_plasticity_state() const { return plasticity_state; }
             const Math::Matrix & get_plasticity_state_inv_tr() const { return plasticity_state_inv_trans; }
@@ -260,6 +339,12 @@ namespace CrashAndSqueeze
             static const Math::Real DEFAULT_QX_CREEP_CONSTANT;
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED && CAS_QUADRATIC_PLASTICITY_ENABLED
             static const Math::Real DEFAULT_MAX_DEFORMATION_CONSTANT;
+            static const int DEFAULT_ROTATION_EXTRACTION_ITERATIONS;
+            // 0: sleeping is disabled by default, so the sleeping code path is not exercised
+            // unless SimulationParams::sleep_steps is set explicitly
+            static const int DEFAULT_SLEEP_STEPS;
+            static const Math::Real DEFAULT_SLEEP_ENERGY_CONSTANT;
+            static const Math::Real DEFAULT_SLEEP_PLASTICITY_CONSTANT;
         private:
             // No copying!
             Cluster(const Cluster &);
@@ -0,0 +1,95 @@
+#include "Core/cluster_kernels.h"
+#include "Core/cluster_kernels_impl.h"
+
+#if CAS_SIMD_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif // defined(_MSC_VER)
+#endif // CAS_SIMD_X86
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+#if CAS_SIMD_X86
+        // defined in cluster_kernels_sse2.cpp and cluster_kernels_avx.cpp
+        ClusterKernels make_sse2_cluster_kernels();
+        ClusterKernels make_avx_cluster_kernels();
+#endif // CAS_SIMD_X86
+
+        namespace
+        {
+            // checks features of CPU (and OS, for AVX registers) and returns the best supported level
+            ClusterKernels::Level detect_best_level()
+            {
+#if CAS_SIMD_X86
+    #if defined(_MSC_VER)
+                int info[4];
+                __cpuid(info, 1);
+                bool sse2_supported = 0 != (info[3] & (1 << 26));
+                // AVX instruction set and OSXSAVE flags, then check that OS saves AVX registers
+                bool avx_supported = 0 != (info[2] & (1 << 28)) &&
+                                     0 != (info[2] & (1 << 27)) &&
+                                     6 == (_xgetbv(0) & 6);
+    #else
+                __builtin_cpu_init();
+                bool sse2_supported = 0 != __builtin_cpu_supports("sse2");
+                bool avx_supported = 0 != __builtin_cpu_supports("avx");
+    #endif // defined(_MSC_VER)
+                if(avx_supported)
+                    return ClusterKernels::AVX;
+                if(sse2_supported)
+                    return ClusterKernels::SSE2;
+#endif // CAS_SIMD_X86
+                return ClusterKernels::SCALAR;
+            }
+
+            // kernels of all levels (only supported ones are initialized)
+            class KernelsTable
+            {
+            private:
+                ClusterKernels kernels[ClusterKernels::LEVELS_NUM];
+                ClusterKernels::Level best_level;
+
+            public:
+                KernelsTable() : best_level(detect_best_level())
+                {
+                    kernels[ClusterKernels::SCALAR] = make_kernels<ScalarOps>();
+#if CAS_SIMD_X86
+                    if(best_level >= ClusterKernels::SSE2)
+                        kernels[ClusterKernels::SSE2] = make_sse2_cluster_kernels();
+                    if(best_level >= ClusterKernels::AVX)
+                        kernels[ClusterKernels::AVX] = make_avx_cluster_kernels();
+#endif // CAS_SIMD_X86
+                }
+
+                ClusterKernels::Level get_best_level() const { return best_level; }
+                const ClusterKernels & get(ClusterKernels::Level level) const { return kernels[level]; }
+            };
+
+            const KernelsTable & get_table()
+            {
+                // initialized once, on first use
+                static const KernelsTable table;
+                return table;
+            }
+        }
+
+        bool ClusterKernels::is_supported(Level level)
+        {
+            return level >= SCALAR && level <= get_best_level();
+        }
+
+        ClusterKernels::Level ClusterKernels::get_best_level()
+        {
+            return get_table().get_best_level();
+        }
+
+        const ClusterKernels * ClusterKernels::get(Level level)
+        {
+            if( ! is_supported(level) )
+                return NULL;
+            return &get_table().get(level);
+        }
+    }
+}
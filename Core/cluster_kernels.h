@@ -0,0 +1,87 @@
+#pragma once
+#include "Core/core.h"
+#include "Math/floating_point.h"
+#include "Math/vector.h"
+
+// SIMD kernels are available only on x86 and x64
+#if CAS_SIMD_ENABLED && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#define CAS_SIMD_X86 1
+#else
+#define CAS_SIMD_X86 0
+#endif // CAS_SIMD_ENABLED && (x86 or x64)
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+        // Batched kernels for hot loops of Cluster::match_shape.
+        //
+        // Kernels work on vertices stored as a structure of arrays: `points[c][i]` is
+        // c'th coordinate of i'th point, `offsets[k][i]` is k'th component of i'th
+        // offset (3 components for usual vectors, 9 for TriVector in QX).
+        // Matrices are stored row-major, with POINT_SIZE rows and `offsets_size` columns.
+        //
+        // Several implementations exist: scalar one, SSE2 (2 vertices at a time, or 4 in single precision)
+        // and AVX (4 vertices at a time, or 8 in single precision) - the best one supported by CPU is chosen at run-time.
+        class ClusterKernels
+        {
+        public:
+            enum Level
+            {
+                SCALAR,
+                SSE2,
+                AVX,
+                LEVELS_NUM
+            };
+
+            static const int POINT_SIZE = Math::VECTOR_SIZE;
+            // maximum number of offset components: must be a multiple of POINT_SIZE
+            static const int MAX_OFFSET_SIZE = 9;
+
+            // sum = sum of weights[i]*points[i]
+            void (*sum_weighted_points)(const Math::Real * weights,
+                                        const Math::Real * const points[POINT_SIZE],
+                                        int points_num,
+                                        /*out*/ Math::Real sum[POINT_SIZE]);
+
+            // sum = sum of weights[i] * (points[i] - center) * transposed(offsets[i]), i.e. a sum
+            // of outer products (a POINT_SIZE x offsets_size matrix)
+            void (*sum_outer_products)(const Math::Real * weights,
+                                       const Math::Real * const points[POINT_SIZE],
+                                       const Math::Real center[POINT_SIZE],
+                                       const Math::Real * const * offsets,
+                                       int offsets_size,
+                                       int points_num,
+                                       /*out*/ Math::Real * sum);
+
+            // transformed[i] = matrix*offsets[i] + center
+            void (*transform_offsets)(const Math::Real * matrix,
+                                      const Math::Real * const * offsets,
+                                      int offsets_size,
+                                      const Math::Real center[POINT_SIZE],
+                                      int points_num,
+                                      /*out*/ Math::Real * const transformed[POINT_SIZE]);
+
+            // velocities[i] = coeff*(matrix*offsets[i] + center - points[i]): velocities
+            // pulling points to their goal positions
+            void (*compute_goal_velocities)(const Math::Real * matrix,
+                                            const Math::Real * const * offsets,
+                                            int offsets_size,
+                                            const Math::Real center[POINT_SIZE],
+                                            const Math::Real * const points[POINT_SIZE],
+                                            Math::Real coeff,
+                                            int points_num,
+                                            /*out*/ Math::Real * const velocities[POINT_SIZE]);
+
+            // returns true if kernels of given level are compiled and supported by CPU
+            static bool is_supported(Level level);
+            // returns the best level supported
+            static Level get_best_level();
+
+            // returns kernels of given level, or NULL if it is not supported
+            static const ClusterKernels * get(Level level);
+            // returns kernels of the best level supported
+            static const ClusterKernels & get_best() { return *get(get_best_level()); }
+        };
+    }
+}
@@ -0,0 +1,74 @@
+#include "Core/cluster_kernels.h"
+
+#if CAS_SIMD_X86
+#include <immintrin.h>
+
+// The code below is compiled with AVX instructions: it is called only if CPU supports them
+#if defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx")
+#endif // defined(__GNUC__)
+
+#include "Core/cluster_kernels_impl.h"
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+        namespace
+        {
+#if CAS_SINGLE_PRECISION
+            struct AvxOps
+            {
+                typedef __m256 Reg;
+                static const int WIDTH = 8;
+
+                static Reg zero() { return _mm256_setzero_ps(); }
+                static Reg set1(Real value) { return _mm256_set1_ps(value); }
+                static Reg load(const Real * source) { return _mm256_loadu_ps(source); }
+                static void store(Real * dest, Reg value) { _mm256_storeu_ps(dest, value); }
+                static Reg add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+                static Reg sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+                static Reg mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+                static Real sum(Reg value)
+                {
+                    Real items[WIDTH];
+                    _mm256_storeu_ps(items, value);
+                    return ((items[0] + items[1]) + (items[2] + items[3])) + ((items[4] + items[5]) + (items[6] + items[7]));
+                }
+            };
+#else
+            struct AvxOps
+            {
+                typedef __m256d Reg;
+                static const int WIDTH = 4;
+
+                static Reg zero() { return _mm256_setzero_pd(); }
+                static Reg set1(Real value) { return _mm256_set1_pd(value); }
+                static Reg load(const Real * source) { return _mm256_loadu_pd(source); }
+                static void store(Real * dest, Reg value) { _mm256_storeu_pd(dest, value); }
+                static Reg add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+                static Reg sub(Reg a, Reg b) { return _mm256_sub_pd(a, b); }
+                static Reg mul(Reg a, Reg b) { return _mm256_mul_pd(a, b); }
+                static Real sum(Reg value)
+                {
+                    Real items[WIDTH];
+                    _mm256_storeu_pd(items, value);
+                    return (items[0] + items[1]) + (items[2] + items[3]);
+                }
+            };
+#endif // CAS_SINGLE_PRECISION
+        }
+
+        ClusterKernels make_avx_cluster_kernels()
+        {
+            return make_kernels<AvxOps>();
+        }
+    }
+}
+
+#if defined(__GNUC__)
+#pragma GCC pop_options
+#endif // defined(__GNUC__)
+
+#endif // CAS_SIMD_X86
@@ -0,0 +1,237 @@
+#pragma once
+#include "Core/cluster_kernels.h"
+
+// Generic implementation of ClusterKernels. It is included into several translation units,
+// each instantiating kernels with its own set of operations (Ops) on registers of `Ops::WIDTH`
+// reals: so that each unit can be compiled with its own instruction set, everything here
+// is in anonymous namespace.
+//
+// Ops must provide: type Reg, constant WIDTH and static functions zero, set1, load, store,
+// add, sub, mul and sum (horizontal sum of register items). Loads and stores are unaligned.
+//
+// Vertices are processed in batches of Ops::WIDTH, remaining ones (if any) one by one.
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+        namespace
+        {
+            using Math::Real;
+
+            const int POINT_SIZE = ClusterKernels::POINT_SIZE;
+            const int MAX_OFFSET_SIZE = ClusterKernels::MAX_OFFSET_SIZE;
+
+            // operations on single reals: used for remaining vertices
+            struct ScalarOps
+            {
+                typedef Real Reg;
+                static const int WIDTH = 1;
+
+                static Reg zero() { return 0; }
+                static Reg set1(Real value) { return value; }
+                static Reg load(const Real * source) { return *source; }
+                static void store(Real * dest, Reg value) { *dest = value; }
+                static Reg add(Reg a, Reg b) { return a + b; }
+                static Reg sub(Reg a, Reg b) { return a - b; }
+                static Reg mul(Reg a, Reg b) { return a * b; }
+                static Real sum(Reg value) { return value; }
+            };
+
+            // returns the end of vertices which can be processed in batches of Ops::WIDTH
+            template <class Ops>
+            inline int get_batches_end(int points_num)
+            {
+                return points_num - points_num % Ops::WIDTH;
+            }
+
+            // -- sum_weighted_points --
+
+            template <class Ops>
+            inline void accumulate_weighted_points(const Real * weights, const Real * const points[POINT_SIZE],
+                                                   int start, int end, /*in/out*/ typename Ops::Reg sums[POINT_SIZE])
+            {
+                typedef typename Ops::Reg Reg;
+                for(int i = start; i < end; i += Ops::WIDTH)
+                {
+                    Reg weight = Ops::load(weights + i);
+                    for(int c = 0; c < POINT_SIZE; ++c)
+                    {
+                        sums[c] = Ops::add( sums[c], Ops::mul(weight, Ops::load(points[c] + i)) );
+                    }
+                }
+            }
+
+            template <class Ops>
+            void sum_weighted_points(const Real * weights, const Real * const points[POINT_SIZE],
+                                     int points_num, /*out*/ Real sum[POINT_SIZE])
+            {
+                typename Ops::Reg sums[POINT_SIZE];
+                ScalarOps::Reg tail_sums[POINT_SIZE];
+                for(int c = 0; c < POINT_SIZE; ++c)
+                {
+                    sums[c] = Ops::zero();
+                    tail_sums[c] = ScalarOps::zero();
+                }
+
+                int batches_end = get_batches_end<Ops>(points_num);
+                accumulate_weighted_points<Ops>(weights, points, 0, batches_end, sums);
+                accumulate_weighted_points<ScalarOps>(weights, points, batches_end, points_num, tail_sums);
+
+                for(int c = 0; c < POINT_SIZE; ++c)
+                {
+                    sum[c] = Ops::sum(sums[c]) + tail_sums[c];
+                }
+            }
+
+            // -- sum_outer_products --
+
+            // Accumulates outer products by blocks of POINT_SIZE offset components,
+            // so that a block of sums fits into registers
+            template <class Ops>
+            inline void accumulate_outer_products(const Real * weights, const Real * const points[POINT_SIZE],
+                                                  const Real center[POINT_SIZE],
+                                                  const Real * const * offsets, int offsets_size,
+                                                  int start, int end,
+                                                  /*in/out*/ typename Ops::Reg * sums)
+            {
+                typedef typename Ops::Reg Reg;
+
+                Reg center_regs[POINT_SIZE];
+                for(int c = 0; c < POINT_SIZE; ++c)
+                    center_regs[c] = Ops::set1(center[c]);
+
+                for(int block = 0; block < offsets_size; block += POINT_SIZE)
+                {
+                    Reg block_sums[POINT_SIZE][POINT_SIZE];
+                    for(int r = 0; r < POINT_SIZE; ++r)
+                        for(int k = 0; k < POINT_SIZE; ++k)
+                            block_sums[r][k] = sums[r*offsets_size + block + k];
+
+                    for(int i = start; i < end; i += Ops::WIDTH)
+                    {
+                        Reg weight = Ops::load(weights + i);
+
+                        Reg weighted_offsets[POINT_SIZE];
+                        for(int r = 0; r < POINT_SIZE; ++r)
+                            weighted_offsets[r] = Ops::mul( weight, Ops::sub(Ops::load(points[r] + i), center_regs[r]) );
+
+                        for(int k = 0; k < POINT_SIZE; ++k)
+                        {
+                            Reg offset = Ops::load(offsets[block + k] + i);
+                            for(int r = 0; r < POINT_SIZE; ++r)
+                                block_sums[r][k] = Ops::add( block_sums[r][k], Ops::mul(weighted_offsets[r], offset) );
+                        }
+                    }
+
+                    for(int r = 0; r < POINT_SIZE; ++r)
+                        for(int k = 0; k < POINT_SIZE; ++k)
+                            sums[r*offsets_size + block + k] = block_sums[r][k];
+                }
+            }
+
+            template <class Ops>
+            void sum_outer_products(const Real * weights, const Real * const points[POINT_SIZE],
+                                    const Real center[POINT_SIZE],
+                                    const Real * const * offsets, int offsets_size,
+                                    int points_num, /*out*/ Real * sum)
+            {
+                const int SUMS_NUM = POINT_SIZE*MAX_OFFSET_SIZE;
+                typename Ops::Reg sums[SUMS_NUM];
+                ScalarOps::Reg tail_sums[SUMS_NUM];
+                for(int j = 0; j < POINT_SIZE*offsets_size; ++j)
+                {
+                    sums[j] = Ops::zero();
+                    tail_sums[j] = ScalarOps::zero();
+                }
+
+                int batches_end = get_batches_end<Ops>(points_num);
+                accumulate_outer_products<Ops>(weights, points, center, offsets, offsets_size, 0, batches_end, sums);
+                accumulate_outer_products<ScalarOps>(weights, points, center, offsets, offsets_size, batches_end, points_num, tail_sums);
+
+                for(int j = 0; j < POINT_SIZE*offsets_size; ++j)
+                {
+                    sum[j] = Ops::sum(sums[j]) + tail_sums[j];
+                }
+            }
+
+            // -- transform_offsets and compute_goal_velocities --
+
+            // Transforms offsets of vertices from `start` to `end` by matrix and adds center.
+            // If `points` is not NULL, then the result is coeff*(transformed - points) instead
+            template <class Ops>
+            inline void transform_offsets_range(const Real * matrix,
+                                                const Real * const * offsets, int offsets_size,
+                                                const Real center[POINT_SIZE],
+                                                const Real * const * points, Real coeff,
+                                                int start, int end,
+                                                /*out*/ Real * const results[POINT_SIZE])
+            {
+                typedef typename Ops::Reg Reg;
+
+                Reg matrix_regs[POINT_SIZE*MAX_OFFSET_SIZE];
+                for(int j = 0; j < POINT_SIZE*offsets_size; ++j)
+                    matrix_regs[j] = Ops::set1(matrix[j]);
+
+                Reg center_regs[POINT_SIZE];
+                for(int c = 0; c < POINT_SIZE; ++c)
+                    center_regs[c] = Ops::set1(center[c]);
+                Reg coeff_reg = Ops::set1(coeff);
+
+                for(int i = start; i < end; i += Ops::WIDTH)
+                {
+                    Reg transformed[POINT_SIZE];
+                    for(int r = 0; r < POINT_SIZE; ++r)
+                        transformed[r] = center_regs[r];
+
+                    for(int k = 0; k < offsets_size; ++k)
+                    {
+                        Reg offset = Ops::load(offsets[k] + i);
+                        for(int r = 0; r < POINT_SIZE; ++r)
+                            transformed[r] = Ops::add( transformed[r], Ops::mul(matrix_regs[r*offsets_size + k], offset) );
+                    }
+
+                    for(int r = 0; r < POINT_SIZE; ++r)
+                    {
+                        if(NULL != points)
+                            transformed[r] = Ops::mul( coeff_reg, Ops::sub(transformed[r], Ops::load(points[r] + i)) );
+                        Ops::store(results[r] + i, transformed[r]);
+                    }
+                }
+            }
+
+            template <class Ops>
+            void transform_offsets(const Real * matrix, const Real * const * offsets, int offsets_size,
+                                   const Real center[POINT_SIZE], int points_num,
+                                   /*out*/ Real * const transformed[POINT_SIZE])
+            {
+                int batches_end = get_batches_end<Ops>(points_num);
+                transform_offsets_range<Ops>(matrix, offsets, offsets_size, center, NULL, 0, 0, batches_end, transformed);
+                transform_offsets_range<ScalarOps>(matrix, offsets, offsets_size, center, NULL, 0, batches_end, points_num, transformed);
+            }
+
+            template <class Ops>
+            void compute_goal_velocities(const Real * matrix, const Real * const * offsets, int offsets_size,
+                                         const Real center[POINT_SIZE], const Real * const points[POINT_SIZE],
+                                         Real coeff, int points_num,
+                                         /*out*/ Real * const velocities[POINT_SIZE])
+            {
+                int batches_end = get_batches_end<Ops>(points_num);
+                transform_offsets_range<Ops>(matrix, offsets, offsets_size, center, points, coeff, 0, batches_end, velocities);
+                transform_offsets_range<ScalarOps>(matrix, offsets, offsets_size, center, points, coeff, batches_end, points_num, velocities);
+            }
+
+            // returns kernels instantiated with given operations
+            template <class Ops>
+            ClusterKernels make_kernels()
+            {
+                ClusterKernels kernels;
+                kernels.sum_weighted_points = &sum_weighted_points<Ops>;
+                kernels.sum_outer_products = &sum_outer_products<Ops>;
+                kernels.transform_offsets = &transform_offsets<Ops>;
+                kernels.compute_goal_velocities = &compute_goal_velocities<Ops>;
+                return kernels;
+            }
+        }
+    }
+}
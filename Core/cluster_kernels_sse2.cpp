@@ -0,0 +1,74 @@
+#include "Core/cluster_kernels.h"
+
+#if CAS_SIMD_X86
+#include <emmintrin.h>
+
+// The code below is compiled with SSE2 instructions: it is called only if CPU supports them
+#if defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif // defined(__GNUC__)
+
+#include "Core/cluster_kernels_impl.h"
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+        namespace
+        {
+#if CAS_SINGLE_PRECISION
+            struct Sse2Ops
+            {
+                typedef __m128 Reg;
+                static const int WIDTH = 4;
+
+                static Reg zero() { return _mm_setzero_ps(); }
+                static Reg set1(Real value) { return _mm_set1_ps(value); }
+                static Reg load(const Real * source) { return _mm_loadu_ps(source); }
+                static void store(Real * dest, Reg value) { _mm_storeu_ps(dest, value); }
+                static Reg add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+                static Reg sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+                static Reg mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+                static Real sum(Reg value)
+                {
+                    Real items[WIDTH];
+                    _mm_storeu_ps(items, value);
+                    return (items[0] + items[1]) + (items[2] + items[3]);
+                }
+            };
+#else
+            struct Sse2Ops
+            {
+                typedef __m128d Reg;
+                static const int WIDTH = 2;
+
+                static Reg zero() { return _mm_setzero_pd(); }
+                static Reg set1(Real value) { return _mm_set1_pd(value); }
+                static Reg load(const Real * source) { return _mm_loadu_pd(source); }
+                static void store(Real * dest, Reg value) { _mm_storeu_pd(dest, value); }
+                static Reg add(Reg a, Reg b) { return _mm_add_pd(a, b); }
+                static Reg sub(Reg a, Reg b) { return _mm_sub_pd(a, b); }
+                static Reg mul(Reg a, Reg b) { return _mm_mul_pd(a, b); }
+                static Real sum(Reg value)
+                {
+                    Real items[WIDTH];
+                    _mm_storeu_pd(items, value);
+                    return items[0] + items[1];
+                }
+            };
+#endif // CAS_SINGLE_PRECISION
+        }
+
+        ClusterKernels make_sse2_cluster_kernels()
+        {
+            return make_kernels<Sse2Ops>();
+        }
+    }
+}
+
+#if defined(__GNUC__)
+#pragma GCC pop_options
+#endif // defined(__GNUC__)
+
+#endif // CAS_SIMD_X86
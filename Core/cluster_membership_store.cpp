@@ -0,0 +1,30 @@
+#include "Core/cluster_membership_store.h"
+
+namespace CrashAndSqueeze
+{
+    using Math::Real;
+
+    namespace Core
+    {
+        int ClusterMembershipStore::add(int first, int memberships_num, int cluster_index, Real weight)
+        {
+            if(first + memberships_num != get_size())
+            {
+                // not in the end: move memberships there to have room for one more
+                int new_first = get_size();
+                for(int i = first; i < first + memberships_num; ++i)
+                {
+                    // copy items before pushing: push_back may reallocate the array
+                    int moved_index = cluster_indices[i];
+                    Real moved_weight = cluster_weights[i];
+                    cluster_indices.push_back(moved_index);
+                    cluster_weights.push_back(moved_weight);
+                }
+                first = new_first;
+            }
+            cluster_indices.push_back(cluster_index);
+            cluster_weights.push_back(weight);
+            return first;
+        }
+    }
+}
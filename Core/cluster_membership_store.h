@@ -0,0 +1,41 @@
+#pragma once
+#include "Core/core.h"
+#include "Math/floating_point.h"
+#include "Collections/array.h"
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+        // Compact storage of cluster memberships of many vertices: indices of including
+        // clusters and their weights. Memberships of a vertex occupy a contiguous range
+        // of the storage, so that a vertex needs only its first position and a number
+        // of memberships, and there is no limit on number of clusters a vertex belongs to.
+        class ClusterMembershipStore
+        {
+        private:
+            Collections::Array<int> cluster_indices;
+            Collections::Array<Math::Real> cluster_weights;
+
+        public:
+            ClusterMembershipStore(int initial_allocated = Collections::Array<int>::INITIAL_ALLOCATED)
+                : cluster_indices(initial_allocated), cluster_weights(initial_allocated) {}
+
+            // Adds a membership to memberships from `first` to `first + memberships_num - 1`,
+            // returns new position of the first of them (if they are not in the end of
+            // the storage, they are moved there).
+            int add(int first, int memberships_num, int cluster_index, Math::Real weight);
+
+            int get_size() const { return cluster_indices.size(); }
+
+            int get_cluster_index(int position) const { return cluster_indices[position]; }
+            Math::Real get_weight(int position) const { return cluster_weights[position]; }
+            void set_weight(int position, Math::Real weight) { cluster_weights[position] = weight; }
+
+        private:
+            // No copying!
+            ClusterMembershipStore(const ClusterMembershipStore &);
+            ClusterMembershipStore & operator=(const ClusterMembershipStore &);
+        };
+    }
+}
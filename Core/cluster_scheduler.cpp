@@ -0,0 +1,152 @@
+#include "Core/cluster_scheduler.h"
+#include "Core/cluster.h"
+#include <algorithm> // for std::sort
+
+namespace CrashAndSqueeze
+{
+    using Math::Real;
+
+    namespace Core
+    {
+        // matching shape of a cluster includes polar decomposition and
+        // update of plasticity state, which cost as processing several vertices
+        const Real ClusterScheduler::CLUSTER_OVERHEAD_COST = 32;
+
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+        // in quadratic mode offsets of vertices have 9 components instead of 3
+        const Real ClusterScheduler::VERTEX_COST = 2.5;
+#else
+        const Real ClusterScheduler::VERTEX_COST = 1;
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+
+        // tasks of less than a few hundreds of vertices are dominated by
+        // the overhead of queue and events
+        const Real ClusterScheduler::DEFAULT_MIN_BATCH_COST = 256;
+
+        namespace
+        {
+            // orders items by decreasing cost, and by index if costs are equal
+            class CostGreater
+            {
+            private:
+                const Real * costs;
+            public:
+                CostGreater(const Real * costs) : costs(costs) {}
+
+                bool operator()(int a, int b) const
+                {
+                    if(costs[a] != costs[b])
+                        return costs[a] > costs[b];
+                    return a < b;
+                }
+            };
+        }
+
+        ClusterScheduler::ClusterScheduler(int clusters_num)
+            : clusters_num(clusters_num), min_batch_cost(DEFAULT_MIN_BATCH_COST), batches_num(0)
+        {
+            estimated_costs = new Real[clusters_num];
+            measured_times = new Real[clusters_num];
+            active = new bool[clusters_num];
+            order = new int[clusters_num];
+            batch_starts = new int[clusters_num + 1];
+            costs = new Real[clusters_num];
+            batches_order = new int[clusters_num];
+            batch_costs = new Real[clusters_num];
+            new_order = new int[clusters_num];
+            new_batch_starts = new int[clusters_num + 1];
+
+            for(int i = 0; i < clusters_num; ++i)
+            {
+                estimated_costs[i] = 1;
+                measured_times[i] = 0;
+                active[i] = true;
+            }
+            batch_starts[0] = 0;
+        }
+
+        Real ClusterScheduler::estimate_cost(const Cluster & cluster)
+        {
+            return CLUSTER_OVERHEAD_COST + cluster.get_physical_vertices_num()*VERTEX_COST;
+        }
+
+        void ClusterScheduler::schedule()
+        {
+            // -- Find costs: measured times are converted to the same units as estimated costs --
+            Real measured_sum = 0;
+            Real estimated_sum = 0;
+            for(int i = 0; i < clusters_num; ++i)
+            {
+                if(active[i] && measured_times[i] > 0)
+                {
+                    measured_sum += measured_times[i];
+                    estimated_sum += estimated_costs[i];
+                }
+            }
+            int active_num = 0;
+            for(int i = 0; i < clusters_num; ++i)
+            {
+                if(measured_times[i] > 0 && estimated_sum > 0)
+                    costs[i] = measured_times[i]*estimated_sum/measured_sum;
+                else
+                    costs[i] = estimated_costs[i];
+                if(active[i])
+                    order[active_num++] = i;
+            }
+
+            // -- Group clusters, starting from the most expensive: each batch gets at least min_batch_cost --
+            std::sort(order, order + active_num, CostGreater(costs));
+
+            batches_num = 0;
+            Real batch_cost = 0;
+            for(int i = 0; i < active_num; ++i)
+            {
+                if(i > batch_starts[batches_num] && batch_cost >= min_batch_cost)
+                {
+                    batch_costs[batches_num] = batch_cost;
+                    ++batches_num;
+                    batch_starts[batches_num] = i;
+                    batch_cost = 0;
+                }
+                batch_cost += costs[order[i]];
+            }
+            if(active_num > 0)
+            {
+                batch_costs[batches_num] = batch_cost;
+                ++batches_num;
+                batch_starts[batches_num] = active_num;
+            }
+
+            // -- Order batches by cost: batches of several small clusters may cost more than a big one --
+            for(int i = 0; i < batches_num; ++i)
+                batches_order[i] = i;
+            std::sort(batches_order, batches_order + batches_num, CostGreater(batch_costs));
+
+            new_batch_starts[0] = 0;
+            for(int i = 0; i < batches_num; ++i)
+            {
+                int batch = batches_order[i];
+                int size = get_batch_size(batch);
+                for(int j = 0; j < size; ++j)
+                    new_order[new_batch_starts[i] + j] = order[batch_starts[batch] + j];
+                new_batch_starts[i + 1] = new_batch_starts[i] + size;
+            }
+            std::swap(order, new_order);
+            std::swap(batch_starts, new_batch_starts);
+        }
+
+        ClusterScheduler::~ClusterScheduler()
+        {
+            delete[] estimated_costs;
+            delete[] measured_times;
+            delete[] active;
+            delete[] order;
+            delete[] batch_starts;
+            delete[] costs;
+            delete[] batches_order;
+            delete[] batch_costs;
+            delete[] new_order;
+            delete[] new_batch_starts;
+        }
+    }
+}
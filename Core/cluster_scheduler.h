@@ -0,0 +1,85 @@
+#pragma once
+#include "Core/core.h"
+#include "Math/floating_point.h"
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+        class Cluster;
+
+        // Groups clusters into batches, each of them processed by one task, and orders
+        // batches by their cost, longest first. Costs of clusters are estimated from their
+        // sizes until their computation time is measured (then measured time of previous
+        // step is used). Small clusters are batched together, so that a task is not
+        // dominated by the overhead of queue and events, and long tasks are started first,
+        // so that threads don't wait for a long task started last.
+        class ClusterScheduler
+        {
+        public:
+            // estimated cost of a cluster, which doesn't depend on its size (in costs of one vertex)
+            static const Math::Real CLUSTER_OVERHEAD_COST;
+            // estimated cost of one physical vertex in the cluster (in costs of one vertex of linear cluster)
+            static const Math::Real VERTEX_COST;
+            // minimum estimated cost of a batch (in costs of one vertex)
+            static const Math::Real DEFAULT_MIN_BATCH_COST;
+
+        private:
+            int clusters_num;
+
+            // estimated cost of each cluster
+            Math::Real * estimated_costs;
+            // measured time of computing each cluster (in seconds), or 0 if not measured yet
+            Math::Real * measured_times;
+            // inactive (sleeping) clusters are not scheduled
+            bool * active;
+
+            Math::Real min_batch_cost;
+
+            // indices of active clusters, sorted by cost and grouped in batches:
+            // batch i contains clusters from batch_starts[i] to batch_starts[i + 1] - 1
+            int * order;
+            int * batch_starts;
+            int batches_num;
+
+            // -- temporary arrays used in schedule() --
+            Math::Real * costs;
+            int * batches_order;
+            Math::Real * batch_costs;
+            int * new_order;
+            int * new_batch_starts;
+
+        public:
+            ClusterScheduler(int clusters_num);
+
+            // estimates cost of a cluster by its size (in costs of one vertex)
+            static Math::Real estimate_cost(const Cluster & cluster);
+
+            void set_estimated_cost(int cluster_index, Math::Real cost) { estimated_costs[cluster_index] = cost; }
+            // Stores time of computing a cluster, used for the next schedule(). Can be called
+            // from tasks concurrently, but only once for each cluster during a step.
+            void set_measured_time(int cluster_index, Math::Real seconds) { measured_times[cluster_index] = seconds; }
+
+            void set_active(int cluster_index, bool value) { active[cluster_index] = value; }
+            bool is_active(int cluster_index) const { return active[cluster_index]; }
+
+            void set_min_batch_cost(Math::Real cost) { min_batch_cost = cost; }
+            Math::Real get_min_batch_cost() const { return min_batch_cost; }
+
+            // Groups active clusters into batches by their current costs
+            void schedule();
+
+            int get_batches_num() const { return batches_num; }
+            int get_batch_size(int batch) const { return batch_starts[batch + 1] - batch_starts[batch]; }
+            // returns indices of clusters in given batch
+            const int * get_batch(int batch) const { return &order[batch_starts[batch]]; }
+
+            virtual ~ClusterScheduler();
+
+        private:
+            // No copying!
+            ClusterScheduler(const ClusterScheduler &);
+            ClusterScheduler & operator=(const ClusterScheduler &);
+        };
+    }
+}
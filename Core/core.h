@@ -21,6 +21,10 @@
 // passed to a ShapeDeformationReaction or a RegionReaction is empty.
 // But anyway, it is useful to leave these warnings enabled for safety from bugs
 #define CAS_WARN_EMPTY_REACTION_SHAPE    1
+// Set to 0 to disable SIMD (SSE2/AVX) kernels of shape matching:
+// otherwise the best kernels supported by CPU are chosen at run-time
+// (see Core/cluster_kernels.h)
+#define CAS_SIMD_ENABLED                 1
 
 namespace CrashAndSqueeze
 {
@@ -30,7 +34,8 @@ namespace CrashAndSqueeze
         typedef float VertexFloat;
         // floating type for defining mass of physical vertex
         typedef double MassFloat;
-        // integer type for storing cluster index of graphical vertex in vertex buffer
+        // default integer type for storing cluster index of graphical vertex in vertex buffer
+        // (wider indices can be set with VertexInfo::set_cluster_indices_format)
         typedef unsigned char ClusterIndex;
 
         typedef Collections::Array<int> IndexArray;
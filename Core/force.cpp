@@ -1,10 +1,12 @@
 #include "Core/force.h"
+#include "Core/regions.h"
 
 namespace CrashAndSqueeze
 {
     using Math::Vector;
     using Math::Real;
     using Math::less_or_equal;
+    using Math::DEFAULT_REAL_PRECISION;
     using Logging::Logger;
 
     namespace Core
@@ -12,12 +14,21 @@ namespace CrashAndSqueeze
         // -- abstract Force --
         
         Force::Force()
+            : uniform(false)
         {
             set_value(Vector::ZERO);
             activate();
         }
 
         Force::Force(const Vector &value)
+            : uniform(false)
+        {
+            set_value(value);
+            activate();
+        }
+
+        Force::Force(const Vector &value, bool uniform)
+            : uniform(uniform)
         {
             set_value(value);
             activate();
@@ -35,9 +46,31 @@ namespace CrashAndSqueeze
             return is_active() && is_applied_to(point) ? compute_value_at(point, velocity) : Vector::ZERO;
         }
 
+        void Force::add_accelerations(const Vector * points,
+                                      const Vector * velocities,
+                                      const Real * masses,
+                                      int start_index,
+                                      int points_num,
+                                      /*out*/ Vector * accelerations) const
+        {
+            if( ! is_active() )
+                return;
+
+            Vector min_corner, max_corner;
+            bool bounded = get_bounding_box(min_corner, max_corner);
+            for(int i = start_index; i < start_index + points_num; ++i)
+            {
+                if(bounded && ! is_inside_box(points[i], min_corner, max_corner))
+                    continue;
+                if(0 != masses[i] && is_applied_to(points[i]))
+                    accelerations[i] += compute_value_at(points[i], velocities[i])/masses[i];
+            }
+        }
+
         // -- EverywhereForce --
         
         EverywhereForce::EverywhereForce()
+            : Force()
         {
         }
         
@@ -45,6 +78,11 @@ namespace CrashAndSqueeze
             : Force(value)
         {
         }
+
+        EverywhereForce::EverywhereForce(const Vector &value, bool uniform)
+            : Force(value, uniform)
+        {
+        }
         
         bool EverywhereForce::is_applied_to(Vector const &point) const
         {
@@ -52,6 +90,18 @@ namespace CrashAndSqueeze
             return true;
         }
         
+        // -- UniformForce --
+        
+        UniformForce::UniformForce()
+            : EverywhereForce(Vector::ZERO, true)
+        {
+        }
+        
+        UniformForce::UniformForce(const Vector &value)
+            : EverywhereForce(value, true)
+        {
+        }
+        
         // -- ForceWithRadius --
         
         ForceWithRadius::ForceWithRadius()
@@ -96,6 +146,15 @@ namespace CrashAndSqueeze
             return less_or_equal( distance(point, point_of_application), get_radius() );
         }
 
+        bool PointForce::get_bounding_box(Vector & min_corner, Vector & max_corner) const
+        {
+            // less_or_equal above allows points a bit farther than radius
+            Real half_size = get_radius() + DEFAULT_REAL_PRECISION;
+            min_corner = point_of_application - Vector(half_size, half_size, half_size);
+            max_corner = point_of_application + Vector(half_size, half_size, half_size);
+            return true;
+        }
+
         // -- PlaneForce --
 
         PlaneForce::PlaneForce()
@@ -232,6 +291,12 @@ namespace CrashAndSqueeze
                 && normal_component.norm() <= get_radius();
         }
 
+        bool CylinderSpringForce::get_bounding_box(Vector & min_corner, Vector & max_corner) const
+        {
+            get_cylinder_bounding_box(point1, point2, get_radius(), min_corner, max_corner);
+            return true;
+        }
+
         Vector CylinderSpringForce::compute_value_at(const Vector &point, const Vector &velocity) const
         {
             Vector normal_component;
@@ -14,14 +14,21 @@ namespace CrashAndSqueeze
         //   (virtual, so override it to change behaviour)
         // * provides Force::get_value_at to get value of force at some point
         //   (override Force::compute_value_at to change behaviour)
+        // * provides Force::add_accelerations to apply the force to a range of points at once
+        //   (points outside the bounding box given by Force::get_bounding_box are skipped)
         class Force
         {
         private:
             Math::Vector value;
             bool is_active_;
+            bool uniform;
 
         protected:
             virtual Math::Vector compute_value_at(const Math::Vector &point, const Math::Vector &velocity) const;
+
+            // a concrete force, having the same value at any point for any velocity, tells it here
+            // (the public constructors create non-uniform forces)
+            Force(const Math::Vector &value, bool uniform);
             
         public:
             Force();
@@ -37,6 +44,27 @@ namespace CrashAndSqueeze
 
             virtual bool is_applied_to(const Math::Vector &point) const = 0;
             Math::Vector get_value_at(const Math::Vector &point, const Math::Vector &velocity) const;
+
+            // Returns true if the force has the same value at any point for any velocity (then it can be
+            // summed up with other uniform forces once instead of being applied to each point).
+            // Not virtual: the property is given explicitly to the constructor
+            bool is_uniform() const { return uniform; }
+
+            // Gets an axis-aligned box containing all points the force is applied to. By default
+            // returns false, meaning that the box is unknown: then all points must be checked
+            virtual bool get_bounding_box(/*out*/ Math::Vector & /*min_corner*/, /*out*/ Math::Vector & /*max_corner*/) const
+            {
+                return false;
+            }
+
+            // Adds value of the force divided by mass to `accelerations` for points from `start_index` to
+            // `start_index + points_num - 1` (only for those the force is applied to and which have non-zero mass)
+            void add_accelerations(const Math::Vector * points,
+                                   const Math::Vector * velocities,
+                                   const Math::Real * masses,
+                                   int start_index,
+                                   int points_num,
+                                   /*out*/ Math::Vector * accelerations) const;
         };
 
         typedef ::CrashAndSqueeze::Collections::Array<Force *> ForcesArray;
@@ -56,12 +84,25 @@ namespace CrashAndSqueeze
         // A simplest force applied everywhere
         class EverywhereForce : public Force
         {
+        protected:
+            EverywhereForce(const Math::Vector &value, bool uniform);
+
         public:
             EverywhereForce();
             EverywhereForce(const Math::Vector &value);
             virtual /*override*/ bool is_applied_to(Math::Vector const &point) const;
         };
 
+        // A force applied everywhere with the same value (like gravity): it is uniform, so it is
+        // summed up once for all points. Don't override compute_value_at or is_applied_to in a subclass
+        // (use EverywhereForce instead)
+        class UniformForce : public EverywhereForce
+        {
+        public:
+            UniformForce();
+            UniformForce(const Math::Vector &value);
+        };
+
         // An abstract force having property of radius
         class ForceWithRadius : public Force
         {
@@ -89,6 +130,7 @@ namespace CrashAndSqueeze
             void set_point_of_application(const Math::Vector &point) { point_of_application = point; }
 
             virtual /*override*/ bool is_applied_to(const Math::Vector &point) const;
+            virtual /*override*/ bool get_bounding_box(/*out*/ Math::Vector & min_corner, /*out*/ Math::Vector & max_corner) const;
         };
 
         // A force applied to all points on a plane
@@ -193,6 +235,7 @@ namespace CrashAndSqueeze
             
             virtual /*override*/ bool is_applied_to(const Math::Vector &point) const;
             virtual /*override*/ Math::Vector compute_value_at(const Math::Vector &point, const Math::Vector &velocity) const;
+            virtual /*override*/ bool get_bounding_box(/*out*/ Math::Vector & min_corner, /*out*/ Math::Vector & max_corner) const;
         };
     }
 }
@@ -19,16 +19,17 @@ namespace CrashAndSqueeze
         }
         
         GraphicalVertex::GraphicalVertex()
-            : points_num(1), vectors_num(0), including_clusters_num(0)
+            : points_num(1), vectors_num(0), memberships(NULL), first_membership(0), including_clusters_num(0)
         {
             points[0] = Vector::ZERO;
 #if CAS_QUADRATIC_EXTENSIONS_ENABLED
             generated_normal = Vector::ZERO;
+            current_pos = Vector::ZERO;
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
         }
 
-        GraphicalVertex::GraphicalVertex(const VertexInfo &vertex_info, const void *src_vertex)
-            : including_clusters_num(0)
+        GraphicalVertex::GraphicalVertex(const VertexInfo &vertex_info, const void *src_vertex, ClusterMembershipStore &memberships)
+            : memberships(&memberships), first_membership(0), including_clusters_num(0)
         {
             points_num = vertex_info.get_points_num();
             vectors_num = vertex_info.get_vectors_num();
@@ -37,15 +38,20 @@ namespace CrashAndSqueeze
             {
                 get_by_offset(src_vertex, vertex_info.get_point_offset(i), points[i]);
             }
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            current_pos = (points_num > 0) ? points[0] : Vector::ZERO;
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
 
             for(int i = 0; i < vectors_num; ++i)
             {
                 get_by_offset(src_vertex, vertex_info.get_vector_offset(i), vectors[i]);
                 vectors_orthogonality[i] = vertex_info.is_vector_orthogonal(i);
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
                 if (vertex_info.is_vector_orthogonal(i) && ! vectors[i].is_zero())
                 {
                     generated_normal = vectors[i].normalized();
                 }
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
             }
         }
 
@@ -156,21 +162,22 @@ namespace CrashAndSqueeze
             return get_point(0);
         }
 
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
         void GraphicalVertex::normalize_generated_normal()
         {
             if (!generated_normal.is_zero())
                 generated_normal.normalize();
         }
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
         
         void GraphicalVertex::include_to_one_more_cluster(int cluster_index, Real weight)
         {
-            if(VertexInfo::CLUSTER_INDICES_NUM == including_clusters_num)
+            if(NULL == memberships)
             {
-                Logger::error("in GraphicalVertex::include_to_one_more_cluster: cannot include to one more clusters, cluster indices limit exceeded", __FILE__, __LINE__);
+                Logger::error("in GraphicalVertex::include_to_one_more_cluster: vertex has no storage for cluster memberships", __FILE__, __LINE__);
                 return;
             }
-            cluster_indices[including_clusters_num] = static_cast<ClusterIndex>(cluster_index);
-            cluster_weights[including_clusters_num] = weight;
+            first_membership = memberships->add(first_membership, including_clusters_num, cluster_index, weight);
             ++including_clusters_num;
         }
 
@@ -184,27 +191,34 @@ namespace CrashAndSqueeze
             return true;
         }
 
-        ClusterIndex GraphicalVertex::get_including_cluster_index(int index) const
+        bool GraphicalVertex::check_cluster_index(int index) const
         {
-        #ifndef NDEBUG
-            if(index >= VertexInfo::CLUSTER_INDICES_NUM)
+            if(index < 0 || index >= including_clusters_num)
             {
-                Logger::error("in GraphicalVertex::get_including_cluster_index: index out of range", __FILE__, __LINE__);
-                return 0;
+                Logger::error("in GraphicalVertex::check_cluster_index: index out of range", __FILE__, __LINE__);
+                return false;
             }
+            return true;
+        }
+
+        int GraphicalVertex::get_including_cluster_index(int index) const
+        {
+        #ifndef NDEBUG
+            if(false == check_cluster_index(index))
+                return 0;
         #endif //ifndef NDEBUG
-            return cluster_indices[index];
+            return memberships->get_cluster_index(first_membership + index);
         }
 
         void GraphicalVertex::normalize_weights()
         {
             Real weight_sum = 0;
             for (int i = 0; i < including_clusters_num; ++i)
-                weight_sum += cluster_weights[i];
+                weight_sum += memberships->get_weight(first_membership + i);
             if ( weight_sum > 0 )
             {
                 for (int i = 0; i < including_clusters_num; ++i)
-                    cluster_weights[i] /= weight_sum;
+                    memberships->set_weight(first_membership + i, memberships->get_weight(first_membership + i) / weight_sum);
             }
             else
             {
@@ -215,13 +229,10 @@ namespace CrashAndSqueeze
         Real GraphicalVertex::get_cluster_weight(int index) const
         {
         #ifndef NDEBUG
-            if(index >= VertexInfo::CLUSTER_INDICES_NUM)
-            {
-                Logger::error("in GraphicalVertex::get_cluster_weight: index out of range", __FILE__, __LINE__);
+            if(false == check_cluster_index(index))
                 return 0;
-            }
         #endif //ifndef NDEBUG
-            return cluster_weights[index];
+            return memberships->get_weight(first_membership + index);
         }
 
     }
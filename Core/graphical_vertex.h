@@ -2,6 +2,7 @@
 #include "Core/core.h"
 #include "Core/vertex_info.h"
 #include "Core/ivertex.h"
+#include "Core/cluster_membership_store.h"
 #include "Math/vector.h"
 
 namespace CrashAndSqueeze
@@ -20,19 +21,24 @@ namespace CrashAndSqueeze
 #if CAS_QUADRATIC_EXTENSIONS_ENABLED
             // in case of quad.deformation normal transformation cannot be expressed analytically, so a complete generation required
             Math::Vector generated_normal;
+            // deformed position of the first point, stored when vertices are updated: normals are generated from it
+            Math::Vector current_pos;
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
 
-            ClusterIndex cluster_indices[VertexInfo::CLUSTER_INDICES_NUM];
-            // Weights for computing weighted average of positions from different clusters: to smooth borders between clusters
-            Math::Real cluster_weights[VertexInfo::CLUSTER_INDICES_NUM];
+            // Indices of including clusters and weights for computing weighted average of positions
+            // from different clusters (to smooth borders between clusters) are kept in `memberships'
+            // from first_membership to first_membership + including_clusters_num - 1
+            ClusterMembershipStore * memberships;
+            int first_membership;
             int including_clusters_num;
 
             bool check_point_index(int index) const;
             bool check_vector_index(int index) const;
+            bool check_cluster_index(int index) const;
 
         public:
             GraphicalVertex();
-            GraphicalVertex(const VertexInfo &vertex_info, const void *src_vertex);
+            GraphicalVertex(const VertexInfo &vertex_info, const void *src_vertex, ClusterMembershipStore &memberships);
 
             int get_points_num() const { return points_num; }
             const Math::Vector & get_point(int index) const;
@@ -52,6 +58,8 @@ namespace CrashAndSqueeze
             void add_to_generated_normal(const Math::Vector &addition) { generated_normal += addition; }
             void normalize_generated_normal();
             const Math::Vector &get_generated_normal() const { return generated_normal;  }
+            void set_current_pos(const Math::Vector & value) { current_pos = value; }
+            const Math::Vector &get_current_pos() const { return current_pos; }
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
 
 
@@ -62,7 +70,7 @@ namespace CrashAndSqueeze
             // Returns total number of clusters this vertex belongs to
             virtual int get_including_clusters_num() const { return including_clusters_num; }
             // Returns the index of i'th cluster this vertex belongs to
-            ClusterIndex get_including_cluster_index(int index) const;
+            int get_including_cluster_index(int index) const;
             // An assertion that checks if the vertex belongs to _any_ cluster
             virtual bool check_in_cluster();
             // and add something special:
@@ -1,5 +1,6 @@
 #pragma once
 #include "Math/vector.h"
+#include "Core/core.h"
 
 namespace CrashAndSqueeze
 {
@@ -15,6 +16,16 @@ namespace CrashAndSqueeze
             virtual Math::Vector get_vertex_equilibrium_pos(int index) const = 0;
             // returns initial position of vertex (constant)
             virtual Math::Vector get_vertex_initial_pos(int index) const = 0;
+
+            // writes equilibrium positions of vertices with given indices to `positions' (override
+            // to compute them in one pass instead of calling get_vertex_equilibrium_pos for each vertex)
+            virtual void get_vertices_equilibrium_pos(const IndexArray & indices, /*out*/ Math::Vector * positions) const
+            {
+                for(int i = 0; i < indices.size(); ++i)
+                {
+                    positions[i] = get_vertex_equilibrium_pos(indices[i]);
+                }
+            }
         };
     }
 }
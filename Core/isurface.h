@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef> // for NULL
+
 namespace CrashAndSqueeze
 {
     namespace Core
@@ -15,6 +17,13 @@ namespace CrashAndSqueeze
             {
                 unsigned indices[VERTICES_PER_TRIANGLE];
                 unsigned & operator[](unsigned i) { return indices[i]; }
+                unsigned operator[](unsigned i) const { return indices[i]; }
+            };
+            // Triangles stored contiguously: a pointer to the first of them and their number
+            struct TriangleArray
+            {
+                const Triangle * triangles;
+                int triangles_num;
             };
             // An iterator to loop through triangles of model
             class TriangleIterator
@@ -35,6 +44,15 @@ namespace CrashAndSqueeze
 
             // Deallocates the iterator when it is no longer needed
             virtual void destroy_iterator(TriangleIterator * iterator) = 0;
+
+            // Returns all triangles at once, if the surface stores them contiguously, so that they can be
+            // read without virtual calls per triangle. The array is valid until the surface is changed.
+            // By default returns NULL pointer: then triangles should be read with get_triangles()
+            virtual TriangleArray get_triangle_array()
+            {
+                TriangleArray result = {NULL, 0};
+                return result;
+            }
         };
     }
 }
\ No newline at end of file
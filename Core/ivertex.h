@@ -18,7 +18,7 @@ namespace CrashAndSqueeze
             // Returns total number of clusters this vertex belongs to
             virtual int get_including_clusters_num() const = 0;
             // Returns the index of i'th cluster this vertex belongs to. Can be identically 0 if the vertex doesn't store these indices (PhysicalVertex)
-            virtual ClusterIndex get_including_cluster_index(int i) const = 0;
+            virtual int get_including_cluster_index(int i) const = 0;
             // An assertion that checks if the vertex belongs to _any_ cluster
             virtual bool check_in_cluster() = 0;
         };
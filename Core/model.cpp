@@ -1,5 +1,7 @@
 #include "Core/model.h"
 #include "Core/isurface.h"
+#include <algorithm> // for std::sort
+#include <chrono>
 
 namespace CrashAndSqueeze
 {
@@ -9,11 +11,12 @@ namespace CrashAndSqueeze
     using Math::Real;
     using Math::equal;
     using Math::less_or_equal;
+    using Math::DEFAULT_REAL_PRECISION;
     using Math::sign;
     using Math::minimum;
+    using Math::maximum;
     using Logging::Logger;
     using Parallel::IPrimFactory;
-    using Parallel::TaskQueue;
     using Parallel::AbstractTask;
     
     namespace Core
@@ -26,7 +29,23 @@ namespace CrashAndSqueeze
             const Vector MAX_COORDINATE_VECTOR(MAX_COORDINATE, MAX_COORDINATE, MAX_COORDINATE);
             const int INITIAL_ALLOCATED_CALLBACK_INFOS = 10;
 
+            // vertices are updated by one task per worker (see IPrimFactory::get_workers_num), or by this number
+            // of tasks if the number of workers is unknown...
             const int DEFAULT_UPDATE_TASKS_NUM = 4;
+            // ...but no more than this number of tasks...
+            const int MAX_UPDATE_TASKS_NUM = 64;
+            // ...which claim chunks of vertices: a chunk is small enough for its part of vertex buffer to stay in L1 cache...
+            const int UPDATE_CHUNK_BYTES = 16*1024;
+            // ...but it has at least this number of vertices...
+            const int MIN_UPDATE_CHUNK_SIZE = 64;
+            // ...and chunks are made smaller if there are less than this number of them per task (to keep tasks balanced)
+            const int MIN_UPDATE_CHUNKS_PER_TASK = 4;
+            // vertices are integrated in parts of at least this size...
+            const int MIN_INTEGRATION_PART_SIZE = 1024;
+            // ...but no more than this number of parts
+            const int MAX_INTEGRATION_PARTS_NUM = 64;
+            // results of fired parallel reactions are kept for this number of steps, until they are invoked
+            const int REACTION_RESULTS_STEPS_NUM = 4;
 
             // -- helpers --
             template<class T>
@@ -36,6 +55,54 @@ namespace CrashAndSqueeze
                 arr.freeze();
             }
 
+            // returns size of chunks in which `vertices_num` vertices of `vertex_size` bytes are updated by `tasks_num` tasks
+            int get_update_chunk_size(int vertex_size, int vertices_num, int tasks_num)
+            {
+                int chunk_size = UPDATE_CHUNK_BYTES/vertex_size;
+                int balanced_chunk_size = vertices_num/(tasks_num*MIN_UPDATE_CHUNKS_PER_TASK);
+                if(balanced_chunk_size < chunk_size)
+                    chunk_size = balanced_chunk_size;
+                if(chunk_size < MIN_UPDATE_CHUNK_SIZE)
+                    chunk_size = MIN_UPDATE_CHUNK_SIZE;
+                return chunk_size;
+            }
+
+            // writes `indices_num' cluster indices of `vertex' of type IndexType,
+            // padding them with `null_index'
+            template<class IndexType, class VertexType>
+            inline void write_cluster_indices(/*out*/ void *out_indices, const VertexType &vertex, int indices_num, int null_index)
+            {
+                IndexType *out_cluster_indices = reinterpret_cast<IndexType*>(out_indices);
+                int clusters_num = minimum(vertex.get_including_clusters_num(), indices_num);
+                for(int j = 0; j < indices_num; ++j)
+                {
+                    if(j < clusters_num)
+                        out_cluster_indices[j] = static_cast<IndexType>(vertex.get_including_cluster_index(j));
+                    else
+                        out_cluster_indices[j] = static_cast<IndexType>(null_index);
+                }
+            }
+
+            // returns index of the first of `items_num' items, which belongs to i'th of `parts_num' equal parts
+            inline int get_part_begin(int items_num, int parts_num, int i)
+            {
+                return static_cast<int>( static_cast<long long>(items_num)*i/parts_num );
+            }
+
+            // compares physical vertices by a coordinate of their positions
+            class PositionLess
+            {
+            private:
+                const Vector * positions;
+                int axis;
+            public:
+                PositionLess(const Vector * positions, int axis)
+                    : positions(positions), axis(axis)
+                {}
+
+                bool operator()(int a, int b) const { return positions[a][axis] < positions[b][axis]; }
+            };
+
             // TODO: move to regions.cpp?
             // weight func for BoxRegion clusters
             class BoxRegionWeightFunc : public IScalarField
@@ -63,33 +130,77 @@ namespace CrashAndSqueeze
         }
 
         Model::ClusterTask::ClusterTask()
-            : cluster(NULL), dt(0) {}
+            : model(NULL), clusters(NULL), scheduler(NULL), dt(0), event_set(NULL), cluster_indices(NULL), clusters_num(0) {}
 
-        void Model::ClusterTask::setup(const Model & model, Cluster & cluster, Math::Real & dt, Parallel::IEventSet * event_set, int event_index)
+        void Model::ClusterTask::setup(const Model & model, Collections::Array<Cluster> & clusters, ClusterScheduler & scheduler, Math::Real & dt, Parallel::IEventSet * event_set)
         {
             this->model = &model;
-            this->cluster = &cluster;
+            this->clusters = &clusters;
+            this->scheduler = &scheduler;
             this->dt = &dt;
             this->event_set = event_set;
-            this->event_index = event_index;
+        }
+
+        void Model::ClusterTask::set_batch(const int * cluster_indices, int clusters_num)
+        {
+            this->cluster_indices = cluster_indices;
+            this->clusters_num = clusters_num;
         }
         
         void Model::ClusterTask::execute()
         {
-            if (NULL == cluster || NULL == model)
+            if (NULL == clusters || NULL == model)
                 Logger::error("In Model::ClusterTask::execute(): task not set up, call setup() first", __FILE__, __LINE__);
-            if (model->is_aborted()) return;
-            cluster->match_shape(*dt);
-            event_set->set(event_index);
+            for (int i = 0; i < clusters_num; ++i)
+            {
+                if (model->is_aborted()) return;
+
+                int index = cluster_indices[i];
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                (*clusters)[index].match_shape(*dt);
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                // measured time is used for scheduling of the next step
+                scheduler->set_measured_time(index, static_cast<Real>(elapsed.count()));
+
+                event_set->set(index);
+            }
+        }
+
+        Model::IntegrationTask::IntegrationTask()
+            : model(NULL), stage(0), part(0) {}
+
+        void Model::IntegrationTask::setup(Model *model, int stage, int part)
+        {
+            this->model = model;
+            this->stage = stage;
+            this->part = part;
         }
 
-        void Model::FinalTask::execute()
+        void Model::IntegrationTask::execute()
         {
-            model->integrate_particle_system();
+            if (NULL == model)
+                Logger::error("In Model::IntegrationTask::execute(): task not set up, call setup() first", __FILE__, __LINE__);
+            model->integrate_part(stage, part);
+        }
+
+        Model::IntegrationBarrierTask::IntegrationBarrierTask()
+            : model(NULL), stage(0) {}
+
+        void Model::IntegrationBarrierTask::setup(Model *model, int stage)
+        {
+            this->model = model;
+            this->stage = stage;
+        }
+
+        void Model::IntegrationBarrierTask::execute()
+        {
+            if (NULL == model)
+                Logger::error("In Model::IntegrationBarrierTask::execute(): task not set up, call setup() first", __FILE__, __LINE__);
+            model->prepare_integration_stage(stage);
         }
 
         Model::UpdateTask::UpdateTask()
-            : model(NULL), out_vertices(NULL), vertex_info(NULL), start_vertex(0), vertices_num(0), event_set(NULL), event_index(0) {}
+            : model(NULL), out_vertices(NULL), vertex_info(NULL), chunks(NULL), event_set(NULL), event_index(0) {}
 
         void Model::UpdateTask::setup_event(Parallel::IEventSet * event_set, int event_index)
         {
@@ -97,13 +208,12 @@ namespace CrashAndSqueeze
             this->event_index = event_index;
         }
 
-        void Model::UpdateTask::setup_args(Model *model, void *out_vertices, const VertexInfo &vertex_info, int start_vertex, int vertices_num)
+        void Model::UpdateTask::setup_args(Model *model, void *out_vertices, const VertexInfo &vertex_info, Parallel::ChunkedRange & chunks)
         {
             this->model = model;
             this->out_vertices = out_vertices;
             this->vertex_info = &vertex_info;
-            this->start_vertex = start_vertex;
-            this->vertices_num = vertices_num;
+            this->chunks = &chunks;
         }
 
         void Model::UpdateTask::execute()
@@ -119,7 +229,11 @@ namespace CrashAndSqueeze
                 return;
             }
             
-            model->update_vertices(out_vertices, *vertex_info, start_vertex, vertices_num);
+            int start_vertex, vertices_num;
+            while( ! model->is_aborted() && chunks->claim(start_vertex, vertices_num) )
+            {
+                model->skin_vertices(out_vertices, *vertex_info, start_vertex, vertices_num);
+            }
             event_set->set(event_index);
         }
 
@@ -136,13 +250,43 @@ namespace CrashAndSqueeze
                 return;
             }
 
-            model->update_vertices_vectors(out_vertices, *vertex_info, start_vertex, vertices_num);
+            int start_vertex, vertices_num;
+            while( ! model->is_aborted() && chunks->claim(start_vertex, vertices_num) )
+            {
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+                if (normals_needed)
+                    model->generate_normals_part(start_vertex, vertices_num);
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+                model->update_vectors_part(out_vertices, *vertex_info, start_vertex, vertices_num);
+            }
             event_set->set(event_index);
         }
 
-        void Model::GenerateNormalsTask::execute()
+        void Model::ReactionTask::execute()
         {
-            model->generate_normals();
+            if (NULL == model)
+            {
+                Logger::error("In Model::ReactionTask::execute(): task not set up, call setup() first", __FILE__, __LINE__);
+                return;
+            }
+
+            int first_reaction, reactions_num;
+            while( ! model->is_aborted() && model->reaction_chunks.claim(first_reaction, reactions_num) )
+            {
+                model->check_reactions(first_reaction, reactions_num);
+            }
+        }
+
+        void Model::ReactionsBarrierTask::execute()
+        {
+            if (NULL == model)
+            {
+                Logger::error("In Model::ReactionsBarrierTask::execute(): task not set up, call setup() first", __FILE__, __LINE__);
+                return;
+            }
+            if( model->deterministic )
+                model->push_ordered_reaction_results();
+            model->step_completed->set();
         }
 
         // a constant, determining how much deformation velocities are damped:
@@ -163,45 +307,64 @@ namespace CrashAndSqueeze
                       const MassFloat constant_mass /* = 1 */,
                       const MassFloat *masses /* = NULL */,
 
-                      IPrimFactory * prim_factory /* = &Parallel::SingleThreadFactory::instance */)
-            : vertices(physical_vetrices_num),
-              initial_positions(physical_vetrices_num),
-              hit_vertices_indices(physical_vetrices_num),
-              
+                      IPrimFactory * prim_factory /* = &Parallel::SingleThreadFactory::instance */,
+
+                      ClusteringMode clustering_mode /* = UNIFORM_CLUSTERING */)
+            : vertices_store(physical_vetrices_num),
+              vertices(physical_vetrices_num),
+              graphical_memberships(graphical_vetrices_num),
               graphical_vertices(graphical_vetrices_num),
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
               graphical_surface(nullptr),
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+              initial_positions(physical_vetrices_num),
+              parallel_reactions(false),
+              deterministic(false),
 
               cluster_padding_coeff(cluster_padding_coeff),
-
-              damping_constant(DEFAULT_DAMPING_CONSTANT),
+              clustering_mode(clustering_mode),
+              cluster_regions(NULL),
+              null_cluster_index(0),
 
               min_pos(MAX_COORDINATE_VECTOR),
               max_pos(-MAX_COORDINATE_VECTOR),
 
-              body(NULL),
-              frame(NULL),
-
-              cluster_regions(NULL),
-              null_cluster_index(0),
-
-              velocities_changed_callback(NULL),
+              damping_constant(DEFAULT_DAMPING_CONSTANT),
 
-              prim_factory(prim_factory),
-              cluster_tasks_completed(NULL),
               cluster_tasks(NULL),
-#pragma warning( push )
-#pragma warning( disable : 4355 )
-              final_task(this),
-#if CAS_QUADRATIC_EXTENSIONS_ENABLED
-              gen_normals_task(this),
-#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
-#pragma warning( pop )
+              cluster_tasks_num(0),
+              cluster_scheduler(NULL),
+              integration_tasks(NULL),
+              integration_parts_num(0),
+              center_of_mass_sums(NULL),
+              inertia_tensor_sums(NULL),
+              linear_velocity_sums(NULL),
+              angular_momentum_sums(NULL),
               update_tasks(NULL),
               update_tasks_num(0),
-              task_queue(NULL),
+              reaction_tasks(NULL),
+              reaction_tasks_num(0),
+              reaction_results(NULL),
+              update_vectors_tasks(NULL),
+              integration_tasks_successors(NULL),
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+              normals_barrier_task_successors(NULL),
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+              prim_factory(prim_factory),
+              cluster_tasks_completed(NULL),
               step_completed(NULL),
               update_pos_tasks_completed(NULL),
-              success(true)
+              task_queue(NULL),
+              success(true),
+
+              velocities_changed_callback(NULL),
+
+              body(NULL),
+              frame(NULL),
+
+              hit_vertices_indices(physical_vetrices_num),
+              hit_grid_outdated(true),
+              sleeping_clusters_num(0)
         {
             // -- Finish initialization of arrays --
             // -- (create enought items and freeze or just forbid reallocations) --
@@ -227,6 +390,8 @@ namespace CrashAndSqueeze
                 {
                     if( false != init_clusters() )
                     {
+                        skinning.init(graphical_vertices, clusters);
+
                         // Update cluster indices for graphical vertices
                         update_cluster_indices(source_graphical_vertices, graphical_vetrices_num, graphical_vertices, graphical_vertex_info);
                         update_cluster_indices(source_physical_vertices, physical_vetrices_num, vertices, physical_vertex_info);
@@ -272,7 +437,7 @@ namespace CrashAndSqueeze
                     mass = static_cast<Real>(constant_mass);
                 }
                 
-                vertices[i] = PhysicalVertex(pos, mass);
+                vertices[i] = PhysicalVertex(vertices_store, pos, mass);
                 initial_positions[i] = pos;
                 
                 for(int j = 0; j < VECTOR_SIZE; ++j)
@@ -287,7 +452,7 @@ namespace CrashAndSqueeze
                 source_vertex = add_to_pointer(source_vertex, vertex_info.get_vertex_size());
             }
             
-            body = new Body(vertices);
+            body = new Body(vertices_store);
             return true;
         }
         
@@ -301,7 +466,7 @@ namespace CrashAndSqueeze
             const void * source_graphical_vertex = source_vertices;
             for(int i = 0; i < graphical_vertices.size(); ++i)
             {
-                graphical_vertices[i] = GraphicalVertex(vertex_info, source_graphical_vertex);
+                graphical_vertices[i] = GraphicalVertex(vertex_info, source_graphical_vertex, graphical_memberships);
 #if CAS_QUADRATIC_EXTENSIONS_ENABLED
                 if (!has_any_normal && graphical_vertices[i].get_orthogonal_vectors_num() > 0) {
                     has_any_normal = true;
@@ -318,8 +483,6 @@ namespace CrashAndSqueeze
             for(int i = 0; i < VECTOR_SIZE; ++i)
                 clusters_num *= clusters_by_axes[i];
 
-            const Vector dimensions = max_pos - min_pos;
-
             for(int i = 0; i < VECTOR_SIZE; ++i)
             {
                 if(0 == clusters_by_axes[i])
@@ -327,26 +490,54 @@ namespace CrashAndSqueeze
                     Logger::error("creating model with zero clusters_by_axes component", __FILE__, __LINE__);
                     return false;
                 }
-                cluster_sizes[i] = dimensions[i]/clusters_by_axes[i];
             }
 
+            // -- Split the bounding box into cells of cluster grid --
+            int slabs_num = 1;
+            for(int i = 0; i < VECTOR_SIZE; ++i)
+            {
+                slabs_num *= clusters_by_axes[i];
+                make_fixed_size(cell_starts[i], slabs_num);
+                make_fixed_size(cell_sizes[i], slabs_num);
+            }
+
+            if(BALANCED_CLUSTERING == clustering_mode)
+            {
+                Collections::Array<int> order(vertices.size());
+                for(int i = 0; i < vertices.size(); ++i)
+                    order.push_back(i);
+                split_balanced(0, 0, order, 0, order.size());
+            }
+            else
+            {
+                split_uniformly(0, 0);
+            }
+
+            // -- Create a region for each cell --
             cluster_regions = new RegionsArray(clusters_num);
             cluster_weight_funcs = new WeightFuncsArray(clusters_num);
 
-            const Vector padding = cluster_sizes*cluster_padding_coeff;
-
-            for(int ix = 0; ix < clusters_by_axes[0]; ++ix)
+            int cell[VECTOR_SIZE];
+            for(cell[0] = 0; cell[0] < clusters_by_axes[0]; ++cell[0])
             {
-                for(int iy = 0; iy < clusters_by_axes[1]; ++iy)
+                for(cell[1] = 0; cell[1] < clusters_by_axes[1]; ++cell[1])
                 {
-                    for(int iz = 0; iz < clusters_by_axes[2]; ++iz)
+                    for(cell[2] = 0; cell[2] < clusters_by_axes[2]; ++cell[2])
                     {
-                        Vector min_corner = min_pos
-                                          + Vector(ix*cluster_sizes[0],
-                                                   iy*cluster_sizes[1],
-                                                   iz*cluster_sizes[2])
-                                          - padding;
-                        Vector max_corner = min_corner + cluster_sizes + 2*padding;
+                        Vector start;
+                        Vector sizes;
+                        int parent = 0;
+                        for(int i = 0; i < VECTOR_SIZE; ++i)
+                        {
+                            int index = get_first_cell(i, parent) + cell[i];
+                            start[i] = cell_starts[i][index];
+                            sizes[i] = cell_sizes[i][index];
+                            parent = index;
+                        }
+                        const Vector padding = sizes*cluster_padding_coeff;
+
+                        Vector min_corner = start - padding;
+                        Vector max_corner = min_corner + sizes + 2*padding;
                         BoxRegion * region = new BoxRegion(min_corner, max_corner);
                         cluster_regions->push_back( region );
                         cluster_weight_funcs->push_back( new BoxRegionWeightFunc(region, padding) );
@@ -356,12 +547,73 @@ namespace CrashAndSqueeze
             return true;
         }
 
+        void Model::split_uniformly(int axis, int parent)
+        {
+            const int cells_num = clusters_by_axes[axis];
+            const int first_cell = get_first_cell(axis, parent);
+            const Real size = (max_pos[axis] - min_pos[axis])/cells_num;
+
+            for(int i = 0; i < cells_num; ++i)
+            {
+                cell_starts[axis][first_cell + i] = min_pos[axis] + i*size;
+                cell_sizes[axis][first_cell + i] = size;
+                if(axis < VECTOR_SIZE - 1)
+                    split_uniformly(axis + 1, first_cell + i);
+            }
+        }
+
+        void Model::split_balanced(int axis, int parent, Collections::Array<int> & order, int begin, int end)
+        {
+            const int cells_num = clusters_by_axes[axis];
+            const int first_cell = get_first_cell(axis, parent);
+            const int vertices_num = end - begin;
+
+            if(vertices_num < cells_num)
+            {
+                // too few vertices to balance: cells of equal size are not worse
+                split_uniformly(axis, parent);
+                return;
+            }
+
+            const Vector * positions = vertices_store.get_positions();
+            int * items = &order[begin];
+            std::sort(items, items + vertices_num, PositionLess(positions, axis));
+
+            // i'th cell gets i'th of `cells_num' equal parts of sorted vertices, and the border between
+            // cells is in the middle between the last vertex of one and the first vertex of another
+            Real start = min_pos[axis];
+            for(int i = 0; i < cells_num; ++i)
+            {
+                int next_cell_begin = get_part_begin(vertices_num, cells_num, i + 1);
+                Real next_start = (cells_num - 1 == i)
+                                ? max_pos[axis]
+                                : (positions[items[next_cell_begin - 1]][axis] + positions[items[next_cell_begin]][axis])/2;
+
+                // vertices with equal coordinates make an empty cell: keep its size (and so padding)
+                // positive, otherwise its weight function divides by zero padding
+                Real size = next_start - start;
+                if(size < DEFAULT_REAL_PRECISION)
+                    size = DEFAULT_REAL_PRECISION;
+
+                cell_starts[axis][first_cell + i] = start;
+                cell_sizes[axis][first_cell + i] = size;
+                start = next_start;
+            }
+
+            // split cells along next axes only after all borders are found: it reorders vertices of each cell
+            if(axis < VECTOR_SIZE - 1)
+            {
+                for(int i = 0; i < cells_num; ++i)
+                    split_balanced(axis + 1, first_cell + i, order, begin + get_part_begin(vertices_num, cells_num, i), begin + get_part_begin(vertices_num, cells_num, i + 1));
+            }
+        }
+
         bool Model::init_clusters()
         {
             int clusters_num = cluster_regions->size();
 
             // after last cluster
-            null_cluster_index = static_cast<ClusterIndex>(clusters_num);
+            null_cluster_index = clusters_num;
 
             clusters.create_items(clusters_num);
             clusters.freeze();
@@ -394,6 +646,24 @@ namespace CrashAndSqueeze
                 graphical_vertices[i].normalize_weights();
             }
 
+            // all memberships are known now: allocate places for additions from each cluster
+            vertices_store.allocate_cluster_slots();
+
+            // -- For each vertex: find including clusters (to wake them up) --
+            first_vertex_clusters.create_items(vertices.size() + 1);
+            first_vertex_clusters[0] = 0;
+            for(int i = 0; i < vertices.size(); ++i)
+                first_vertex_clusters[i + 1] = first_vertex_clusters[i] + vertices[i].get_including_clusters_num();
+            IndexArray next(vertices.size());
+            for(int i = 0; i < vertices.size(); ++i)
+                next.push_back(first_vertex_clusters[i]);
+            vertex_clusters.create_items(first_vertex_clusters[vertices.size()]);
+            for(int i = 0; i < clusters.size(); ++i)
+            {
+                for(int k = 0; k < clusters[i].get_physical_vertices_num(); ++k)
+                    vertex_clusters[next[clusters[i].get_physical_vertex(k).get_index()]++] = i;
+            }
+
             // -- For each cluster: precompute (and compute center of mass of a whole) --
             center_of_mass = Vector::ZERO;
             Real total_mass = 0;
@@ -417,55 +687,192 @@ namespace CrashAndSqueeze
 
             found_clusters.clear();
 
-            // While looking for cluster containing this vertex,find the one
-            // with minimal distance (it will be used, if none containing found)
-            Real min_distance = Math::MAX_REAL;
-            int min_distance_index = -1;
-            for(int i = 0; i < cluster_regions->size(); ++i)
+            const Vector & pos = vertex.get_pos();
+
+            // Check regions of cells which can contain the vertex (in order of cluster indices)
+            int first[VECTOR_SIZE];
+            int last[VECTOR_SIZE];
+            int cell[VECTOR_SIZE];
+            get_candidate_cells(pos, 0, 0, first[0], last[0]);
+            for(cell[0] = first[0]; cell[0] <= last[0]; ++cell[0])
             {
-                const IRegion * region = cluster_regions->get(i);
-                if( region->contains(vertex.get_pos()) )
-                {
-                    Real weight = cluster_weight_funcs->get(i)->get_value_at(vertex.get_pos());
-                    vertex.include_to_one_more_cluster(i, weight);
-                    found_clusters.push_back( &clusters[i] );
-                }
-                else
+                get_candidate_cells(pos, 1, cell[0], first[1], last[1]);
+                for(cell[1] = first[1]; cell[1] <= last[1]; ++cell[1])
                 {
-                    double dst = distance( vertex.get_pos(), region->get_center() );
-                    if(dst < min_distance)
+                    get_candidate_cells(pos, 2, cell[0]*clusters_by_axes[1] + cell[1], first[2], last[2]);
+                    for(cell[2] = first[2]; cell[2] <= last[2]; ++cell[2])
                     {
-                        min_distance = dst;
-                        min_distance_index = i;
+                        int i = get_cluster_index(cell);
+                        if( cluster_regions->get(i)->contains(pos) )
+                        {
+                            Real weight = cluster_weight_funcs->get(i)->get_value_at(pos);
+                            vertex.include_to_one_more_cluster(i, weight);
+                            found_clusters.push_back( &clusters[i] );
+                        }
                     }
                 }
             }
 
-            // If not found good cluster...
+            // If not found good cluster, take the one with the nearest center:
+            // the nearest slab along each axis (exactly the nearest center for uniform grid)
             if(0 == vertex.get_including_clusters_num())
             {
-                vertex.include_to_one_more_cluster(min_distance_index, 1);
-                found_clusters.push_back( &clusters[min_distance_index] );
+                int parent = 0;
+                for(int i = 0; i < VECTOR_SIZE; ++i)
+                {
+                    cell[i] = get_nearest_cell(pos, i, parent);
+                    parent = get_first_cell(i, parent) + cell[i];
+                }
+
+                int nearest_index = get_cluster_index(cell);
+                vertex.include_to_one_more_cluster(nearest_index, 1);
+                found_clusters.push_back( &clusters[nearest_index] );
             }
 
             return true;
         }
 
+        void Model::get_candidate_cells(const Vector & point, int axis, int parent, /*out*/ int & first, /*out*/ int & last) const
+        {
+            const int cells_num = clusters_by_axes[axis];
+            const int first_cell = get_first_cell(axis, parent);
+
+            if(BALANCED_CLUSTERING != clustering_mode)
+            {
+                const Real size = cell_sizes[axis][first_cell];
+                if( less_or_equal(size, 0) )
+                {
+                    // all cells are the same along this axis
+                    first = 0;
+                    last = cells_num - 1;
+                    return;
+                }
+
+                // i'th cell spans from i*size - padding to (i + 1)*size + padding
+                // (relative to the start of the first one): take one more cell on each side against rounding errors
+                const Real padding = size*cluster_padding_coeff;
+                const Real offset = point[axis] - cell_starts[axis][first_cell];
+                Real first_cell_num = floor( (offset - padding)/size ) - 1;
+                Real last_cell_num = floor( (offset + padding)/size ) + 1;
+
+                first = (first_cell_num < 0) ? 0 : static_cast<int>( minimum<Real>(first_cell_num, cells_num) );
+                last = (last_cell_num > cells_num - 1) ? cells_num - 1 : static_cast<int>( maximum<Real>(last_cell_num, -1) );
+                return;
+            }
+
+            // with balanced clustering cells of a slab are of different sizes (and paddings),
+            // but they are few: just check them all, the same way as their regions do
+            first = cells_num;
+            last = -1;
+            for(int i = 0; i < cells_num; ++i)
+            {
+                const Real size = cell_sizes[axis][first_cell + i];
+                const Real padding = size*cluster_padding_coeff;
+                const Real cell_min = cell_starts[axis][first_cell + i] - padding;
+                const Real cell_max = cell_min + size + 2*padding;
+                if( point[axis] >= cell_min && point[axis] <= cell_max )
+                {
+                    if(i < first)
+                        first = i;
+                    last = i;
+                }
+            }
+        }
+
+        int Model::get_nearest_cell(const Vector & point, int axis, int parent) const
+        {
+            const int cells_num = clusters_by_axes[axis];
+            const int first_cell = get_first_cell(axis, parent);
+
+            // on a tie, the lower cell is taken
+            int nearest = 0;
+            Real min_distance = Math::MAX_REAL;
+            for(int i = 0; i < cells_num; ++i)
+            {
+                const Real center = cell_starts[axis][first_cell + i] + cell_sizes[axis][first_cell + i]/2;
+                const Real distance = fabs(point[axis] - center);
+                if(distance < min_distance)
+                {
+                    min_distance = distance;
+                    nearest = i;
+                }
+            }
+            return nearest;
+        }
+
         void Model::init_tasks()
         {
             int clusters_num = clusters.size();
             cluster_tasks = new ClusterTask[clusters_num];
-            task_queue = new TaskQueue(clusters_num + 1 + 2*DEFAULT_UPDATE_TASKS_NUM+1, prim_factory);
+
+            integration_parts_num = vertices.size() / MIN_INTEGRATION_PART_SIZE;
+            if(integration_parts_num < 1)
+                integration_parts_num = 1;
+            if(integration_parts_num > MAX_INTEGRATION_PARTS_NUM)
+                integration_parts_num = MAX_INTEGRATION_PARTS_NUM;
+
+            // as many tasks as there are workers to complete them
+            update_tasks_num = prim_factory->get_workers_num();
+            if(Parallel::IPrimFactory::UNKNOWN_WORKERS_NUM == update_tasks_num)
+                update_tasks_num = DEFAULT_UPDATE_TASKS_NUM;
+            if(update_tasks_num < 1)
+                update_tasks_num = 1;
+            if(update_tasks_num > MAX_UPDATE_TASKS_NUM)
+                update_tasks_num = MAX_UPDATE_TASKS_NUM;
+
+            // reaction tasks are pushed after integration tasks, but before update tasks are
+            reaction_tasks_num = update_tasks_num;
+
+            task_queue = prim_factory->create_task_queue(clusters_num + integration_parts_num + 1 + 2*update_tasks_num+1 + reaction_tasks_num+1, this);
             cluster_tasks_completed = prim_factory->create_event_set(clusters_num, true);
             step_completed = prim_factory->create_event(true);
             normals_generated = prim_factory->create_event(true);
+            // integration begins with the first barrier, pushed by the last completed cluster task
+            for(int i = 0; i <= INTEGRATION_STAGES_NUM; ++i)
+            {
+                integration_barrier_tasks[i].setup(this, i);
+                integration_barriers_successors[i] = &integration_barrier_tasks[i];
+            }
+            // cluster tasks are connected to the first barrier in schedule_cluster_tasks, when their number is known
+            cluster_scheduler = new ClusterScheduler(clusters_num);
             for(int i = 0; i < clusters_num; ++i)
             {
-                cluster_tasks[i].setup(*this, clusters[i], dt, cluster_tasks_completed, i);
+                cluster_tasks[i].setup(*this, clusters, *cluster_scheduler, dt, cluster_tasks_completed);
+                cluster_scheduler->set_estimated_cost(i, ClusterScheduler::estimate_cost(clusters[i]));
             }
+
+            // each barrier pushes tasks of the next stage, and the last completed of them pushes the next barrier
+            int integration_tasks_num = INTEGRATION_STAGES_NUM*integration_parts_num;
+            integration_tasks = new IntegrationTask[integration_tasks_num];
+            integration_tasks_successors = new AbstractTask*[integration_tasks_num];
+            for(int stage = 0; stage < INTEGRATION_STAGES_NUM; ++stage)
+            {
+                AbstractTask ** stage_tasks = &integration_tasks_successors[stage*integration_parts_num];
+                for(int part = 0; part < integration_parts_num; ++part)
+                {
+                    IntegrationTask & task = integration_tasks[stage*integration_parts_num + part];
+                    task.setup(this, stage, part);
+                    task.set_successors(&integration_barriers_successors[stage + 1], 1, task_queue);
+                    stage_tasks[part] = &task;
+                }
+                integration_barrier_tasks[stage].set_successors(stage_tasks, integration_parts_num, task_queue);
+            }
+            center_of_mass_sums = new Vector[integration_parts_num];
+            inertia_tensor_sums = new Matrix[integration_parts_num];
+            linear_velocity_sums = new Vector[integration_parts_num];
+            angular_momentum_sums = new Vector[integration_parts_num];
             // NB: now tasks are not pushed to queue here: they are pushed either in Model::compute_next_step_async or in Model::update_vertices_async
 
-            update_tasks_num = DEFAULT_UPDATE_TASKS_NUM;
+            // reaction tasks are pushed by the last integration barrier, and the last completed of them pushes reactions_barrier_task
+            reaction_tasks = new ReactionTask[reaction_tasks_num];
+            reactions_barrier_task.setup(this);
+            reaction_tasks_successors[0] = &reactions_barrier_task;
+            for (int i = 0; i < reaction_tasks_num; ++i)
+            {
+                reaction_tasks[i].setup(this);
+                reaction_tasks[i].set_successors(reaction_tasks_successors, 1, task_queue);
+            }
+
             update_tasks = new UpdateTask[update_tasks_num];
             update_vectors_tasks = new UpdateVectorsTask[update_tasks_num];
             update_pos_tasks_completed = prim_factory->create_event_set(update_tasks_num, true);
@@ -478,6 +885,16 @@ namespace CrashAndSqueeze
             {
                 update_vectors_tasks[i].setup_event(update_vec_tasks_completed, i);
             }
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            // update tasks are connected to normals_barrier_task only when normals are generated (see Model::update_vertices_async)
+            update_tasks_successors[0] = &normals_barrier_task;
+            normals_barrier_task_successors = new AbstractTask*[update_tasks_num];
+            for (int i = 0; i < update_tasks_num; ++i)
+            {
+                normals_barrier_task_successors[i] = &update_vectors_tasks[i];
+            }
+            normals_barrier_task.set_successors(normals_barrier_task_successors, update_tasks_num, task_queue);
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
         }
 
         Vector Model::get_vertex_initial_pos(int index) const
@@ -491,10 +908,29 @@ namespace CrashAndSqueeze
             return relative_to_frame.get_orientation() * (vertices[index].get_equilibrium_pos() + relative_to_frame.get_position());
         }
 
+        void Model::get_vertices_equilibrium_pos(const IndexArray & indices, /*out*/ Vector * positions) const
+        {
+            // the same as get_vertex_equilibrium_pos for each index, but the frame transformation
+            // is fetched once for the whole batch
+            const Vector & shift = relative_to_frame.get_position();
+            const Matrix & orientation = relative_to_frame.get_orientation();
+            const Real m00 = orientation.get_at(0,0), m01 = orientation.get_at(0,1), m02 = orientation.get_at(0,2);
+            const Real m10 = orientation.get_at(1,0), m11 = orientation.get_at(1,1), m12 = orientation.get_at(1,2);
+            const Real m20 = orientation.get_at(2,0), m21 = orientation.get_at(2,1), m22 = orientation.get_at(2,2);
+            for(int i = 0; i < indices.size(); ++i)
+            {
+                const Vector shifted = vertices[indices[i]].get_equilibrium_pos() + shift;
+                const Real x = shifted[0], y = shifted[1], z = shifted[2];
+                positions[i] = Vector( m00*x + m01*y + m02*z,
+                                       m10*x + m11*y + m12*z,
+                                       m20*x + m21*y + m22*z );
+            }
+        }
+
         void Model::set_frame(const IndexArray &frame_indices)
         {
             delete frame;
-            frame = new Body(vertices, frame_indices);
+            frame = new Body(vertices_store, frame_indices);
             frame->compute_properties();
         }
 
@@ -538,12 +974,32 @@ namespace CrashAndSqueeze
 
             // -- Find vertices in this region --
 
-            for(int i = 0; i < vertices.size(); ++i)
+            Vector min_corner, max_corner;
+            if( region.get_bounding_box(min_corner, max_corner) )
             {
-                PhysicalVertex &v = vertices[i];
+                // only vertices in cells of the grid intersecting the box are checked
+                if( hit_grid_outdated )
+                {
+                    hit_grid.build(vertices_store.get_positions(), vertices.size());
+                    hit_grid_outdated = false;
+                }
+                hit_candidates.clear();
+                hit_grid.find_candidates(min_corner, max_corner, hit_candidates);
+                for(int i = 0; i < hit_candidates.size(); ++i)
+                {
+                    if( region.contains(vertices[hit_candidates[i]].get_pos()) )
+                        hit_vertices_indices.push_back(hit_candidates[i]);
+                }
+            }
+            else
+            {
+                for(int i = 0; i < vertices.size(); ++i)
+                {
+                    PhysicalVertex &v = vertices[i];
 
-                if( region.contains(v.get_pos()) )
-                    hit_vertices_indices.push_back(i);
+                    if( region.contains(v.get_pos()) )
+                        hit_vertices_indices.push_back(i);
+                }
             }
 
             // -- Report warning if none found --
@@ -559,6 +1015,7 @@ namespace CrashAndSqueeze
             for(int i = 0; i < hit_vertices_indices.size(); ++i)
             {
                 vertices[ hit_vertices_indices[i] ].add_to_velocity(velocity);
+                wake_clusters_of_vertex(hit_vertices_indices[i]);
             }
 
             // -- Invoke reactions if needed --
@@ -574,16 +1031,89 @@ namespace CrashAndSqueeze
             if (0 == displacements.size())
                 return;
 
+            hit_grid_outdated = true;
+
             // TODO: develop this method
             // - probably it should apply displacements more accurately? (averaging if multiple displacements for one vertex?)
             // - think about physical nature of such displacement - doesn't it violate conservation of energy/momentum/...?
             // - maybe it should look more like Model::hit? Do we need a new kind of reaction for this?
             for (int i = 0; i < vertices.size(); ++i)
             {
+                if (sleeping_clusters_num > 0)
+                {
+                    for (int j = 0; j < displacements.size(); ++j)
+                    {
+                        if (displacements[j]->is_applied_to(vertices[i].get_pos()))
+                        {
+                            wake_clusters_of_vertex(i);
+                            break;
+                        }
+                    }
+                }
                 vertices[i].apply_displacements(displacements);
             }
         }
 
+        void Model::wake_clusters_of_vertex(int vertex_index)
+        {
+            for (int k = first_vertex_clusters[vertex_index]; k < first_vertex_clusters[vertex_index + 1]; ++k)
+            {
+                Cluster & cluster = clusters[vertex_clusters[k]];
+                if (cluster.is_sleeping())
+                {
+                    cluster.wake_up();
+                    woken_clusters.push_back(vertex_clusters[k]);
+                }
+            }
+        }
+
+        void Model::update_sleeping_clusters()
+        {
+            // -- Wake up disturbed clusters, and put idle ones to sleep --
+            for (int i = 0; i < clusters.size(); ++i)
+            {
+                Cluster & cluster = clusters[i];
+                if (cluster.is_sleeping())
+                {
+                    if (cluster.is_disturbed(*forces))
+                    {
+                        cluster.wake_up();
+                        woken_clusters.push_back(i);
+                    }
+                }
+                else
+                {
+                    cluster.try_to_fall_asleep();
+                }
+            }
+
+            // -- Wake up neighbours of woken clusters (only direct ones: further ones will be woken up if disturbed) --
+            for (int i = 0; i < woken_clusters.size(); ++i)
+            {
+                const Cluster & cluster = clusters[woken_clusters[i]];
+                for (int k = 0; k < cluster.get_physical_vertices_num(); ++k)
+                {
+                    int vertex_index = cluster.get_physical_vertex(k).get_index();
+                    for (int j = first_vertex_clusters[vertex_index]; j < first_vertex_clusters[vertex_index + 1]; ++j)
+                        clusters[vertex_clusters[j]].wake_up();
+                }
+            }
+            woken_clusters.clear();
+
+            // -- Only awake clusters are scheduled: sleeping ones are completed at once --
+            sleeping_clusters_num = 0;
+            for (int i = 0; i < clusters.size(); ++i)
+            {
+                bool sleeping = clusters[i].is_sleeping();
+                cluster_scheduler->set_active(i, ! sleeping);
+                if (sleeping)
+                {
+                    cluster_tasks_completed->set(i);
+                    ++sleeping_clusters_num;
+                }
+            }
+        }
+
         void Model::compute_next_step_async(const ForcesArray & forces, Math::Real dt, VelocitiesChangedCallback * vcb)
         {
             // wait for previous step to complete
@@ -592,6 +1122,8 @@ namespace CrashAndSqueeze
             // reset events
             cluster_tasks_completed->unset();
             step_completed->unset();
+            // vertices will move
+            hit_grid_outdated = true;
             
             // store parameters of this step
             this->dt = dt;
@@ -601,13 +1133,56 @@ namespace CrashAndSqueeze
             // Success is true until some error happens and it is set to false
             success = true; // TODO: use safer mechanism for storing this state
             
-            // add new tasks to queue
+            // add new tasks to queue: integration tasks will be added by the last completed cluster task
             task_queue->clear();
-            for(int i = 0; i < clusters.size(); ++i)
+            update_sleeping_clusters();
+            schedule_cluster_tasks();
+            for(int i = 0; i <= INTEGRATION_STAGES_NUM; ++i)
+            {
+                integration_barrier_tasks[i].reset_dependencies();
+            }
+            for(int i = 0; i < INTEGRATION_STAGES_NUM*integration_parts_num; ++i)
+            {
+                integration_tasks[i].reset_dependencies();
+            }
+            if(parallel_reactions)
+            {
+                // each reaction is fired at most once per step: keep room for results of a few steps
+                // (the queue grows if it was created for fewer reactions)
+                int results_max_size = maximum(1, REACTION_RESULTS_STEPS_NUM*reactions.size());
+                if(NULL == reaction_results || reaction_results->get_max_size() < results_max_size)
+                    resize_reaction_results(results_max_size);
+                reactions_barrier_task.reset_dependencies();
+            }
+            // tasks are ordered longest first
+            for(int i = 0; i < cluster_tasks_num; ++i)
+            {
+                bool fire_event = (i == cluster_tasks_num - 1); // fire event only after adding last task
+                task_queue->push(&cluster_tasks[i], fire_event);
+            }
+            // if all clusters are sleeping, there is no cluster task to push the first barrier
+            if(0 == cluster_tasks_num)
+                task_queue->push(&integration_barrier_tasks[0], true);
+        }
+
+        void Model::schedule_cluster_tasks()
+        {
+            cluster_scheduler->schedule();
+
+            int new_tasks_num = cluster_scheduler->get_batches_num();
+            for(int i = 0; i < new_tasks_num; ++i)
+            {
+                cluster_tasks[i].set_batch(cluster_scheduler->get_batch(i), cluster_scheduler->get_batch_size(i));
+                if(i >= cluster_tasks_num)
+                    cluster_tasks[i].set_successors(&integration_barriers_successors[0], 1, task_queue);
+            }
+            // unused tasks must not be waited for by the barrier
+            for(int i = new_tasks_num; i < cluster_tasks_num; ++i)
             {
-                task_queue->push(&cluster_tasks[i], false); // add task, but not fire event
+                cluster_tasks[i].set_batch(NULL, 0);
+                cluster_tasks[i].set_successors(NULL, 0, task_queue);
             }
-            task_queue->push(&final_task, true); // add last task and fire event
+            cluster_tasks_num = new_tasks_num;
         }
 
         void Model::compute_next_step(const ForcesArray & forces, Math::Real dt, VelocitiesChangedCallback * vcb)
@@ -655,95 +1230,273 @@ namespace CrashAndSqueeze
             step_completed->set();
         }
 
-        void Model::integrate_particle_system()
+        void Model::get_integration_part(int part, /*out*/ int & start_vertex, /*out*/ int & vertices_num) const
         {
-            cluster_tasks_completed->wait();
-
-            // TODO: place it somewhere more logical
-            reactions.freeze();
-
-            // Re-compute properties (due to changed positions of vertices)
-            if( is_aborted() || false == body->compute_properties() )
-                return;
-
-            // -- Force linear and angular momenta conservation --
+            int part_size = vertices.size() / integration_parts_num;
+            start_vertex = part*part_size;
+            // last part may be bigger if vertices number is not divisible by integration_parts_num
+            vertices_num = (part < integration_parts_num - 1) ? part_size : vertices.size() - start_vertex;
+        }
 
-            if(is_aborted() || false == body->compute_velocity_additions())
+        void Model::integrate_part(int stage, int part)
+        {
+            if( is_aborted() )
                 return;
 
-            body->compensate_velocities( body->get_linear_velocity_addition(),
-                                         body->get_angular_velocity_addition() );
+            int start_vertex, vertices_num;
+            get_integration_part(part, start_vertex, vertices_num);
 
-            // -- For each vertex of model: integrate velocities: sum velocity additions and apply forces --
-            for(int i = 0; i < vertices.size() && !is_aborted(); ++i)
+            switch(stage)
             {
-                if( false == vertices[i].integrate_velocity( *forces, dt ) )
-                    return;
+            case CENTER_OF_MASS_STAGE:
+                center_of_mass_sums[part] = body->sum_center_of_mass(start_vertex, vertices_num);
+                break;
+
+            case VELOCITY_ADDITIONS_STAGE:
+                inertia_tensor_sums[part] = body->sum_inertia_tensor(start_vertex, vertices_num);
+                if( false == body->sum_velocity_additions(start_vertex, vertices_num, linear_velocity_sums[part], angular_momentum_sums[part]) )
+                    success = false;
+                break;
+
+            case VELOCITIES_STAGE:
+                // -- Force linear and angular momenta conservation --
+                body->compensate_velocities( body->get_linear_velocity_addition(),
+                                             body->get_angular_velocity_addition(),
+                                             start_vertex, vertices_num );
+
+                // -- For each vertex: integrate velocities: sum velocity additions and apply forces --
+                if( false == vertices_store.integrate_velocities( *forces, dt, start_vertex, vertices_num ) )
+                    success = false;
+                break;
+
+            case MOMENTA_STAGE:
+                body->sum_velocities(start_vertex, vertices_num, linear_velocity_sums[part], angular_momentum_sums[part]);
+                break;
+
+            case POSITIONS_STAGE:
+                // Damp deformation oscillations
+                body->set_rigid_motion(*body, damping_constant, start_vertex, vertices_num);
+
+                // -- Substract macroscopic motion of body --
+                // (to make the reference frame of center of mass current reference frame again)
+                body->compensate_velocities(body->get_linear_velocity(), body->get_angular_velocity(), start_vertex, vertices_num);
+
+                // -- For each vertex: integrate positions --
+                vertices_store.integrate_positions(dt, start_vertex, vertices_num);
+                break;
             }
+        }
 
-            if( NULL != frame && !is_aborted() )
+        void Model::prepare_integration_stage(int stage)
+        {
+            switch(stage)
             {
-                // -- Ensure that the frame moves as a rigid body --
+            case CENTER_OF_MASS_STAGE:
+                // TODO: place it somewhere more logical
+                reactions.freeze();
+                break;
+
+            case VELOCITY_ADDITIONS_STAGE:
+                // Re-compute properties (due to changed positions of vertices): center of mass is needed for the inertia tensor
+                if( ! is_aborted() && false == body->set_center_of_mass(center_of_mass_sums, integration_parts_num) )
+                    success = false;
+                break;
+
+            case VELOCITIES_STAGE:
+                if( ! is_aborted() )
+                {
+                    body->set_inertia_tensor(inertia_tensor_sums, integration_parts_num);
+                    if( false == body->set_velocity_additions(linear_velocity_sums, angular_momentum_sums, integration_parts_num) )
+                        success = false;
+                }
+                break;
 
-                if( false == frame->compute_properties() )
-                    return;
-                if( false == frame->compute_velocities() )
-                    return;
+            case MOMENTA_STAGE:
+                if( NULL != frame && !is_aborted() )
+                {
+                    // -- Ensure that the frame moves as a rigid body --
+
+                    if( false == frame->compute_properties() || false == frame->compute_velocities() )
+                    {
+                        success = false;
+                        break;
+                    }
+                    frame->set_rigid_motion();
+                }
+                break;
+
+            case POSITIONS_STAGE:
+                // Find macroscopic motion for damping and subsequent subtraction
+                if( is_aborted() || false == body->set_velocities(linear_velocity_sums, angular_momentum_sums, integration_parts_num) )
+                {
+                    success = false;
+                    break;
+                }
+
+                if(NULL != velocities_changed_callback)
+                {
+                    velocities_changed_callback->invoke( body->get_linear_velocity(),
+                                                         body->get_angular_velocity() );
+                }
+                break;
 
-                frame->set_rigid_motion();
+            case INTEGRATION_STAGES_NUM:
+                if( NULL != frame && !is_aborted() )
+                {
+                    // -- If there is the frame, relative_to_frame should repeat its inverted motion --
+
+                    // Re-compute frame velocities, changed after the call of body->compensate_velocities
+                    if( false == frame->compute_properties() || false == frame->compute_velocities() )
+                    {
+                        success = false;
+                    }
+                    else
+                    {
+                        relative_to_frame.set_linear_velocity( - frame->get_linear_velocity() );
+                        relative_to_frame.set_angular_velocity( - frame->get_angular_velocity() );
+                        relative_to_frame.integrate(dt);
+                    }
+                }
+
+                // if reactions are parallel, the step is completed by reactions_barrier_task
+                if( parallel_reactions && reactions.size() > 0 && ! is_aborted() )
+                    start_reaction_tasks();
+                else
+                    step_completed->set();
+                break;
             }
+        }
 
-            // Find macroscopic motion for damping and subsequent subtraction
-            if( is_aborted() || false == body->compute_velocities() )
-                return;
+        void Model::start_reaction_tasks()
+        {
+            // -- Gather vertices watched by reactions and compute their positions --
 
-            // Damp deformation oscillations
-            body->set_rigid_motion(damping_constant);
+            watched_vertices.reset(vertices.size());
+            for (int i = 0; i < reactions.size(); ++i)
+            {
+                reactions[i]->watch_vertices(watched_vertices);
+            }
+            watched_vertices.compute_positions(*this);
 
-            // -- Substract macroscopic motion of body --
-            // (to make the reference frame of center of mass current reference frame again)
+            if( deterministic )
+            {
+                ordered_reaction_results.clear();
+                ordered_reaction_results.create_items(reactions.size());
+            }
 
-            if(NULL != velocities_changed_callback)
+            // -- Let tasks check reactions by chunks --
+
+            int chunk_size = reactions.size()/(reaction_tasks_num*MIN_UPDATE_CHUNKS_PER_TASK);
+            reaction_chunks.reset(0, reactions.size(), maximum(1, chunk_size));
+            for (int i = 0; i < reaction_tasks_num; ++i)
             {
-                velocities_changed_callback->invoke( body->get_linear_velocity(),
-                                                     body->get_angular_velocity() );
+                bool fire_event = (i == reaction_tasks_num - 1); // fire event only after adding last task
+                task_queue->push(&reaction_tasks[i], fire_event);
             }
+        }
 
-            body->compensate_velocities(body->get_linear_velocity(), body->get_angular_velocity());
+        void Model::resize_reaction_results(int max_size)
+        {
+            // called between steps: no task pushes results now, so the ones not invoked yet can be moved
+            Parallel::LockFreeResultQueue<ReactionResult> * old_results = reaction_results;
+            reaction_results = new Parallel::LockFreeResultQueue<ReactionResult>(max_size);
+            if(NULL != old_results)
+            {
+                ReactionResult result;
+                while( old_results->pop(result) )
+                {
+                    reaction_results->push(result);
+                }
+                delete old_results;
+            }
+        }
 
-            // -- For each vertex of model: integrate positions --
-            for(int i = 0; i < vertices.size() && !is_aborted(); ++i)
+        void Model::check_reactions(int first_reaction, int reactions_num)
+        {
+            for (int i = first_reaction; i < first_reaction + reactions_num; ++i)
             {
-                vertices[i].integrate_position(dt);
+                ReactionResult result;
+                // other reactions are checked by react_to_events
+                bool fired = reactions[i]->is_checked_with_watched()
+                             && reactions[i]->is_invoke_needed(*this, watched_vertices, result);
+                if( deterministic )
+                {
+                    // pushed later in the order of reactions
+                    if( ! fired )
+                        result.reaction = NULL;
+                    ordered_reaction_results[i] = result;
+                }
+                else if( fired )
+                {
+                    if( false == reaction_results->push(result) )
+                        Logger::warning("in Model::check_reactions: too many fired reactions, call Model::react_to_events to invoke them", __FILE__, __LINE__);
+                }
             }
+        }
 
-            if( NULL != frame && !is_aborted() )
+        void Model::push_ordered_reaction_results()
+        {
+            for (int i = 0; i < ordered_reaction_results.size(); ++i)
             {
-                // -- If there is the frame, relative_to_frame should repeat its inverted motion --
+                if( NULL == ordered_reaction_results[i].reaction )
+                    continue;
+                if( false == reaction_results->push(ordered_reaction_results[i]) )
+                    Logger::warning("in Model::push_ordered_reaction_results: too many fired reactions, call Model::react_to_events to invoke them", __FILE__, __LINE__);
+            }
+        }
 
-                // Re-compute frame velocities, changed after the call of body->compensate_velocities
-                if( false == frame->compute_properties() )
-                    return;
-                if( false == frame->compute_velocities() )
-                    return;
+        void Model::set_deterministic(bool value)
+        {
+            deterministic = value;
 
-                relative_to_frame.set_linear_velocity( - frame->get_linear_velocity() );
-                relative_to_frame.set_angular_velocity( - frame->get_angular_velocity() );
-                relative_to_frame.integrate(dt);
+            const ClusterKernels & kernels = value ? *ClusterKernels::get(ClusterKernels::SCALAR) : ClusterKernels::get_best();
+            for (int i = 0; i < clusters.size(); ++i)
+            {
+                clusters[i].set_kernels(kernels);
             }
-            
-            step_completed->set();
+            skinning.set_simd_enabled( ! value );
         }
 
-        // TODO: is this function thread-safe? Reading matrix from RigidBody is not atomic.
-        // Should use locks for access to RigidBody methods?
         void Model::react_to_events()
         {
+            // -- Invoke reactions fired in tasks of previous steps --
+
+            if( NULL != reaction_results )
+            {
+                ReactionResult result;
+                while( reaction_results->pop(result) )
+                {
+                    result.reaction->invoke_with(*this, result);
+                }
+            }
+            if( parallel_reactions )
+            {
+                // reactions, which can't be checked by tasks, are checked here
+                for (int i = 0; i < reactions.size(); ++i)
+                {
+                    if( ! reactions[i]->is_checked_with_watched() )
+                        reactions[i]->invoke_if_needed(*this);
+                }
+                return;
+            }
+
+            // -- Gather vertices watched by reactions --
+
+            watched_vertices.reset(vertices.size());
+            for (int i = 0; i < reactions.size(); ++i)
+            {
+                reactions[i]->watch_vertices(watched_vertices);
+            }
+
+            // -- Compute their positions in one pass --
+
+            watched_vertices.compute_positions(*this);
+
             // -- Invoke reactions if needed --
 
             for (int i = 0; i < reactions.size(); ++i)
             {
-                reactions[i]->invoke_if_needed(*this);
+                reactions[i]->invoke_if_needed(*this, watched_vertices);
             }
         }
 
@@ -813,19 +1566,37 @@ namespace CrashAndSqueeze
                 Logger::warning("in Model::update_vertices: requested to update wrong number of vertices, probably wrong vertices given?", __FILE__, __LINE__);
                 vertices_num = minimum(vertices_num, src_vertices.size());
             }
+            if(static_cast<unsigned>(null_cluster_index) > vertex_info.get_max_cluster_index())
+            {
+                Logger::error("in Model::update_cluster_indices: too many clusters for cluster index size, set wider indices with VertexInfo::set_cluster_indices_format", __FILE__, __LINE__);
+                return;
+            }
+
+            int indices_num = vertex_info.get_cluster_indices_num();
+            bool indices_truncated = false;
+
             void *out_vertex = out_vertices;
             for(int i = 0; i < vertices_num; ++i)
             {
                 int including_clusters_num = src_vertices[i].get_including_clusters_num();
+                if(including_clusters_num > indices_num)
+                {
+                    indices_truncated = true;
+                    including_clusters_num = indices_num;
+                }
 
-                ClusterIndex *out_cluster_indices =
-                    reinterpret_cast<ClusterIndex*>( add_to_pointer(out_vertex, vertex_info.get_cluster_indices_offset()) );
-                for(int j = 0; j < VertexInfo::CLUSTER_INDICES_NUM; ++j)
+                void *out_cluster_indices = add_to_pointer(out_vertex, vertex_info.get_cluster_indices_offset());
+                switch(vertex_info.get_cluster_index_size())
                 {
-                    if(j < including_clusters_num)
-                        out_cluster_indices[j] = src_vertices[i].get_including_cluster_index(j);
-                    else
-                        out_cluster_indices[j] = null_cluster_index;
+                case 1:
+                    write_cluster_indices<unsigned char>(out_cluster_indices, src_vertices[i], indices_num, null_cluster_index);
+                    break;
+                case 2:
+                    write_cluster_indices<unsigned short>(out_cluster_indices, src_vertices[i], indices_num, null_cluster_index);
+                    break;
+                default:
+                    write_cluster_indices<unsigned int>(out_cluster_indices, src_vertices[i], indices_num, null_cluster_index);
+                    break;
                 }
                 int *out_clusters_num =
                     reinterpret_cast<int*>(add_to_pointer(out_vertex, vertex_info.get_clusters_num_offset()));
@@ -833,6 +1604,9 @@ namespace CrashAndSqueeze
 
                 out_vertex = add_to_pointer(out_vertex, vertex_info.get_vertex_size());
             }
+
+            if(indices_truncated)
+                Logger::warning("in Model::update_cluster_indices: some vertices belong to more clusters than there are cluster indices in vertex structure, extra clusters are not written", __FILE__, __LINE__);
         }
 
         bool Model::process_update_vertices_args(const VertexInfo &vertex_info, /*in/out*/ int & start_vertex, /*in/out*/ int & vertices_num) const
@@ -876,16 +1650,25 @@ namespace CrashAndSqueeze
             // reset event set
             update_pos_tasks_completed->unset();
 
-            int part_size = vertices_num / update_tasks_num;
-            int last_part_size = vertices_num - part_size*(update_tasks_num - 1); // last part may be bigger if vertices_num is not divisible by update_tasks_num
+            // transformations are packed once, before tasks are started
+            skinning.set_transforms(clusters);
+            if (0 == start_vertex && graphical_vertices.size() == vertices_num)
+                skinning.mark_all_written();
+
+            // tasks claim chunks of vertices dynamically, so idle workers take work from busy ones
+            int chunk_size = get_update_chunk_size(vertex_info.get_vertex_size(), vertices_num, update_tasks_num);
 
             // Success is true until some error happens and it is set to false
             success = true;
 
+            // if true, then vectors are updated after generating normals, which are generated after updating positions
+            bool normals_needed = false;
+
             if (update_vectors)
             {
                 // if asked to update vectors - configure UpdateVectorsTasks as well
                 update_vec_tasks_completed->unset();
+                update_vec_chunks.reset(start_vertex, vertices_num, chunk_size);
 #if CAS_QUADRATIC_EXTENSIONS_ENABLED
                 if (has_any_normal)
                 {
@@ -897,8 +1680,7 @@ namespace CrashAndSqueeze
                     }
                     else
                     {
-                        normals_generated->unset();
-                        task_queue->push(&gen_normals_task, false);
+                        normals_needed = true;
                     }
                 }
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
@@ -906,25 +1688,37 @@ namespace CrashAndSqueeze
                 for (int i = 0; i < update_tasks_num; ++i)
                 {
                     UpdateVectorsTask * task = &update_vectors_tasks[i];
+                    task->setup_args(this, out_vertices, vertex_info, update_vec_chunks);
+                    task->set_normals_needed(normals_needed);
 
-                    // Setup arguments
-                    int my_start_vertex = start_vertex + i*part_size;
-                    int my_vertices_num = (i < update_tasks_num - 1) ? part_size : last_part_size;
-                    task->setup_args(this, out_vertices, vertex_info, my_start_vertex, my_vertices_num);
+                    // otherwise the task is pushed by normals_barrier_task
+                    if ( ! normals_needed )
+                        task_queue->push(task, false);
+                }
+            }
 
-                    task_queue->push(task, false);
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            // build the task graph: normals_barrier_task is pushed by the last completed update task
+            for (int i = 0; i < update_tasks_num; ++i)
+            {
+                update_tasks[i].set_successors(update_tasks_successors, normals_needed ? 1 : 0, task_queue);
+            }
+            if (normals_needed)
+            {
+                normals_barrier_task.reset_dependencies();
+                for (int i = 0; i < update_tasks_num; ++i)
+                {
+                    update_vectors_tasks[i].reset_dependencies();
                 }
             }
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
 
             // configure main tasks
+            update_pos_chunks.reset(start_vertex, vertices_num, chunk_size);
             for (int i = 0; i < update_tasks_num; ++i)
             {
                 UpdateTask * task = &update_tasks[i];
-
-                // Setup arguments
-                int my_start_vertex = start_vertex + i*part_size;
-                int my_vertices_num = (i < update_tasks_num - 1) ? part_size : last_part_size;
-                task->setup_args(this, out_vertices, vertex_info, my_start_vertex, my_vertices_num);
+                task->setup_args(this, out_vertices, vertex_info, update_pos_chunks);
 
                 bool fire_event = (i == update_tasks_num - 1); // fire event only after adding last task
                 task_queue->push(task, fire_event);
@@ -945,38 +1739,136 @@ namespace CrashAndSqueeze
             if (false == process_update_vertices_args(vertex_info, start_vertex, vertices_num))
                 return;
 
+            skinning.set_transforms(clusters);
+            if (0 == start_vertex && graphical_vertices.size() == vertices_num)
+                skinning.mark_all_written();
+            skin_vertices(out_vertices, vertex_info, start_vertex, vertices_num);
+        }
+
+        int Model::update_changed_vertices(/*out*/ void *out_vertices, const VertexInfo &vertex_info, bool update_vectors, /*out*/ VertexRangesArray & updated_ranges)
+        {
+            int start_vertex = 0;
+            int vertices_num = ALL_VERTICES;
+            if (false == process_update_vertices_args(vertex_info, start_vertex, vertices_num))
+                return 0;
+
+            if (vertex_changes.size() != graphical_vertices.size())
+            {
+                vertex_changes.clear();
+                vertex_changes.create_items(graphical_vertices.size());
+            }
+            for (int i = 0; i < vertex_changes.size(); ++i)
+                vertex_changes[i] = 0;
+
+            // find vertices of changed clusters
+            skinning.set_transforms(clusters);
+            for (int c = 0; c < clusters.size(); ++c)
+            {
+                if (skinning.is_changed(c))
+                {
+                    for (int k = 0; k < skinning.get_cluster_vertices_num(c); ++k)
+                        vertex_changes[skinning.get_cluster_vertex(c, k)] |= POSITION_CHANGED;
+                    skinning.mark_written(c);
+                }
+            }
+
+            VertexRangesArray ranges;
+            get_changed_ranges(POSITION_CHANGED, ranges);
+            for (int r = 0; r < ranges.size(); ++r)
+                skin_vertices(out_vertices, vertex_info, ranges[r].start_vertex, ranges[r].vertices_num);
+
+            unsigned char updated_changes = POSITION_CHANGED;
+            if (update_vectors)
+            {
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+                bool normals_needed = has_any_normal && NULL != graphical_surface;
+                if (normals_needed)
+                {
+                    // normals are generated from positions of neighbours: regenerate them around changed vertices
+                    for (int i = 0; i < vertex_changes.size(); ++i)
+                    {
+                        if (0 == (vertex_changes[i] & POSITION_CHANGED))
+                            continue;
+                        for (int k = 0; k < surface_adjacency.get_vertex_triangles_num(i); ++k)
+                        {
+                            int triangle = surface_adjacency.get_vertex_triangle(i, k);
+                            for (int j = 0; j < ISurface::VERTICES_PER_TRIANGLE; ++j)
+                                vertex_changes[surface_adjacency.get_triangle_vertex(triangle, j)] |= NORMAL_CHANGED;
+                        }
+                    }
+                    updated_changes |= NORMAL_CHANGED;
+                }
+                ranges.clear();
+                get_changed_ranges(updated_changes, ranges);
+                for (int r = 0; r < ranges.size(); ++r)
+                {
+                    if (normals_needed)
+                        generate_normals_part(ranges[r].start_vertex, ranges[r].vertices_num);
+                    update_vectors_part(out_vertices, vertex_info, ranges[r].start_vertex, ranges[r].vertices_num);
+                }
+#else
+                for (int r = 0; r < ranges.size(); ++r)
+                    update_vectors_part(out_vertices, vertex_info, ranges[r].start_vertex, ranges[r].vertices_num);
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+            }
+
+            int updated_vertices_num = 0;
+            ranges.clear();
+            get_changed_ranges(updated_changes, ranges);
+            for (int r = 0; r < ranges.size(); ++r)
+            {
+                updated_ranges.push_back(ranges[r]);
+                updated_vertices_num += ranges[r].vertices_num;
+            }
+            return updated_vertices_num;
+        }
+
+        void Model::get_changed_ranges(unsigned char changes, /*out*/ VertexRangesArray & ranges) const
+        {
+            int i = 0;
+            while (i < vertex_changes.size())
+            {
+                if (0 == (vertex_changes[i] & changes))
+                {
+                    ++i;
+                    continue;
+                }
+                VertexRange range;
+                range.start_vertex = i;
+                while (i < vertex_changes.size() && 0 != (vertex_changes[i] & changes))
+                    ++i;
+                range.vertices_num = i - range.start_vertex;
+                ranges.push_back(range);
+            }
+        }
+
+        void Model::skin_vertices(/*out*/ void *out_vertices, const VertexInfo &vertex_info, int start_vertex, int vertices_num)
+        {
             int last_vertex = start_vertex + vertices_num - 1;
 
-            void *out_vertex = add_to_pointer(out_vertices, start_vertex*vertex_info.get_vertex_size());;
+            void *out_vertex = add_to_pointer(out_vertices, start_vertex*vertex_info.get_vertex_size());
             for(int i = start_vertex; i <= last_vertex && !is_aborted(); ++i)
             {
-                const GraphicalVertex & vertex = graphical_vertices[i];
-                int clusters_num = vertex.get_including_clusters_num();
-                if(0 == clusters_num)
+                if(0 == skinning.get_clusters_num(i))
                 {
                     Logger::error("GraphicalVertex doesn't belong to any cluster", __FILE__, __LINE__);
                     return;
                 }
 
-                for(int j = 0; j < vertex_info.get_points_num() && !is_aborted(); ++j)
+                for(int j = 0; j < vertex_info.get_points_num(); ++j)
                 {
-                    Vector new_point = Vector::ZERO;
-                    for( int k = 0; k < clusters_num && !is_aborted(); ++k)
-                    {
-                        const Cluster & cluster = clusters[vertex.get_including_cluster_index(k)];
-#if CAS_QUADRATIC_EXTENSIONS_ENABLED
-                        new_point += (cluster.get_graphical_pos_transform() * Math::TriVector(vertex.get_point(j) - cluster.get_initial_center_of_mass())
-                                   + cluster.get_center_of_mass()) * vertex.get_cluster_weight(k);
-#else
-                        new_point += (cluster.get_graphical_pos_transform() * (vertex.get_point(j) - cluster.get_initial_center_of_mass())
-                                   + cluster.get_center_of_mass()) * vertex.get_cluster_weight(k);
-#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
-                    }
+                    VertexFloat new_point[Skinning::COLUMN_SIZE];
+                    skinning.compute_point(i, j, new_point);
 
                     VertexFloat *destination =
                         reinterpret_cast<VertexFloat*>( add_to_pointer(out_vertex, vertex_info.get_point_offset(j)) );
 
-                    VertexInfo::vector_to_vertex_floats(new_point, destination);
+                    for(int c = 0; c < VECTOR_SIZE; ++c)
+                        destination[c] = new_point[c];
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+                    if (0 == j)
+                        graphical_vertices[i].set_current_pos(Vector(new_point[0], new_point[1], new_point[2]));
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
                 }
 
                 out_vertex = add_to_pointer(out_vertex, vertex_info.get_vertex_size());
@@ -989,12 +1881,17 @@ namespace CrashAndSqueeze
             if (false == process_update_vertices_args(vertex_info, start_vertex, vertices_num))
                 return;
 
-            int last_vertex = start_vertex + vertices_num - 1;
-
 #if CAS_QUADRATIC_EXTENSIONS_ENABLED
             normals_generated->wait();
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
 
+            update_vectors_part(out_vertices, vertex_info, start_vertex, vertices_num);
+        }
+
+        void Model::update_vectors_part(/*out*/ void *out_vertices, const VertexInfo &vertex_info, int start_vertex, int vertices_num)
+        {
+            int last_vertex = start_vertex + vertices_num - 1;
+
             void *out_vertex = add_to_pointer(out_vertices, start_vertex*vertex_info.get_vertex_size());;
             for (int i = start_vertex; i <= last_vertex && !is_aborted(); ++i)
             {
@@ -1053,36 +1950,63 @@ namespace CrashAndSqueeze
 
         void Model::generate_normals()
         {
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
             if (graphical_surface == NULL) {
                 return;
             }
-            
-            for (unsigned i = 0; i < graphical_vertices.size() && !is_aborted(); ++i)
-                graphical_vertices[i].set_generated_normal(Vector::ZERO);
-
-            ISurface::TriangleIterator * triangle_iterator = graphical_surface->get_triangles();
-            for (ISurface::TriangleIterator & t = *triangle_iterator; t.has_value() && !is_aborted(); ++t)
-            {
-                // Find normal of triangle
-                ISurface::Triangle triangle = *t;
-                const Vector * positions[ISurface::VERTICES_PER_TRIANGLE];
-                for (unsigned i = 0; i < ISurface::VERTICES_PER_TRIANGLE; ++i)
-                    positions[i] = &graphical_vertices[triangle[i]].get_pos();
-                Vector v1 = (*positions[1]) - (*positions[0]);
-                Vector v2 = (*positions[2]) - (*positions[0]);
-                Vector n = cross_product(v1, v2);
-                // For each vertex normals triangle normals are summed from each triangle it is used in
-                for (unsigned i = 0; i < ISurface::VERTICES_PER_TRIANGLE; ++i)
-                    graphical_vertices[triangle[i]].add_to_generated_normal(n);
-            }
-
-            // And finally each normal is normalized
-            for (unsigned i = 0; i < graphical_vertices.size() && !is_aborted(); ++i)
-                graphical_vertices[i].normalize_generated_normal();
 
-            graphical_surface->destroy_iterator(triangle_iterator);
-            
+            generate_normals_part(0, graphical_vertices.size());
+
             normals_generated->set();
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+        }
+
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+        void Model::generate_normals_part(int start_vertex, int vertices_num)
+        {
+            if (surface_adjacency.get_vertices_num() != graphical_vertices.size())
+                return;
+
+            int last_vertex = start_vertex + vertices_num - 1;
+            for (int i = start_vertex; i <= last_vertex && !is_aborted(); ++i)
+            {
+                // Normal of each vertex is a sum of normals of triangles it is used in
+                Vector normal = Vector::ZERO;
+                for (int k = 0; k < surface_adjacency.get_vertex_triangles_num(i); ++k)
+                {
+                    int triangle = surface_adjacency.get_vertex_triangle(i, k);
+                    const Vector & p0 = graphical_vertices[surface_adjacency.get_triangle_vertex(triangle, 0)].get_current_pos();
+                    const Vector & p1 = graphical_vertices[surface_adjacency.get_triangle_vertex(triangle, 1)].get_current_pos();
+                    const Vector & p2 = graphical_vertices[surface_adjacency.get_triangle_vertex(triangle, 2)].get_current_pos();
+                    normal += cross_product(p1 - p0, p2 - p0);
+                }
+                // And finally it is normalized
+                graphical_vertices[i].set_generated_normal(normal);
+                graphical_vertices[i].normalize_generated_normal();
+            }
+        }
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+
+        void Model::set_graphical_surface(ISurface * surface)
+        {
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            graphical_surface = surface;
+            surface_adjacency.clear();
+            if (NULL != surface)
+                surface_adjacency.build(*surface, graphical_vertices.size());
+#else
+            // normals are updated linearly, so the surface is not needed
+            ignore_unreferenced(surface);
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+        }
+
+        ISurface * Model::get_graphical_surface()
+        {
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            return graphical_surface;
+#else
+            return NULL;
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
         }
 
         void Model::update_current_positions(/*out*/ void *out_vertices, int vertices_num, const VertexInfo &vertex_info)
@@ -1106,9 +2030,23 @@ namespace CrashAndSqueeze
             delete frame;
 
             delete[] cluster_tasks;
+            delete cluster_scheduler;
+            delete[] integration_tasks;
+            delete[] integration_tasks_successors;
+            delete[] center_of_mass_sums;
+            delete[] inertia_tensor_sums;
+            delete[] linear_velocity_sums;
+            delete[] angular_momentum_sums;
+            delete[] update_tasks;
+            delete[] update_vectors_tasks;
+            delete[] reaction_tasks;
+            delete reaction_results;
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            delete[] normals_barrier_task_successors;
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
             prim_factory->destroy_event_set(cluster_tasks_completed);
             prim_factory->destroy_event(step_completed);
-            delete task_queue;
+            prim_factory->destroy_task_queue(task_queue);
         }
     }
 }
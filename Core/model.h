@@ -3,21 +3,27 @@
 #include "Core/vertex_info.h"
 #include "Core/imodel.h"
 #include "Core/cluster.h"
+#include "Core/cluster_scheduler.h"
 #include "Core/force.h"
 #include "Core/reactions.h"
 #include "Core/body.h"
 #include "Core/regions.h"
 #include "Core/rigid_body.h"
 #include "Core/graphical_vertex.h"
+#include "Core/skinning.h"
+#include "Core/surface_adjacency.h"
+#include "Core/vertex_grid.h"
 #include "Core/simulation_params.h"
 #include "Math/floating_point.h"
 #include "Math/Vector.h"
 #include "Math/Matrix.h"
 #include "Collections/array.h"
 #include "Parallel/abstract_task.h"
-#include "Parallel/task_queue.h"
+#include "Parallel/itask_queue.h"
 #include "Parallel/single_thread_prim.h"
 #include "Parallel/itask_executor.h"
+#include "Parallel/chunked_range.h"
+#include "Parallel/lock_free_result_queue.h"
 
 namespace CrashAndSqueeze
 {
@@ -29,6 +35,25 @@ namespace CrashAndSqueeze
             virtual void invoke(const Math::Vector &linear_velocity_change, const Math::Vector &angular_velocity_change) = 0;
         };
 
+        // How bounding box of a model is split into clusters_by_axes clusters. In both cases the box is split
+        // into slabs along X axis, each of them into slabs along Y axis, and those in turn along Z axis
+        enum ClusteringMode
+        {
+            // all slabs along an axis are of equal size
+            UNIFORM_CLUSTERING,
+            // slabs contain equal numbers of physical vertices, so that clusters are of roughly equal
+            // cost even if vertices are distributed unevenly
+            BALANCED_CLUSTERING
+        };
+
+        // A range of vertices: from start_vertex to start_vertex + vertices_num - 1
+        struct VertexRange
+        {
+            int start_vertex;
+            int vertices_num;
+        };
+
+        typedef Collections::Array<VertexRange> VertexRangesArray;
         typedef Collections::Array<IRegion*> RegionsArray;
         typedef Collections::Array<IScalarField*> WeightFuncsArray;
         class ISurface;
@@ -38,13 +63,34 @@ namespace CrashAndSqueeze
         private:
             // -- constant (at run-time) properties
             
+            // properties of physical vertices, stored as contiguous streams
+            PhysicalVertexStore vertices_store;
+            // references to vertices of vertices_store
             Collections::Array<PhysicalVertex> vertices;
+            // cluster memberships of graphical vertices
+            ClusterMembershipStore graphical_memberships;
             Collections::Array<GraphicalVertex> graphical_vertices;
             Collections::Array<Cluster> clusters;
+            // clusters of i'th physical vertex are in vertex_clusters from first_vertex_clusters[i] to first_vertex_clusters[i + 1] - 1
+            IndexArray first_vertex_clusters;
+            IndexArray vertex_clusters;
+            // precomputed offsets of graphical vertices and packed transformations of clusters
+            Skinning skinning;
+            // used by Model::update_changed_vertices: for each graphical vertex, a combination of VertexChange flags
+            Collections::Array<unsigned char> vertex_changes;
+            enum VertexChange
+            {
+                // vertex belongs to a changed cluster
+                POSITION_CHANGED = 1,
+                // vertex shares a triangle with a vertex of a changed cluster, so its normal is changed (for QX only)
+                NORMAL_CHANGED = 2
+            };
 
 #if CAS_QUADRATIC_EXTENSIONS_ENABLED
             // needed only for generating normals from scratch (for quad.deformation only - otherwise normals simply updated linearly from original values)
             ISurface * graphical_surface;
+            // triangles of graphical_surface, read once when it is set, so that normals are generated in parallel
+            SurfaceAdjacency surface_adjacency;
             bool has_any_normal; // do we need normal generation at all?
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
 
@@ -53,24 +99,33 @@ namespace CrashAndSqueeze
             Collections::Array<Math::Vector> initial_positions;
 
             Collections::Array<ModelReaction *> reactions;
+            // vertices checked by reactions: their positions are computed at once for all reactions
+            WatchedVertices watched_vertices;
+            // if true, reactions are checked by tasks of the step (see Model::set_parallel_reactions)
+            bool parallel_reactions;
+            // if true, results don't depend on CPU and workers (see Model::set_deterministic)
+            bool deterministic;
             // hit reactions are invoked differently, so that they are stored separately
             Collections::Array<HitReaction *> hit_reactions;
 
             // -- fields used in initialization --
             int clusters_by_axes[Math::VECTOR_SIZE];
             Math::Real cluster_padding_coeff;
+            ClusteringMode clustering_mode;
+            // Cells of cluster grid: for each axis, starts and sizes of cells along it, for all
+            // slabs of previous axes one after another (see get_first_cell)
+            Collections::Array<Math::Real> cell_starts[Math::VECTOR_SIZE];
+            Collections::Array<Math::Real> cell_sizes[Math::VECTOR_SIZE];
             // TODO: check for memory leaks from such not deleted arrays like cluster_regions
             RegionsArray * cluster_regions;
             WeightFuncsArray * cluster_weight_funcs;
             // index of zero cluster matrix (normally it is equal to clusters_num because this zero matrix is placed after the last cluster matrix)
-            ClusterIndex null_cluster_index;
+            int null_cluster_index;
             
             // minimum values of coordinates of vertices
             Math::Vector min_pos;
             // maximum values of coordinates of vertices
             Math::Vector max_pos;
-            // dimensions of a cluster
-            Math::Vector cluster_sizes;
             // all-model center of mass
             Math::Vector center_of_mass;
             
@@ -90,52 +145,129 @@ namespace CrashAndSqueeze
             
             bool create_auto_cluster_regions();
 
+            // splits slab `parent' of previous axis into cells of equal size along given axis, and so on for next axes
+            void split_uniformly(int axis, int parent);
+            // splits slab `parent' of previous axis into cells along given axis, containing equal numbers
+            // of physical vertices given by `order[begin]' .. `order[end - 1]' (which are reordered), and so on for next axes
+            void split_balanced(int axis, int parent, Collections::Array<int> & order, int begin, int end);
+
             bool init_clusters();
 
             template <class VertexType /*: public IVertex*/>
             void update_cluster_indices(/*out*/ void *out_vertices, int vertices_num, const Collections::Array<VertexType> & src_vertices, const VertexInfo &vertex_info);
             
+            // Finds clusters, containing the vertex, or the nearest one if none. Clusters are
+            // looked up directly in the grid of auto cluster regions, so that only regions of
+            // a few neighbouring cells are checked
             bool find_clusters_for_vertex(IVertex &vertex, /*out*/ Collections::Array<Cluster *> & found_clusters);
 
+            // returns index (in cell_starts[axis] and cell_sizes[axis]) of the first cell along given axis
+            // in slab `parent' of previous axis (which is `cell[0]' for Y axis and `cell[0]*clusters_by_axes[1] + cell[1]' for Z axis)
+            int get_first_cell(int axis, int parent) const { return parent*clusters_by_axes[axis]; }
+            // finds the range of cells of slab `parent' along given axis, which can contain given point (with padding)
+            void get_candidate_cells(const Math::Vector & point, int axis, int parent, /*out*/ int & first, /*out*/ int & last) const;
+            // returns the cell of slab `parent' along given axis, which center is the nearest to given point
+            int get_nearest_cell(const Math::Vector & point, int axis, int parent) const;
+            // returns index of cluster, created for given cell of cluster grid
+            int get_cluster_index(const int cell[Math::VECTOR_SIZE]) const
+            {
+                return (cell[0]*clusters_by_axes[1] + cell[1])*clusters_by_axes[2] + cell[2];
+            }
+
             void init_tasks();
 
             // -- fields used in step computation --
 
+            // Computes a batch of clusters (given by ClusterScheduler), and sets an event of each cluster when it is computed
             class ClusterTask : public Parallel::AbstractTask
             {
             private:
                 const Model *model;
-                Cluster *cluster;
+                Collections::Array<Cluster> *clusters;
+                ClusterScheduler *scheduler;
                 Math::Real *dt;
                 Parallel::IEventSet * event_set;
-                int event_index;
+                // indices of clusters in the batch
+                const int *cluster_indices;
+                int clusters_num;
             protected:
                 // implement AbstractTask
                 virtual void execute();
             public:
                 ClusterTask();
-                void setup(const Model & model, Cluster & cluster, Math::Real & dt, Parallel::IEventSet * event_set, int event_index);
+                void setup(const Model & model, Collections::Array<Cluster> & clusters, ClusterScheduler & scheduler, Math::Real & dt, Parallel::IEventSet * event_set);
+                void set_batch(const int * cluster_indices, int clusters_num);
             } *cluster_tasks;
+            // number of cluster tasks used in current step
+            int cluster_tasks_num;
+            ClusterScheduler * cluster_scheduler;
+
+            // groups clusters into cluster tasks (by costs measured at previous step)
+            void schedule_cluster_tasks();
 
-            class FinalTask : public Parallel::AbstractTask
+            // Integration of particle system (after cluster tasks are completed) is done in stages.
+            // In each stage parts of vertices are processed in parallel by IntegrationTasks, and between
+            // stages partial sums of parts are combined by IntegrationBarrierTasks (see Model::prepare_integration_stage)
+            enum IntegrationStage
+            {
+                // find center of mass
+                CENTER_OF_MASS_STAGE,
+                // find inertia tensor and velocity additions
+                VELOCITY_ADDITIONS_STAGE,
+                // compensate velocity additions and integrate velocities
+                VELOCITIES_STAGE,
+                // find linear and angular momenta
+                MOMENTA_STAGE,
+                // damp deformation oscillations, subtract macroscopic motion and integrate positions
+                POSITIONS_STAGE,
+
+                INTEGRATION_STAGES_NUM
+            };
+
+            class IntegrationTask : public Parallel::AbstractTask
             {
             private:
                 Model *model;
+                int stage;
+                int part;
             protected:
                 // implement AbstractTask
                 virtual void execute();
             public:
-                FinalTask(Model *model) : model(model) {}
-            } final_task;
+                IntegrationTask();
+                void setup(Model *model, int stage, int part);
+            } *integration_tasks; // all tasks of first stage, then of second one, etc.
 
+            class IntegrationBarrierTask : public Parallel::AbstractTask
+            {
+            private:
+                Model *model;
+                int stage;
+            protected:
+                // implement AbstractTask
+                virtual void execute();
+            public:
+                IntegrationBarrierTask();
+                void setup(Model *model, int stage);
+            } integration_barrier_tasks[INTEGRATION_STAGES_NUM + 1]; // a barrier before each stage and after the last one
+
+            // number of parts of vertices for integration (a part is processed in one task)
+            int integration_parts_num;
+            // partial sums of parts, combined by barrier tasks
+            Math::Vector * center_of_mass_sums;
+            Math::Matrix * inertia_tensor_sums;
+            Math::Vector * linear_velocity_sums;
+            Math::Vector * angular_momentum_sums;
+
+            // Update tasks claim chunks of vertices until none is left (so that work is balanced between
+            // workers, whatever their number is): all tasks share the same ChunkedRange
             class UpdateTask : public Parallel::AbstractTask
             {
             protected:
                 Model *model;
                 void *out_vertices;
                 const VertexInfo * vertex_info;
-                int start_vertex;
-                int vertices_num;
+                Parallel::ChunkedRange * chunks;
 
                 Parallel::IEventSet * event_set;
 
@@ -145,12 +277,31 @@ namespace CrashAndSqueeze
             public:
                 UpdateTask();
                 void setup_event(Parallel::IEventSet * event_set, int event_index);
-                void setup_args(Model *model, /*out*/ void *out_vertices, const VertexInfo &vertex_info, int start_vertex, int vertices_num);
+                void setup_args(Model *model, /*out*/ void *out_vertices, const VertexInfo &vertex_info, Parallel::ChunkedRange & chunks);
             } *update_tasks;
             int update_tasks_num;
+            // chunks of vertices claimed by UpdateTasks and UpdateVectorsTasks
+            Parallel::ChunkedRange update_pos_chunks;
+            Parallel::ChunkedRange update_vec_chunks;
+
+            // If reactions are parallel, the last integration barrier computes positions of watched vertices and
+            // pushes ReactionTasks, which claim chunks of reactions and push results of fired ones to
+            // reaction_results; ReactionsBarrierTask completes the step after all of them
+            class ReactionTask : public Parallel::AbstractTask
+            {
+            private:
+                Model *model;
+            protected:
+                // implement AbstractTask
+                virtual void execute();
+            public:
+                ReactionTask() : model(NULL) {}
+                void setup(Model *model) { this->model = model; }
+            } *reaction_tasks;
+            int reaction_tasks_num;
+            Parallel::ChunkedRange reaction_chunks;
 
- #if CAS_QUADRATIC_EXTENSIONS_ENABLED
-            class GenerateNormalsTask : public Parallel::AbstractTask
+            class ReactionsBarrierTask : public Parallel::AbstractTask
             {
             private:
                 Model *model;
@@ -158,17 +309,51 @@ namespace CrashAndSqueeze
                 // implement AbstractTask
                 virtual void execute();
             public:
-                GenerateNormalsTask(Model *model) : model(model) {}
-            } gen_normals_task;
+                ReactionsBarrierTask() : model(NULL) {}
+                void setup(Model *model) { this->model = model; }
+            } reactions_barrier_task;
+            Parallel::AbstractTask * reaction_tasks_successors[1];
+
+            // fired reactions, pushed by ReactionTasks and popped by Model::react_to_events
+            Parallel::LockFreeResultQueue<ReactionResult> * reaction_results;
+            // in deterministic mode ReactionTasks write results here (one item per reaction, with NULL
+            // reaction if not fired), and ReactionsBarrierTask pushes them in the order of reactions
+            Collections::Array<ReactionResult> ordered_reaction_results;
+
+ #if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            // Does nothing: only pushes UpdateVectorsTasks when all UpdateTasks are completed
+            // (normals are generated from updated positions of neighbour vertices)
+            class NormalsBarrierTask : public Parallel::AbstractTask
+            {
+            protected:
+                // implement AbstractTask
+                virtual void execute() {}
+            } normals_barrier_task;
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
 
             class UpdateVectorsTask : public UpdateTask
             {
             private:
+                // if true, normals of claimed vertices are generated before updating vectors
+                bool normals_needed;
             protected:
                 // implement AbstractTask
                 virtual void execute();
+            public:
+                UpdateVectorsTask() : normals_needed(false) {}
+                void set_normals_needed(bool value) { normals_needed = value; }
             } * update_vectors_tasks;
+
+            // Successors of tasks in task graphs (see Parallel::AbstractTask::set_successors), so that no task waits for another one:
+            // cluster tasks are followed by the first barrier, each barrier is followed by integration tasks of the next stage,
+            // and they are followed by the next barrier...
+            Parallel::AbstractTask * integration_barriers_successors[INTEGRATION_STAGES_NUM + 1];
+            Parallel::AbstractTask ** integration_tasks_successors;
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            // ...and if normals are generated, update tasks are followed by NormalsBarrierTask, which is followed by all UpdateVectorsTasks
+            Parallel::AbstractTask * update_tasks_successors[1];
+            Parallel::AbstractTask ** normals_barrier_task_successors;
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
             
             Parallel::IPrimFactory * prim_factory;
             Parallel::IEventSet * cluster_tasks_completed;
@@ -177,7 +362,7 @@ namespace CrashAndSqueeze
             Parallel::IEventSet * update_vec_tasks_completed;
             Parallel::IEvent * normals_generated;
 
-            Parallel::TaskQueue * task_queue;
+            Parallel::ITaskQueue * task_queue;
 
             volatile bool success;
 
@@ -194,9 +379,37 @@ namespace CrashAndSqueeze
 
             // used by Model::hit: here placed are indices of the found vertices (which are inside the given region)
             IndexArray hit_vertices_indices;
+            // grid of physical vertices, so that Model::hit checks only vertices near bounded regions:
+            // it is rebuilt by the first hit after vertices have moved
+            VertexGrid hit_grid;
+            bool hit_grid_outdated;
+            IndexArray hit_candidates;
+
+            // clusters woken up since the previous step (their neighbours are woken up at the beginning of the next step)
+            IndexArray woken_clusters;
+            int sleeping_clusters_num;
 
             // -- step computation steps --
-            void integrate_particle_system();
+
+            // wakes up sleeping clusters including given physical vertex
+            void wake_clusters_of_vertex(int vertex_index);
+            // Wakes up disturbed clusters (and their neighbours) and puts idle ones to sleep:
+            // called before scheduling cluster tasks, when forces of the step are known
+            void update_sleeping_clusters();
+            void get_integration_part(int part, /*out*/ int & start_vertex, /*out*/ int & vertices_num) const;
+            // computes positions of watched vertices and pushes reaction tasks (called by the last integration barrier)
+            void start_reaction_tasks();
+            // recreates reaction_results with given size, keeping results not invoked yet (called between steps)
+            void resize_reaction_results(int max_size);
+            // checks given reactions and pushes results of fired ones to reaction_results
+            void check_reactions(int first_reaction, int reactions_num);
+            // pushes fired ones of ordered_reaction_results to reaction_results (in deterministic mode)
+            void push_ordered_reaction_results();
+            // processes given part of vertices in given stage of integration
+            void integrate_part(int stage, int part);
+            // combines partial sums of the previous stage and prepares given stage
+            // (if `stage` is INTEGRATION_STAGES_NUM, then finishes integration and marks the step completed)
+            void prepare_integration_stage(int stage);
 
             bool correct_velocity_additions();
 
@@ -205,6 +418,17 @@ namespace CrashAndSqueeze
 
             // Handles ALL_VERTICES and updates start_vertex and vertex_num if needed. Also checks all values to be correct.
             bool process_update_vertices_args(const VertexInfo &vertex_info, /*in/out*/ int & start_vertex, /*in/out*/ int & vertices_num) const;
+            // Appends to `ranges` contiguous ranges of vertices, which have any of `changes` flags set in vertex_changes
+            void get_changed_ranges(unsigned char changes, /*out*/ VertexRangesArray & ranges) const;
+            // Updates positions of given (already checked) vertices using transformations packed in `skinning`
+            void skin_vertices(/*out*/ void *out_vertices, const VertexInfo &vertex_info, int start_vertex, int vertices_num);
+            // Updates vectors of given (already checked) vertices
+            void update_vectors_part(/*out*/ void *out_vertices, const VertexInfo &vertex_info, int start_vertex, int vertices_num);
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            // Generates normals of given vertices from current positions of all vertices (gathering normals of adjacent
+            // triangles, so that different parts can be generated in parallel)
+            void generate_normals_part(int start_vertex, int vertices_num);
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
 
         public:
             // Takes a pointer source_vertices to vetrices_num vertices of arbitrary
@@ -212,7 +436,10 @@ namespace CrashAndSqueeze
             // values of mass. If masses are equal for all vertices, it can be null
             // and the mass should be given as constant_mass argument.
             // The model must have rigid frame, defined by frame_indices array of indices
-            // of frame vertices.
+            // of frame vertices. The model is split into clusters_by_axes clusters
+            // in a way given by clustering_mode. Updating vertices and checking reactions are split
+            // into as many tasks as prim_factory has workers (see IPrimFactory::get_workers_num),
+            // or into a default number of tasks if the factory doesn't report it.
             // TODO: the fact that cluster_padding_coeff defines only half of overlapping area is not obvious.
             Model(void *source_physical_vertices,
                   int physical_vetrices_num,
@@ -228,16 +455,20 @@ namespace CrashAndSqueeze
                   const MassFloat constant_mass = 1,
                   const MassFloat *masses = 0,
 
-                  Parallel::IPrimFactory * prim_factory = &Parallel::SingleThreadFactory::instance);
+                  Parallel::IPrimFactory * prim_factory = &Parallel::SingleThreadFactory::instance,
+
+                  ClusteringMode clustering_mode = UNIFORM_CLUSTERING);
 
             // -- Initial configuration --
             
             void set_frame(const IndexArray &frame_indices);
 
             // Adds surface to model. Needed only for generating normals from scratch
-            // (for quad.deformation only - otherwise normals simply updated linearly from original values)
-            void set_graphical_surface(ISurface * surface) { this->graphical_surface = surface; }
-            ISurface * get_graphical_surface() { return graphical_surface; }
+            // (for quad.deformation only - otherwise normals simply updated linearly from original values).
+            // Triangles of the surface are read here once: call it again if they are changed.
+            // Without CAS_QUADRATIC_EXTENSIONS_ENABLED the surface is ignored.
+            void set_graphical_surface(ISurface * surface);
+            ISurface * get_graphical_surface();
 
             // -- Reactions --
             
@@ -315,9 +546,32 @@ namespace CrashAndSqueeze
             // checked internally to short-curcuit execution after error
             bool is_aborted() const { return ! success; }
 
-            // detect happened events and invoke reactions, if needed
+            // Detect happened events and invoke reactions, if needed. If reactions are parallel,
+            // only invokes reactions found to be fired by tasks of the previous steps (and checks reactions
+            // which can't be checked by tasks, see ModelReaction::is_checked_with_watched)
             void react_to_events();
 
+            // If set to true, reactions are checked by tasks of the step after integration (in parallel, on threads
+            // completing tasks), and Model::react_to_events only invokes fired ones (in the calling thread).
+            // Otherwise (by default) reactions are both checked and invoked by Model::react_to_events.
+            // Set it between steps, not while the step is computed
+            void set_parallel_reactions(bool value) { parallel_reactions = value; }
+            bool has_parallel_reactions() const { return parallel_reactions; }
+
+            // If set to true, results of steps are bitwise identical for the same inputs, whatever
+            // the number of workers, the order of completing tasks and the CPU are:
+            // * vertices are already split into parts of fixed size for integration, and partial sums
+            //   of parts are combined in a fixed order (see Body), independently of this mode;
+            // * shape matching uses scalar kernels instead of the best SIMD ones supported by CPU
+            //   (SIMD kernels sum several vertices at a time, in an order depending on their width);
+            // * CPU skinning doesn't use SIMD;
+            // * fired parallel reactions are invoked in the order they were added, not in the order they were checked.
+            // The same build (floating point precision and compiler options, without
+            // contraction of operations into FMA) must be used on all machines.
+            // Set it between steps, not while the step is computed
+            void set_deterministic(bool value);
+            bool is_deterministic() const { return deterministic; }
+
             // getters of cluster parameters for computation on GPU:
 
             // get cluster transformation matrix (current deformation * plasticity state)
@@ -334,7 +588,8 @@ namespace CrashAndSqueeze
 
             static const int ALL_VERTICES = -1;
 
-            // Non-blocking updating of vertices. Prepares tasks for updating requested vertices in parts.
+            // Non-blocking updating of vertices. Prepares tasks for updating requested vertices in parts
+            // (one task per hardware thread, each of them claims chunks of vertices until none is left).
             //
             // This method returns immediately: actual computation will be done by calling Model::complete_next_task
             // (probably in another thread) until all tasks are completed. Calling this method is equivalent to calling:
@@ -366,6 +621,19 @@ namespace CrashAndSqueeze
             // Returns true if computation was successful, false otherwise
             bool wait_for_update();
 
+            // Blocking incremental updating: like Model::update_vertices (followed by Model::generate_normals and
+            // Model::update_vertices_vectors, if `update_vectors` is true), but only vertices of clusters, which transformation
+            // has changed by more than update epsilon since vertices were written last time, are updated.
+            // Vertices are considered written after updating all of them (by Model::update_vertices or
+            // Model::update_vertices_async), so the first update of `out_vertices` must be a complete one.
+            // Ranges of updated vertices are appended to `updated_ranges` (e.g. to upload only them to GPU).
+            // Returns the number of updated vertices.
+            int update_changed_vertices(/*out*/ void *out_vertices, const VertexInfo &vertex_info, bool update_vectors, /*out*/ VertexRangesArray & updated_ranges);
+
+            // Sets how much an element of cluster transformation must change (since vertices were written) to update vertices of the cluster
+            void set_update_epsilon(Math::Real epsilon) { skinning.set_change_epsilon(epsilon); }
+            Math::Real get_update_epsilon() const { return skinning.get_change_epsilon(); }
+
             // These methods are needed only for test demo
             void update_current_positions(/*out*/ void *out_vertices, int vertices_num, const VertexInfo &vertex_info);
             void update_equilibrium_positions(/*out*/ void *out_vertices, int vertices_num, const VertexInfo &vertex_info);
@@ -375,6 +643,8 @@ namespace CrashAndSqueeze
             
             virtual int get_vertices_num() const { return vertices.size(); }
             int get_clusters_num() const { return clusters.size(); }
+            // returns number of clusters, which were sleeping (not computed) at the last step (see SimulationParams::sleep_steps)
+            int get_sleeping_clusters_num() const { return sleeping_clusters_num; }
             
             const PhysicalVertex & get_vertex(int index) const { return vertices[index]; }
             const Cluster & get_cluster(int index) const { return clusters[index]; }
@@ -386,6 +656,8 @@ namespace CrashAndSqueeze
             // returns equilibrium position, moved so that to match immovable initial positions
             virtual Math::Vector get_vertex_equilibrium_pos(int index) const;
             virtual Math::Vector get_vertex_initial_pos(int index) const;
+            // transforms positions of all vertices with the same frame in one pass
+            virtual void get_vertices_equilibrium_pos(const IndexArray & indices, /*out*/ Math::Vector * positions) const;
             
             Math::Vector get_vertex_current_pos(int index) const { return vertices[index].get_pos(); }
 
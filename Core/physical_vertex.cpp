@@ -8,42 +8,25 @@ namespace CrashAndSqueeze
 
     namespace Core
     {
-        // gets an addition from a single cluster, divides it by including_clusters_num,
-        // and adds corrected value to velocity_addition, thus averaging addiitons
+        // gets an addition from a single cluster, to be averaged with additions
+        // from other clusters in PhysicalVertex::compute_velocity_addition
         bool PhysicalVertex::add_to_average_velocity_addition(const Vector & addition, int addition_index)
         {
-            // additions from different clusters are placed in different array items,
-            // and get averaged in PhysicalVertex::integrate_velocity
-            velocity_additions[addition_index] = addition;
+            // additions from different clusters are placed in different places
+            store->allocate_cluster_slots();
+            store->set_cluster_velocity_addition(index, addition_index, addition);
             return true;
         }
 
-        bool PhysicalVertex::change_equilibrium_pos(const Vector &delta)
+        void PhysicalVertex::set_equilibrium_pos(const Vector &equilibrium_pos, int addition_index)
         {
-            if( false == check_in_cluster() )
-                return false;
-
-            equilibrium_pos += delta/get_including_clusters_num();
-            return true;
-        }
-
-        bool PhysicalVertex::compute_velocity_addition()
-        {
-            if( false == check_in_cluster() )
-                return false;
-            
-            // compute average velocity addition
-            velocity_addition = Vector::ZERO;
-            for(int i = 0; i < get_including_clusters_num(); ++i)
-            {
-                velocity_addition += velocity_additions[i];
-            }
-            velocity_addition /= get_including_clusters_num();
-            return true;
+            store->allocate_cluster_slots();
+            store->set_cluster_equilibrium_pos(index, addition_index, equilibrium_pos);
         }
 
         void PhysicalVertex::apply_displacements(const DisplacementsArray & displacements)
         {
+            Vector & pos = store->get_positions()[index];
             for (int j = 0; j < displacements.size(); ++j)
             {
                 const IDisplacement * displacement = displacements[j];
@@ -54,37 +37,10 @@ namespace CrashAndSqueeze
             }
         }
 
-        bool PhysicalVertex::integrate_velocity(const ForcesArray & forces, Real dt)
-        {
-            Vector acceleration = Vector::ZERO;
-
-            if(0 != mass)
-            {
-                for(int i = 0; i < forces.size(); ++i)
-                {
-                    if(NULL == forces[i])
-                    {
-                        Logger::error("in PhysicalVertex::integrate_velocity: null pointer item of `forces' array ", __FILE__, __LINE__);
-                        return false;
-                    }
-                    acceleration += forces[i]->get_value_at(pos, velocity)/mass;
-                }
-            }
-
-
-            velocity += velocity_addition + acceleration*dt;
-            return true;
-        }
-
-        void PhysicalVertex::integrate_position(Math::Real dt)
-        {
-            pos += velocity*dt;
-        }
-
         Vector PhysicalVertex::angular_velocity_to_linear(const Math::Vector &body_angular_velocity,
                                                           const Math::Vector &body_center) const
         {
-            return cross_product(body_angular_velocity, pos - body_center);
+            return cross_product(body_angular_velocity, get_pos() - body_center);
         }
 
         void PhysicalVertex::include_to_one_more_cluster(int cluster_index, Real weight)
@@ -92,12 +48,12 @@ namespace CrashAndSqueeze
             ignore_unreferenced(cluster_index);
             // TODO: do not ignore weight (requires change in velocity addition summation)
             ignore_unreferenced(weight);
-            ++including_clusters_num;
+            store->include_to_one_more_cluster(index);
         }
 
         bool PhysicalVertex::check_in_cluster()
         {
-            if(0 == including_clusters_num)
+            if(0 == get_including_clusters_num())
             {
                 Logger::error("internal error: PhysicalVertex doesn't belong to any cluster", __FILE__, __LINE__);
                 return false;
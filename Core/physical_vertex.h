@@ -2,6 +2,7 @@
 #include "Core/core.h"
 #include "Core/force.h"
 #include "Core/ivertex.h"
+#include "Core/physical_vertex_store.h"
 #include "Math/vector.h"
 #include "Collections/array.h"
 
@@ -9,81 +10,77 @@ namespace CrashAndSqueeze
 {
     namespace Core
     {
+        // A reference to a vertex stored in PhysicalVertexStore
         class PhysicalVertex : public IVertex
         {
         private:
-            // position of vertex in global coordinate system
-            Math::Vector pos;
-            Math::Real mass;
-            Math::Vector velocity;
-            
-            static const int MAX_CLUSTERS_NUM = 8;
-            Math::Vector velocity_additions[MAX_CLUSTERS_NUM];
-            // computed with PhysicalVertex::compute_velocity_addition
-            Math::Vector velocity_addition;
-            Math::Vector equilibrium_pos;
-            
-            int next_addition_index;
+            PhysicalVertexStore * store;
+            int index;
 
-            // Number of clusters which include current vertex
-            int including_clusters_num;
         public:
-            PhysicalVertex( Math::Vector pos = Math::Vector::ZERO,
+            PhysicalVertex() : store(NULL), index(0) {}
+            // refers to an existing vertex of the store
+            PhysicalVertex(PhysicalVertexStore & store, int index) : store(&store), index(index) {}
+            // adds a new vertex to the store and refers to it
+            PhysicalVertex( PhysicalVertexStore & store,
+                            const Math::Vector & pos,
                             Math::Real mass = 0,
-                            Math::Vector velocity = Math::Vector(0,0,0) )
-                : pos(pos), mass(mass), velocity(velocity),
-                  equilibrium_pos(pos), including_clusters_num(0), next_addition_index(0) {}
+                            const Math::Vector & velocity = Math::Vector(0,0,0) )
+                : store(&store), index(store.add_vertex(pos, mass, velocity)) {}
+
+            PhysicalVertexStore & get_store() const { return *store; }
+            int get_index() const { return index; }
 
             // -- properties --
             
             // position getter
-            const Math::Vector & get_pos() const { return pos; }
+            const Math::Vector & get_pos() const { return store->get_positions()[index]; }
             // velocity accessors
-            const Math::Vector & get_velocity() const { return velocity; }
+            const Math::Vector & get_velocity() const { return store->get_velocities()[index]; }
             Math::Vector angular_velocity_to_linear(const Math::Vector &body_angular_velocity,
                                                     const Math::Vector &body_center) const;
             // mass getter
-            Math::Real get_mass() const { return mass; }
+            Math::Real get_mass() const { return store->get_masses()[index]; }
             
             // -- accessors to velocity_addition --
 
-            // gets an addition from a single cluster, divides it by including_clusters_num,
-            // and adds corrected value to velocity_addition, thus averaging additions.
-            // addition_index is index in velocity_additions array: each cluster writes into its own
+            // gets an addition from a single cluster to be averaged with additions from other clusters.
+            // addition_index is index of a place in the store: each cluster writes into its own
             // place to avoid race condition
             bool add_to_average_velocity_addition(const Math::Vector &addition, int addition_index);
 
-            // averages velocity_additions into velocity_addition
-            bool compute_velocity_addition();
+            // averages velocity additions from clusters into velocity_addition
+            bool compute_velocity_addition() { return store->compute_velocity_additions(index, 1); }
 
             // Before calling this velocity_addition must computed with
             // PhysicalVertex::compute_velocity_addition
-            const Math::Vector & get_velocity_addition() const { return velocity_addition; }
+            const Math::Vector & get_velocity_addition() const { return store->get_velocity_additions()[index]; }
 
-            int get_next_addition_index() { return next_addition_index++; }
+            int get_next_addition_index() { return store->get_next_addition_index(index); }
 
-            // adds to equilibrium_pos `delta', divided by including_clusters_num
-            bool change_equilibrium_pos(const Math::Vector &delta);
-            const Math::Vector & get_equilibrium_pos() const { return equilibrium_pos; }
+            // sets equilibrium position from a single cluster (with given addition index)
+            void set_equilibrium_pos(const Math::Vector &equilibrium_pos, int addition_index);
+            // returns equilibrium position averaged over including clusters
+            Math::Vector get_equilibrium_pos() const { return store->get_equilibrium_pos(index); }
 
-            void add_to_velocity(const Math::Vector &correction) { velocity += correction; }
-            void set_velocity(const Math::Vector &new_velocity) { velocity = new_velocity; }
+            void add_to_velocity(const Math::Vector &correction) { store->get_velocities()[index] += correction; }
+            void set_velocity(const Math::Vector &new_velocity) { store->get_velocities()[index] = new_velocity; }
 
             // -- methods --
 
             void apply_displacements(const DisplacementsArray & displacements);
             // step integration
-            bool integrate_velocity(const ForcesArray & forces, Math::Real dt);
-            void integrate_position(Math::Real dt);
+            bool integrate_velocity(const ForcesArray & forces, Math::Real dt) { return store->integrate_velocities(forces, dt, index, 1); }
+            void integrate_position(Math::Real dt) { store->integrate_positions(dt, index, 1); }
 
             // -- implement IVertex --
             
             // Adds vertex to another cluster with given weight. Weight is ignored currently
             virtual void include_to_one_more_cluster(int cluster_index, Math::Real weight) /* override */;
             // Returns total number of clusters this vertex belongs to
-            virtual int get_including_clusters_num() const /* override */ { return including_clusters_num; }
+            virtual int get_including_clusters_num() const /* override */ { return store->get_including_clusters_nums()[index]; }
             // Returns 0 because PhysicalVertex doesn't store these indices (PhysicalVertex)
-            virtual ClusterIndex get_including_cluster_index(int) const /* override */ { return 0; };
+            virtual int get_including_cluster_index(int) const /* override */ { return 0; };
             // An assertion that checks if the vertex belongs to _any_ cluster
             virtual bool check_in_cluster() /* override */;
         };
@@ -0,0 +1,210 @@
+#include "Core/physical_vertex_store.h"
+
+namespace CrashAndSqueeze
+{
+    using Logging::Logger;
+    using Math::Real;
+    using Math::Vector;
+    using Math::maximum;
+    using Math::minimum;
+
+    namespace Core
+    {
+        PhysicalVertexStore::PhysicalVertexStore(int max_size)
+            : max_size(max_size), size(0)
+        {
+            positions = new Vector[max_size];
+            velocities = new Vector[max_size];
+            masses = new Real[max_size];
+            velocity_additions = new Vector[max_size];
+            accelerations = new Vector[max_size];
+            including_clusters_nums = new int[max_size];
+            next_addition_indices = new int[max_size];
+
+            cluster_slots_offsets = new int[max_size + 1];
+            cluster_slots_offsets[0] = 0;
+            cluster_slots_vertices_num = 0;
+            cluster_slots_dirty = false;
+            cluster_velocity_additions = NULL;
+            cluster_equilibrium_positions = NULL;
+        }
+
+        int PhysicalVertexStore::add_vertex(const Vector & pos, Real mass, const Vector & velocity)
+        {
+            if(size == max_size)
+            {
+                Logger::error("in PhysicalVertexStore::add_vertex: the store is full", __FILE__, __LINE__);
+                return size - 1;
+            }
+
+            int index = size++;
+            positions[index] = pos;
+            velocities[index] = velocity;
+            masses[index] = mass;
+            velocity_additions[index] = Vector::ZERO;
+            including_clusters_nums[index] = 0;
+            next_addition_indices[index] = 0;
+            cluster_slots_dirty = true;
+            return index;
+        }
+
+        int PhysicalVertexStore::get_needed_slots_num(int index) const
+        {
+            // at least one slot: it holds equilibrium position of a vertex without clusters
+            return maximum(1, maximum(including_clusters_nums[index], next_addition_indices[index]));
+        }
+
+        void PhysicalVertexStore::allocate_cluster_slots()
+        {
+            if(false == cluster_slots_dirty)
+                return;
+            cluster_slots_dirty = false;
+
+            bool slots_fit = (cluster_slots_vertices_num == size);
+            for(int i = 0; slots_fit && i < size; ++i)
+            {
+                if(get_needed_slots_num(i) > get_slots_num(i))
+                    slots_fit = false;
+            }
+            if(slots_fit)
+                return;
+
+            int * new_offsets = new int[max_size + 1];
+            new_offsets[0] = 0;
+            for(int i = 0; i < size; ++i)
+            {
+                new_offsets[i + 1] = new_offsets[i] + get_needed_slots_num(i);
+            }
+
+            Vector * new_velocity_additions = new Vector[new_offsets[size]];
+            Vector * new_equilibrium_positions = new Vector[new_offsets[size]];
+            for(int i = 0; i < size; ++i)
+            {
+                // keep the values already written to old slots
+                int old_slots_num = (i < cluster_slots_vertices_num) ? get_slots_num(i) : 0;
+                int new_slots_num = new_offsets[i + 1] - new_offsets[i];
+                for(int j = 0; j < new_slots_num; ++j)
+                {
+                    if(j < old_slots_num)
+                    {
+                        new_velocity_additions[new_offsets[i] + j] = cluster_velocity_additions[get_slot(i, j)];
+                        new_equilibrium_positions[new_offsets[i] + j] = cluster_equilibrium_positions[get_slot(i, j)];
+                    }
+                    else
+                    {
+                        new_velocity_additions[new_offsets[i] + j] = Vector::ZERO;
+                        new_equilibrium_positions[new_offsets[i] + j] = positions[i];
+                    }
+                }
+            }
+
+            delete[] cluster_slots_offsets;
+            delete[] cluster_velocity_additions;
+            delete[] cluster_equilibrium_positions;
+            cluster_slots_offsets = new_offsets;
+            cluster_velocity_additions = new_velocity_additions;
+            cluster_equilibrium_positions = new_equilibrium_positions;
+            cluster_slots_vertices_num = size;
+        }
+
+        Vector PhysicalVertexStore::get_equilibrium_pos(int index) const
+        {
+            if(index >= cluster_slots_vertices_num)
+                return positions[index];
+
+            int clusters_num = minimum(including_clusters_nums[index], get_slots_num(index));
+            if(0 == clusters_num)
+                return cluster_equilibrium_positions[get_slot(index, 0)];
+
+            Vector sum = Vector::ZERO;
+            for(int i = 0; i < clusters_num; ++i)
+            {
+                sum += cluster_equilibrium_positions[get_slot(index, i)];
+            }
+            return sum/clusters_num;
+        }
+
+        bool PhysicalVertexStore::compute_velocity_additions(int start_vertex, int vertices_num)
+        {
+            for(int i = start_vertex; i < start_vertex + vertices_num; ++i)
+            {
+                int clusters_num = including_clusters_nums[i];
+                if(0 == clusters_num)
+                {
+                    Logger::error("internal error: PhysicalVertex doesn't belong to any cluster", __FILE__, __LINE__);
+                    return false;
+                }
+
+                // compute average velocity addition
+                const Vector * additions = &cluster_velocity_additions[get_slot(i, 0)];
+                Vector sum = Vector::ZERO;
+                for(int j = 0; j < clusters_num; ++j)
+                {
+                    sum += additions[j];
+                }
+                velocity_additions[i] = sum/clusters_num;
+            }
+            return true;
+        }
+
+        bool PhysicalVertexStore::integrate_velocities(const ForcesArray & forces, Real dt, int start_vertex, int vertices_num)
+        {
+            for(int j = 0; j < forces.size(); ++j)
+            {
+                if(NULL == forces[j])
+                {
+                    Logger::error("in PhysicalVertex::integrate_velocity: null pointer item of `forces' array ", __FILE__, __LINE__);
+                    return false;
+                }
+            }
+
+            // uniform forces don't depend on the vertex, so sum them up once
+            Vector uniform_force = Vector::ZERO;
+            for(int j = 0; j < forces.size(); ++j)
+            {
+                if(forces[j]->is_uniform())
+                    uniform_force += forces[j]->get_value_at(Vector::ZERO, Vector::ZERO);
+            }
+
+            for(int i = start_vertex; i < start_vertex + vertices_num; ++i)
+            {
+                accelerations[i] = (0 != masses[i]) ? uniform_force/masses[i] : Vector::ZERO;
+            }
+
+            // other forces are applied one by one, each one to the whole range
+            for(int j = 0; j < forces.size(); ++j)
+            {
+                if( ! forces[j]->is_uniform() )
+                    forces[j]->add_accelerations(positions, velocities, masses, start_vertex, vertices_num, accelerations);
+            }
+
+            for(int i = start_vertex; i < start_vertex + vertices_num; ++i)
+            {
+                velocities[i] += velocity_additions[i] + accelerations[i]*dt;
+            }
+            return true;
+        }
+
+        void PhysicalVertexStore::integrate_positions(Real dt, int start_vertex, int vertices_num)
+        {
+            for(int i = start_vertex; i < start_vertex + vertices_num; ++i)
+            {
+                positions[i] += velocities[i]*dt;
+            }
+        }
+
+        PhysicalVertexStore::~PhysicalVertexStore()
+        {
+            delete[] positions;
+            delete[] velocities;
+            delete[] masses;
+            delete[] velocity_additions;
+            delete[] accelerations;
+            delete[] including_clusters_nums;
+            delete[] next_addition_indices;
+            delete[] cluster_slots_offsets;
+            delete[] cluster_velocity_additions;
+            delete[] cluster_equilibrium_positions;
+        }
+    }
+}
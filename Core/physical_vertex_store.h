@@ -0,0 +1,108 @@
+#pragma once
+#include "Core/core.h"
+#include "Core/force.h"
+#include "Math/vector.h"
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+        // Storage of physical vertices as a structure of arrays: each property of all vertices
+        // (positions, velocities, masses, velocity additions...) is stored in a separate
+        // contiguous stream, so that a pass over vertices reads only the properties it needs.
+        // PhysicalVertex objects only refer to vertices of a store.
+        class PhysicalVertexStore
+        {
+        private:
+            int max_size;
+            int size;
+
+            // -- streams: one item per vertex --
+
+            // position of vertex in global coordinate system
+            Math::Vector * positions;
+            Math::Vector * velocities;
+            Math::Real * masses;
+            // averaged velocity additions, computed with compute_velocity_additions
+            Math::Vector * velocity_additions;
+            // accelerations caused by forces, accumulated force by force in integrate_velocities
+            Math::Vector * accelerations;
+            int * including_clusters_nums;
+            int * next_addition_indices;
+
+            // -- streams: one item (slot) per vertex per including cluster --
+            // (each cluster writes into its own place to avoid race condition)
+
+            // slots of i'th vertex are cluster_slots_offsets[i] .. cluster_slots_offsets[i+1] - 1
+            int * cluster_slots_offsets;
+            // number of vertices, for which slots are allocated
+            int cluster_slots_vertices_num;
+            // true if memberships have changed since the last allocate_cluster_slots
+            bool cluster_slots_dirty;
+
+            Math::Vector * cluster_velocity_additions;
+            Math::Vector * cluster_equilibrium_positions;
+
+            int get_slot(int index, int addition_index) const { return cluster_slots_offsets[index] + addition_index; }
+            int get_slots_num(int index) const { return cluster_slots_offsets[index + 1] - cluster_slots_offsets[index]; }
+            int get_needed_slots_num(int index) const;
+
+        public:
+            PhysicalVertexStore(int max_size);
+
+            // adds a new vertex to the store and returns its index
+            int add_vertex(const Math::Vector & pos, Math::Real mass, const Math::Vector & velocity);
+
+            int get_size() const { return size; }
+            int get_max_size() const { return max_size; }
+
+            // -- streams --
+
+            Math::Vector * get_positions() { return positions; }
+            const Math::Vector * get_positions() const { return positions; }
+            Math::Vector * get_velocities() { return velocities; }
+            const Math::Vector * get_velocities() const { return velocities; }
+            const Math::Real * get_masses() const { return masses; }
+            const Math::Vector * get_velocity_additions() const { return velocity_additions; }
+            const int * get_including_clusters_nums() const { return including_clusters_nums; }
+
+            // -- memberships in clusters --
+
+            void include_to_one_more_cluster(int index) { ++including_clusters_nums[index]; cluster_slots_dirty = true; }
+            // returns index of a place for velocity addition and equilibrium position from next cluster
+            int get_next_addition_index(int index) { cluster_slots_dirty = true; return next_addition_indices[index]++; }
+
+            // (Re)allocates slots for velocity additions and equilibrium positions after memberships
+            // have changed, keeping the values already written. Must be called before slots are accessed:
+            // after the last vertex is added to clusters. Does nothing if memberships haven't changed.
+            void allocate_cluster_slots();
+
+            void set_cluster_velocity_addition(int index, int addition_index, const Math::Vector & addition)
+            {
+                cluster_velocity_additions[get_slot(index, addition_index)] = addition;
+            }
+            void set_cluster_equilibrium_pos(int index, int addition_index, const Math::Vector & equilibrium_pos)
+            {
+                cluster_equilibrium_positions[get_slot(index, addition_index)] = equilibrium_pos;
+            }
+            // averages equilibrium positions from all including clusters
+            Math::Vector get_equilibrium_pos(int index) const;
+
+            // -- passes over vertices from `start_vertex` to `start_vertex + vertices_num - 1` --
+
+            // averages velocity additions from all including clusters into velocity_additions
+            bool compute_velocity_additions(int start_vertex, int vertices_num);
+            // sums velocity additions and applies forces: uniform forces are summed up once,
+            // others are applied force by force only to vertices inside their bounding boxes
+            bool integrate_velocities(const ForcesArray & forces, Math::Real dt, int start_vertex, int vertices_num);
+            void integrate_positions(Math::Real dt, int start_vertex, int vertices_num);
+
+            virtual ~PhysicalVertexStore();
+
+        private:
+            // No copying!
+            PhysicalVertexStore(const PhysicalVertexStore &);
+            PhysicalVertexStore & operator=(const PhysicalVertexStore &);
+        };
+    }
+}
@@ -7,6 +7,65 @@ namespace CrashAndSqueeze
 
     namespace Core
     {
+        // -- WatchedVertices --
+
+        void WatchedVertices::reset(int vertices_num)
+        {
+            if(slots.size() != vertices_num)
+            {
+                slots.clear();
+                slots.create_items(vertices_num);
+                for(int i = 0; i < vertices_num; ++i)
+                {
+                    slots[i] = NO_SLOT;
+                }
+            }
+            else
+            {
+                // only watched vertices have slots
+                for(int i = 0; i < indices.size(); ++i)
+                {
+                    slots[indices[i]] = NO_SLOT;
+                }
+            }
+            indices.clear();
+        }
+
+        int WatchedVertices::watch(int vertex_index)
+        {
+            if(vertex_index < 0 || vertex_index >= slots.size())
+            {
+                Logger::error("in WatchedVertices::watch: vertex index out of range", __FILE__, __LINE__);
+                return NO_SLOT;
+            }
+
+            if(NO_SLOT == slots[vertex_index])
+            {
+                slots[vertex_index] = indices.size();
+                indices.push_back(vertex_index);
+            }
+            return slots[vertex_index];
+        }
+
+        void WatchedVertices::compute_positions(const IModel & model)
+        {
+            int watched_num = indices.size();
+            equilibrium_positions.clear();
+            initial_positions.clear();
+            if(0 == watched_num)
+                return;
+
+            equilibrium_positions.create_items(watched_num);
+            initial_positions.create_items(watched_num);
+
+            model.get_vertices_equilibrium_pos(indices, &equilibrium_positions[0]);
+            for(int i = 0; i < watched_num; ++i)
+            {
+                initial_positions[i] = model.get_vertex_initial_pos(indices[i]);
+            }
+        }
+
+        // -- ShapeDeformationReaction --
 
         ShapeDeformationReaction::ShapeDeformationReaction(const IndexArray &shape_vertex_indices, Math::Real threshold_distance)
             : shape_vertex_indices(shape_vertex_indices), threshold_distance(threshold_distance)
@@ -21,9 +80,16 @@ namespace CrashAndSqueeze
         }
 
         void ShapeDeformationReaction::invoke_if_needed(const IModel &model)
+        {
+            ReactionResult result;
+            if( is_invoke_needed(model, result) )
+                invoke_with(model, result);
+        }
+
+        bool ShapeDeformationReaction::is_invoke_needed(const IModel &model, ReactionResult & result)
         {
             if( ! is_enabled() )
-                return;
+                return false;
 
             Real max_distance = 0;
             int max_distance_vertex_index = 0;
@@ -42,11 +108,66 @@ namespace CrashAndSqueeze
 
             if( max_distance > threshold_distance )
             {
-                invoke(max_distance_vertex_index, max_distance);
-                return;
+                result.reaction = this;
+                result.vertex_index = max_distance_vertex_index;
+                result.distance = max_distance;
+                return true;
+            }
+            return false;
+        }
+
+        void ShapeDeformationReaction::watch_vertices(WatchedVertices & watched)
+        {
+            watched_slots.clear();
+            for(int i = 0; i < shape_vertex_indices.size(); ++i)
+            {
+                watched_slots.push_back( watched.watch(shape_vertex_indices[i]) );
             }
         }
 
+        bool ShapeDeformationReaction::is_invoke_needed(const IModel &model, const WatchedVertices & watched, ReactionResult & result)
+        {
+            if( ! is_enabled() )
+                return false;
+
+            // the shape is changed since watch_vertices: slots are not valid
+            if( watched_slots.size() != shape_vertex_indices.size() )
+                return is_invoke_needed(model, result);
+
+            Real max_distance = 0;
+            int max_distance_vertex_index = 0;
+            for(int i = 0; i < watched_slots.size(); ++i)
+            {
+                int slot = watched_slots[i];
+                if(WatchedVertices::NO_SLOT == slot)
+                    continue;
+
+                Real distance = Math::distance( watched.get_equilibrium_pos(slot), watched.get_initial_pos(slot) );
+
+                if(distance > max_distance)
+                {
+                    max_distance = distance;
+                    max_distance_vertex_index = watched.get_vertex_index(slot);
+                }
+            }
+
+            if( max_distance > threshold_distance )
+            {
+                result.reaction = this;
+                result.vertex_index = max_distance_vertex_index;
+                result.distance = max_distance;
+                return true;
+            }
+            return false;
+        }
+
+        void ShapeDeformationReaction::invoke_with(const IModel & /*model*/, const ReactionResult & result)
+        {
+            invoke(result.vertex_index, result.distance);
+        }
+
+        // -- RegionReaction --
+
         RegionReaction::RegionReaction(const IndexArray & shape_vertex_indices, const IRegion & region, bool reaction_on_entering)
             : shape_vertex_indices(shape_vertex_indices), region(region), reaction_on_entering(reaction_on_entering)
         {
@@ -60,9 +181,16 @@ namespace CrashAndSqueeze
         }
 
         void RegionReaction::invoke_if_needed(const IModel &model)
+        {
+            ReactionResult result;
+            if( is_invoke_needed(model, result) )
+                invoke_with(model, result);
+        }
+
+        bool RegionReaction::is_invoke_needed(const IModel &model, ReactionResult & result)
         {
             if( ! is_enabled() )
-                return;
+                return false;
 
             for(int i = 0; i < shape_vertex_indices.size(); ++i)
             {
@@ -73,12 +201,56 @@ namespace CrashAndSqueeze
                 // when reaction_on_entering is false: invoke if region doesn't contain point, i.e. if contains == false == reaction_on_entering.
                 if( region.contains(position) == reaction_on_entering )
                 {
-                    invoke(vertex_index);
-                    return;
+                    result.reaction = this;
+                    result.vertex_index = vertex_index;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void RegionReaction::watch_vertices(WatchedVertices & watched)
+        {
+            watched_slots.clear();
+            for(int i = 0; i < shape_vertex_indices.size(); ++i)
+            {
+                watched_slots.push_back( watched.watch(shape_vertex_indices[i]) );
+            }
+        }
+
+        bool RegionReaction::is_invoke_needed(const IModel &model, const WatchedVertices & watched, ReactionResult & result)
+        {
+            if( ! is_enabled() )
+                return false;
+
+            // the shape is changed since watch_vertices: slots are not valid
+            if( watched_slots.size() != shape_vertex_indices.size() )
+                return is_invoke_needed(model, result);
+
+            for(int i = 0; i < watched_slots.size(); ++i)
+            {
+                int slot = watched_slots[i];
+                if(WatchedVertices::NO_SLOT == slot)
+                    continue;
+
+                // see is_invoke_needed(model, result) for the condition
+                if( region.contains(watched.get_equilibrium_pos(slot)) == reaction_on_entering )
+                {
+                    result.reaction = this;
+                    result.vertex_index = watched.get_vertex_index(slot);
+                    return true;
                 }
             }
+            return false;
         }
 
+        void RegionReaction::invoke_with(const IModel & /*model*/, const ReactionResult & result)
+        {
+            invoke(result.vertex_index);
+        }
+
+        // -- HitReaction --
+
         HitReaction::HitReaction(const IndexArray & shape_vertex_indices, Math::Real velocity_threshold) : shape_vertex_indices(shape_vertex_indices), velocity_threshold(velocity_threshold)
         {
             if ( 0 == shape_vertex_indices.size() )
@@ -106,18 +278,59 @@ namespace CrashAndSqueeze
             }
         }
 
+        // -- StretchReaction --
+
         void StretchReaction::invoke_if_needed(const IModel &model)
+        {
+            ReactionResult result;
+            if( is_invoke_needed(model, result) )
+                invoke_with(model, result);
+        }
+
+        bool StretchReaction::is_invoke_needed(const IModel &model, ReactionResult & result)
         {
             if( ! is_enabled() )
-                return;
+                return false;
 
             Math::Vector v1 = model.get_vertex_equilibrium_pos(index1);
             Math::Vector v2 = model.get_vertex_equilibrium_pos(index2);
             Math::Real dist = Math::distance(v1, v2);
             if (dist > dist_threshold)
             {
-                invoke(dist);
+                result.reaction = this;
+                result.distance = dist;
+                return true;
             }
+            return false;
+        }
+
+        void StretchReaction::watch_vertices(WatchedVertices & watched)
+        {
+            watched_slot1 = watched.watch(index1);
+            watched_slot2 = watched.watch(index2);
+        }
+
+        bool StretchReaction::is_invoke_needed(const IModel &model, const WatchedVertices & watched, ReactionResult & result)
+        {
+            if( ! is_enabled() )
+                return false;
+
+            if( WatchedVertices::NO_SLOT == watched_slot1 || WatchedVertices::NO_SLOT == watched_slot2 )
+                return is_invoke_needed(model, result);
+
+            Math::Real dist = Math::distance(watched.get_equilibrium_pos(watched_slot1), watched.get_equilibrium_pos(watched_slot2));
+            if (dist > dist_threshold)
+            {
+                result.reaction = this;
+                result.distance = dist;
+                return true;
+            }
+            return false;
+        }
+
+        void StretchReaction::invoke_with(const IModel & /*model*/, const ReactionResult & result)
+        {
+            invoke(result.distance);
         }
     }
 }
@@ -23,10 +23,87 @@ namespace CrashAndSqueeze
 
         typedef Enabled Reaction; // Currently Reaction is simply = Enabled, but in future we can make it a more sensible class
 
+        // Vertices watched by reactions: each reaction adds vertices it checks with WatchedVertices::watch
+        // and remembers returned slots, then positions of all watched vertices are computed at once
+        // (each vertex once, even if several reactions watch it) and reactions read them by slots.
+        class WatchedVertices
+        {
+        private:
+            // indices of watched vertices, one item per slot
+            IndexArray indices;
+            // slot of each vertex of the model, or NO_SLOT if the vertex isn't watched
+            IndexArray slots;
+
+            // positions of watched vertices, one item per slot
+            Collections::Array<Math::Vector> equilibrium_positions;
+            Collections::Array<Math::Vector> initial_positions;
+
+        public:
+            static const int NO_SLOT = -1;
+
+            // forgets watched vertices to start gathering them again for a model with `vertices_num' vertices
+            void reset(int vertices_num);
+            // adds a vertex to watched ones (if it is not watched yet) and returns its slot
+            int watch(int vertex_index);
+            // computes positions of all watched vertices
+            void compute_positions(const IModel & model);
+
+            int get_watched_num() const { return indices.size(); }
+            int get_vertex_index(int slot) const { return indices[slot]; }
+            const Math::Vector & get_equilibrium_pos(int slot) const { return equilibrium_positions[slot]; }
+            const Math::Vector & get_initial_pos(int slot) const { return initial_positions[slot]; }
+        };
+
+        class ModelReaction;
+
+        // What a reaction has found to be invoked with (see ModelReaction::is_invoke_needed)
+        struct ReactionResult
+        {
+            ModelReaction * reaction;
+            int vertex_index;
+            Math::Real distance;
+
+            ReactionResult() : reaction(NULL), vertex_index(0), distance(0) {}
+        };
+
         // Reaction that is invoked based on entire state of IModel
         class ModelReaction : public Reaction {
         public:
             virtual void invoke_if_needed(const IModel &model) = 0;
+
+            // Returns true if the reaction overrides watch_vertices, is_invoke_needed and invoke_with, so that
+            // it is checked with positions computed for all reactions at once (and by tasks of the step,
+            // if reactions are parallel). Otherwise Model simply calls invoke_if_needed(model)
+            virtual bool is_checked_with_watched() const { return false; }
+
+            // Adds vertices checked by the reaction to `watched'
+            virtual void watch_vertices(WatchedVertices & /*watched*/) {}
+
+            // Checks (without invoking) whether the reaction should be invoked, reading positions of vertices
+            // from `watched', where they were added by watch_vertices: if so, returns true and fills `result'.
+            // It can be called from a worker thread, so it must not change anything but `result'.
+            // By default returns false: see is_checked_with_watched
+            virtual bool is_invoke_needed(const IModel & /*model*/, const WatchedVertices & /*watched*/, /*out*/ ReactionResult & /*result*/)
+            {
+                return false;
+            }
+            // Invokes the reaction with the result found by is_invoke_needed
+            virtual void invoke_with(const IModel & /*model*/, const ReactionResult & /*result*/) {}
+
+            // Same as invoke_if_needed(model), but reads positions of vertices from `watched'
+            // (if the reaction is checked with watched vertices at all)
+            void invoke_if_needed(const IModel &model, const WatchedVertices & watched)
+            {
+                if( ! is_checked_with_watched() )
+                {
+                    invoke_if_needed(model);
+                    return;
+                }
+
+                ReactionResult result;
+                if( is_invoke_needed(model, watched, result) )
+                    invoke_with(model, result);
+            }
         };
 
         // An abstract reaction to shape deformation: is invoked when at least one
@@ -44,11 +121,21 @@ namespace CrashAndSqueeze
         private:
             const IndexArray & shape_vertex_indices;
             Math::Real threshold_distance;
+            // slots of shape vertices in WatchedVertices
+            IndexArray watched_slots;
 
         public:
             ShapeDeformationReaction(const IndexArray &shape_vertex_indices, Math::Real threshold_distance);
             
             void invoke_if_needed(const IModel &model);
+            // the same check as is_invoke_needed with watched vertices, but reading positions from `model'
+            bool is_invoke_needed(const IModel &model, /*out*/ ReactionResult & result);
+
+            virtual bool is_checked_with_watched() const { return true; }
+            virtual void watch_vertices(WatchedVertices & watched);
+            // if the shape is changed since watch_vertices, reads positions from `model'
+            virtual bool is_invoke_needed(const IModel &model, const WatchedVertices & watched, /*out*/ ReactionResult & result);
+            virtual void invoke_with(const IModel &model, const ReactionResult & result);
             
             // override this to use
             virtual void invoke(int vertex_index, Math::Real distance) = 0;
@@ -75,11 +162,21 @@ namespace CrashAndSqueeze
             const IndexArray & shape_vertex_indices;
             const IRegion & region;
             bool reaction_on_entering;
+            // slots of shape vertices in WatchedVertices
+            IndexArray watched_slots;
 
         public:
             RegionReaction(const IndexArray & shape_vertex_indices, const IRegion & region, bool reaction_on_entering);
 
             void invoke_if_needed(const IModel &model);
+            // the same check as is_invoke_needed with watched vertices, but reading positions from `model'
+            bool is_invoke_needed(const IModel &model, /*out*/ ReactionResult & result);
+
+            virtual bool is_checked_with_watched() const { return true; }
+            virtual void watch_vertices(WatchedVertices & watched);
+            // if the shape is changed since watch_vertices, reads positions from `model'
+            virtual bool is_invoke_needed(const IModel &model, const WatchedVertices & watched, /*out*/ ReactionResult & result);
+            virtual void invoke_with(const IModel &model, const ReactionResult & result);
             
             // override this to use
             virtual void invoke(int vertex_index) = 0;
@@ -136,13 +233,25 @@ namespace CrashAndSqueeze
             int index1;
             int index2;
             Math::Real dist_threshold;
+            // slots of the vertices in WatchedVertices
+            int watched_slot1;
+            int watched_slot2;
 
         public:
             StretchReaction(int index1, int index2, Math::Real dist_threshold)
-                : index1(index1), index2(index2), dist_threshold(dist_threshold)
+                : index1(index1), index2(index2), dist_threshold(dist_threshold),
+                  watched_slot1(WatchedVertices::NO_SLOT), watched_slot2(WatchedVertices::NO_SLOT)
             {}
             
             void invoke_if_needed(const IModel &model);
+            // the same check as is_invoke_needed with watched vertices, but reading positions from `model'
+            bool is_invoke_needed(const IModel &model, /*out*/ ReactionResult & result);
+
+            virtual bool is_checked_with_watched() const { return true; }
+            virtual void watch_vertices(WatchedVertices & watched);
+            // if the vertices are not watched (e.g. watch_vertices wasn't called yet), reads positions from `model'
+            virtual bool is_invoke_needed(const IModel &model, const WatchedVertices & watched, /*out*/ ReactionResult & result);
+            virtual void invoke_with(const IModel &model, const ReactionResult & result);
 
             int get_vertex1_index() const { return index1; }
             int get_vertex2_index() const { return index2; }
@@ -6,6 +6,7 @@ namespace CrashAndSqueeze
     using Math::Real;
     using Math::less_or_equal;
     using Math::greater_or_equal;
+    using Math::DEFAULT_REAL_PRECISION;
     using Math::Vector;
     using Math::VECTOR_SIZE;
 
@@ -24,6 +25,41 @@ namespace CrashAndSqueeze
             }
         }
 
+        bool is_inside_box(const Vector & point, const Vector & min_corner, const Vector & max_corner)
+        {
+            for(int i = 0; i < VECTOR_SIZE; ++i)
+            {
+                if( point[i] < min_corner[i] || point[i] > max_corner[i] )
+                    return false;
+            }
+            return true;
+        }
+
+        void get_cylinder_bounding_box(const Vector & center1,
+                                       const Vector & center2,
+                                       Real radius,
+                                       Vector & min_corner,
+                                       Vector & max_corner)
+        {
+            // caps are discs orthogonal to axis: along i'th coordinate axis a disc
+            // spans radius*sin(angle between the axes) to both sides of its center
+            Vector axis = center2 - center1;
+            Real length = axis.norm();
+            for(int i = 0; i < VECTOR_SIZE; ++i)
+            {
+                // a degenerate cylinder can be oriented anyhow: take the box of a sphere
+                Real half_size = radius;
+                if( 0 != length )
+                {
+                    Real cos_angle = axis[i]/length;
+                    Real sin_square = 1 - cos_angle*cos_angle;
+                    half_size = radius*sqrt(sin_square > 0 ? sin_square : 0);
+                }
+                min_corner[i] = (center1[i] < center2[i] ? center1[i] : center2[i]) - half_size;
+                max_corner[i] = (center1[i] > center2[i] ? center1[i] : center2[i]) + half_size;
+            }
+        }
+
         // -- EmptyRegion --
 
         bool EmptyRegion::contains(const Vector &point) const
@@ -42,6 +78,14 @@ namespace CrashAndSqueeze
             return Vector::ZERO;
         }
 
+        bool EmptyRegion::get_bounding_box(Vector & min_corner, Vector & max_corner) const
+        {
+            // an inverted box: no point is inside
+            min_corner = Vector(1, 1, 1);
+            max_corner = Vector(-1, -1, -1);
+            return true;
+        }
+
         // -- SphericalRegion --
 
         SphericalRegion::SphericalRegion(Vector center, Real radius)
@@ -70,6 +114,16 @@ namespace CrashAndSqueeze
             return center;
         }
 
+        bool SphericalRegion::get_bounding_box(Vector & min_corner, Vector & max_corner) const
+        {
+            // less_or_equal in contains allows points a bit farther than radius
+            Real padded_radius = radius + DEFAULT_REAL_PRECISION;
+            Vector half_size(padded_radius, padded_radius, padded_radius);
+            min_corner = center - half_size;
+            max_corner = center + half_size;
+            return true;
+        }
+
         // -- CylindricalRegion --
 
         CylindricalRegion::CylindricalRegion(const Vector & top_center,
@@ -120,6 +174,17 @@ namespace CrashAndSqueeze
             return (top_center + bottom_center)/2;
         }
 
+        bool CylindricalRegion::get_bounding_box(Vector & min_corner, Vector & max_corner) const
+        {
+            // less_or_equal and greater_or_equal in contains allow points a bit farther than radius
+            // and a bit beyond caps: pad the box both across and along the axis
+            get_cylinder_bounding_box(bottom_center, top_center, radius + DEFAULT_REAL_PRECISION, min_corner, max_corner);
+            Vector padding(DEFAULT_REAL_PRECISION, DEFAULT_REAL_PRECISION, DEFAULT_REAL_PRECISION);
+            min_corner -= padding;
+            max_corner += padding;
+            return true;
+        }
+
         // -- BoxRegion --
 
         BoxRegion::BoxRegion(const Vector & min_corner, const Vector & max_corner)
@@ -148,12 +213,7 @@ namespace CrashAndSqueeze
 
         bool BoxRegion::contains(const Vector &point) const
         {
-            for(int i = 0; i < VECTOR_SIZE; ++i)
-            {
-                if( point[i] < min_corner[i] || point[i] > max_corner[i] )
-                    return false;
-            }
-            return true;
+            return is_inside_box(point, min_corner, max_corner);
         }
 
         void BoxRegion::move(const Vector &vector)
@@ -166,6 +226,13 @@ namespace CrashAndSqueeze
             return (min_corner + max_corner)/2;
         }
 
+        bool BoxRegion::get_bounding_box(Vector & min_corner, Vector & max_corner) const
+        {
+            min_corner = this->min_corner;
+            max_corner = this->max_corner;
+            return true;
+        }
+
         Real BoxRegion::get_distance_to_border(const Math::Vector &point, int * side_index)
         {
             if (!contains(point))
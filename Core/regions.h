@@ -13,6 +13,14 @@ namespace CrashAndSqueeze
             virtual Math::Vector get_center() const = 0;
             virtual bool contains(const Math::Vector &point) const = 0;
             virtual void move(const Math::Vector &vector) = 0;
+
+            // Gets an axis-aligned box containing the region, so that only points inside the box are checked
+            // (min_corner is greater than max_corner if the region contains no points). By default
+            // returns false, meaning that the box is unknown: then all points must be checked
+            virtual bool get_bounding_box(/*out*/ Math::Vector & /*min_corner*/, /*out*/ Math::Vector & /*max_corner*/) const
+            {
+                return false;
+            }
         };
 
         class IScalarField
@@ -21,6 +29,17 @@ namespace CrashAndSqueeze
             //virtual bool is_defined_at(const Math::Vector &point) const = 0;
             virtual Math::Real get_value_at(const Math::Vector &point) const = 0;
         };
+
+        // Returns true if the point is inside the axis-aligned box (borders included)
+        bool is_inside_box(const Math::Vector & point, const Math::Vector & min_corner, const Math::Vector & max_corner);
+
+        // Gets an axis-aligned box containing the cylinder with given centers of caps and radius
+        // (if the centers coincide, the axis is unknown, so the box of a sphere with this radius is returned)
+        void get_cylinder_bounding_box(const Math::Vector & center1,
+                                       const Math::Vector & center2,
+                                       Math::Real radius,
+                                       /*out*/ Math::Vector & min_corner,
+                                       /*out*/ Math::Vector & max_corner);
         
         class EmptyRegion : public IRegion
         {
@@ -28,6 +47,7 @@ namespace CrashAndSqueeze
             virtual Math::Vector get_center() const;
             virtual bool contains(const Math::Vector &point) const;
             virtual void move(const Math::Vector &vector);
+            virtual bool get_bounding_box(/*out*/ Math::Vector & min_corner, /*out*/ Math::Vector & max_corner) const;
         };
 
         class SphericalRegion : public IRegion
@@ -48,6 +68,7 @@ namespace CrashAndSqueeze
             virtual Math::Vector get_center() const;
             virtual bool contains(const Math::Vector &point) const;
             virtual void move(const Math::Vector &vector);
+            virtual bool get_bounding_box(/*out*/ Math::Vector & min_corner, /*out*/ Math::Vector & max_corner) const;
         };
 
         class CylindricalRegion : public IRegion
@@ -76,6 +97,7 @@ namespace CrashAndSqueeze
             virtual Math::Vector get_center() const;
             virtual bool contains(const Math::Vector &point) const;
             virtual void move(const Math::Vector &vector);
+            virtual bool get_bounding_box(/*out*/ Math::Vector & min_corner, /*out*/ Math::Vector & max_corner) const;
         };
 
         class BoxRegion : public IRegion
@@ -100,6 +122,7 @@ namespace CrashAndSqueeze
             Math::Vector get_center() const;
             virtual bool contains(const Math::Vector &point) const;
             virtual void move(const Math::Vector &vector);
+            virtual bool get_bounding_box(/*out*/ Math::Vector & min_corner, /*out*/ Math::Vector & max_corner) const;
         };
     }
 }
@@ -13,4 +13,8 @@ void CrashAndSqueeze::Core::SimulationParams::set_defaults()
     quadratic_creep_speed = Cluster::DEFAULT_QX_CREEP_CONSTANT;
 #endif // CAS_QUADRATIC_EXTENSIONS_ENABLED && CAS_QUADRATIC_PLASTICITY_ENABLED
     max_deformation = Cluster::DEFAULT_MAX_DEFORMATION_CONSTANT;
+    rotation_extraction_iterations = Cluster::DEFAULT_ROTATION_EXTRACTION_ITERATIONS;
+    sleep_steps = Cluster::DEFAULT_SLEEP_STEPS;
+    sleep_energy_threshold = Cluster::DEFAULT_SLEEP_ENERGY_CONSTANT;
+    sleep_plasticity_threshold = Cluster::DEFAULT_SLEEP_PLASTICITY_CONSTANT;
 }
@@ -48,6 +48,28 @@ namespace CrashAndSqueeze
             // see Cluster::DEFAULT_MAX_DEFORMATION_CONSTANT
             Math::Real max_deformation;
 
+            // - Shape matching performance parameters -
+
+            // maximum number of iterations of rotation extraction, warm-started from previous step
+            // (0 means full polar decomposition, which is slower)
+            // see Cluster::DEFAULT_ROTATION_EXTRACTION_ITERATIONS
+            int rotation_extraction_iterations;
+
+            // - Sleeping parameters -
+
+            // a number of steps, for which a cluster must stay idle to fall asleep (then it is
+            // not computed until woken up): 0 means that the cluster never sleeps
+            // see Cluster::DEFAULT_SLEEP_STEPS
+            int sleep_steps;
+
+            // a threshold of kinetic energy (per unit of mass) of cluster vertices, below which the cluster is idle
+            // see Cluster::DEFAULT_SLEEP_ENERGY_CONSTANT
+            Math::Real sleep_energy_threshold;
+
+            // a threshold of change of plastic deformation per step, below which the cluster is idle
+            // see Cluster::DEFAULT_SLEEP_PLASTICITY_CONSTANT
+            Math::Real sleep_plasticity_threshold;
+
             // Sets the default values, mentioned in comments to each parameter
             void set_defaults();
         };
@@ -0,0 +1,221 @@
+#include "Core/skinning.h"
+#include "Core/cluster_kernels.h"
+#include "Core/graphical_vertex.h"
+#include "Core/cluster.h"
+
+using CrashAndSqueeze::Math::Real;
+using CrashAndSqueeze::Math::Vector;
+using CrashAndSqueeze::Math::VECTOR_SIZE;
+using CrashAndSqueeze::Logging::Logger;
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+using CrashAndSqueeze::Math::TriVector;
+using CrashAndSqueeze::Math::COMPONENTS_NUM;
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+#if CAS_SIMD_X86
+        // defined in skinning_sse2.cpp
+        void sse2_blend_point(const VertexFloat * transforms, const int * clusters, const VertexFloat * items, int items_num, VertexFloat point[Skinning::COLUMN_SIZE]);
+#endif // CAS_SIMD_X86
+
+        namespace
+        {
+            void scalar_blend_point(const VertexFloat * transforms, const int * clusters, const VertexFloat * items, int items_num, VertexFloat point[Skinning::COLUMN_SIZE])
+            {
+                VertexFloat sum[Skinning::COLUMN_SIZE] = {0};
+                for(int i = 0; i < items_num; ++i)
+                {
+                    const VertexFloat * transform = transforms + clusters[i]*Skinning::TRANSFORM_SIZE;
+                    const VertexFloat * item = items + i*Skinning::ITEM_SIZE;
+                    for(int c = 0; c < Skinning::COLUMNS_NUM; ++c)
+                    {
+                        for(int r = 0; r < Skinning::COLUMN_SIZE; ++r)
+                            sum[r] += transform[c*Skinning::COLUMN_SIZE + r]*item[c];
+                    }
+                }
+                for(int r = 0; r < Skinning::COLUMN_SIZE; ++r)
+                    point[r] = sum[r];
+            }
+
+            Skinning::BlendFunc get_blend_func(bool simd_enabled)
+            {
+#if CAS_SIMD_X86
+                if(simd_enabled && ClusterKernels::is_supported(ClusterKernels::SSE2))
+                    return sse2_blend_point;
+#else
+                ignore_unreferenced(simd_enabled);
+#endif // CAS_SIMD_X86
+                return scalar_blend_point;
+            }
+        }
+
+        // written transformations are stored as VertexFloat, so smaller changes are not noticeable anyway
+        const Real Skinning::DEFAULT_CHANGE_EPSILON = 1e-6;
+
+        Skinning::Skinning()
+            : change_epsilon(DEFAULT_CHANGE_EPSILON), blend(get_blend_func(true))
+        {
+        }
+
+        void Skinning::set_simd_enabled(bool enabled)
+        {
+            blend = get_blend_func(enabled);
+        }
+
+        void Skinning::init(const Collections::Array<GraphicalVertex> & vertices, const Collections::Array<Cluster> & clusters)
+        {
+            first_items.clear();
+            clusters_nums.clear();
+            item_clusters.clear();
+            items.clear();
+            transforms.clear();
+            written_transforms.clear();
+            first_cluster_vertices.clear();
+            clusters_vertices.clear();
+
+            transforms.create_items(clusters.size()*TRANSFORM_SIZE);
+            written_transforms.create_items(clusters.size()*TRANSFORM_SIZE);
+            for(int i = 0; i < transforms.size(); ++i)
+                transforms[i] = written_transforms[i] = 0;
+
+            for(int i = 0; i < vertices.size(); ++i)
+            {
+                const GraphicalVertex & vertex = vertices[i];
+                int clusters_num = vertex.get_including_clusters_num();
+
+                first_items.push_back(item_clusters.size());
+                clusters_nums.push_back(clusters_num);
+
+                for(int j = 0; j < vertex.get_points_num(); ++j)
+                {
+                    for(int k = 0; k < clusters_num; ++k)
+                    {
+                        int cluster_index = vertex.get_including_cluster_index(k);
+                        Real weight = vertex.get_cluster_weight(k);
+                        Vector offset = vertex.get_point(j) - clusters[cluster_index].get_initial_center_of_mass();
+
+                        VertexFloat item[ITEM_SIZE] = {0};
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+                        TriVector tri_offset(offset);
+                        for(int m = 0; m < COMPONENTS_NUM; ++m)
+                        {
+                            for(int c = 0; c < VECTOR_SIZE; ++c)
+                                item[m*VECTOR_SIZE + c] = static_cast<VertexFloat>(tri_offset.vectors[m][c]*weight);
+                        }
+#else
+                        for(int c = 0; c < VECTOR_SIZE; ++c)
+                            item[c] = static_cast<VertexFloat>(offset[c]*weight);
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+                        item[OFFSET_SIZE] = static_cast<VertexFloat>(weight);
+
+                        item_clusters.push_back(cluster_index);
+                        for(int c = 0; c < ITEM_SIZE; ++c)
+                            items.push_back(item[c]);
+                    }
+                }
+            }
+
+            // vertices of each cluster: count them, then fill rows in order of vertices
+            first_cluster_vertices.create_items(clusters.size() + 1);
+            for(int i = 0; i <= clusters.size(); ++i)
+                first_cluster_vertices[i] = 0;
+            for(int i = 0; i < vertices.size(); ++i)
+            {
+                for(int k = 0; k < vertices[i].get_including_clusters_num(); ++k)
+                    ++first_cluster_vertices[vertices[i].get_including_cluster_index(k) + 1];
+            }
+            for(int i = 0; i < clusters.size(); ++i)
+                first_cluster_vertices[i + 1] += first_cluster_vertices[i];
+
+            IndexArray next(clusters.size());
+            for(int i = 0; i < clusters.size(); ++i)
+                next.push_back(first_cluster_vertices[i]);
+            clusters_vertices.create_items(first_cluster_vertices[clusters.size()]);
+            for(int i = 0; i < vertices.size(); ++i)
+            {
+                for(int k = 0; k < vertices[i].get_including_clusters_num(); ++k)
+                    clusters_vertices[next[vertices[i].get_including_cluster_index(k)]++] = i;
+            }
+
+            set_transforms(clusters);
+        }
+
+        bool Skinning::is_changed(int cluster_index) const
+        {
+            int first = cluster_index*TRANSFORM_SIZE;
+            for(int i = first; i < first + TRANSFORM_SIZE; ++i)
+            {
+                if(fabs(transforms[i] - written_transforms[i]) > change_epsilon)
+                    return true;
+            }
+            return false;
+        }
+
+        void Skinning::mark_written(int cluster_index)
+        {
+            int first = cluster_index*TRANSFORM_SIZE;
+            for(int i = first; i < first + TRANSFORM_SIZE; ++i)
+                written_transforms[i] = transforms[i];
+        }
+
+        void Skinning::mark_all_written()
+        {
+            for(int i = 0; i < transforms.size(); ++i)
+                written_transforms[i] = transforms[i];
+        }
+
+        void Skinning::set_transforms(const Collections::Array<Cluster> & clusters)
+        {
+            if(transforms.size() != clusters.size()*TRANSFORM_SIZE)
+            {
+                Logger::error("in Skinning::set_transforms: wrong number of clusters, call Skinning::init first", __FILE__, __LINE__);
+                return;
+            }
+
+            for(int i = 0; i < clusters.size(); ++i)
+            {
+                set_transform(i, clusters[i].get_graphical_pos_transform(), clusters[i].get_center_of_mass());
+            }
+        }
+
+        void Skinning::set_transform(int cluster_index, const Transform & transform, const Vector & center)
+        {
+            VertexFloat * columns = &transforms[cluster_index*TRANSFORM_SIZE];
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            for(int m = 0; m < COMPONENTS_NUM; ++m)
+            {
+                for(int c = 0; c < VECTOR_SIZE; ++c)
+                {
+                    for(int r = 0; r < VECTOR_SIZE; ++r)
+                        columns[(m*VECTOR_SIZE + c)*COLUMN_SIZE + r] = static_cast<VertexFloat>(transform.matrices[m].get_at(r, c));
+                }
+            }
+#else
+            for(int c = 0; c < VECTOR_SIZE; ++c)
+            {
+                for(int r = 0; r < VECTOR_SIZE; ++r)
+                    columns[c*COLUMN_SIZE + r] = static_cast<VertexFloat>(transform.get_at(r, c));
+            }
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+            for(int r = 0; r < VECTOR_SIZE; ++r)
+                columns[OFFSET_SIZE*COLUMN_SIZE + r] = static_cast<VertexFloat>(center[r]);
+        }
+
+        void Skinning::compute_point(int vertex_index, int point_index, /*out*/ VertexFloat point[COLUMN_SIZE]) const
+        {
+            int clusters_num = clusters_nums[vertex_index];
+            if(0 == clusters_num)
+            {
+                for(int r = 0; r < COLUMN_SIZE; ++r)
+                    point[r] = 0;
+                return;
+            }
+
+            int first = first_items[vertex_index] + point_index*clusters_num;
+            blend(&transforms[0], &item_clusters[first], &items[first*ITEM_SIZE], clusters_num, point);
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "Core/core.h"
+#include "Math/floating_point.h"
+#include "Math/vector.h"
+#include "Math/matrix.h"
+#include "Math/quadratic.h"
+#include "Collections/array.h"
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+        class GraphicalVertex;
+        class Cluster;
+
+        // CPU skinning of graphical vertices: does on CPU what deform_qx.vsh does on GPU.
+        //
+        // A point of a graphical vertex is a weighted sum of its positions in including clusters:
+        //     sum of w_k*(T_k*offset_k + c_k), where offset_k = point - (initial center of mass of k'th cluster)
+        // (in QX offset_k is expanded to TriVector). Offsets and weights are constant, so the items
+        // [w_k*offset_k, w_k] are precomputed once, while transformations [T_k c_k] (with center of mass
+        // as the last column) are packed each step. So a point is just a sum of matrix-item products,
+        // which is computed with SSE when CPU supports it.
+        //
+        // All data is stored as VertexFloat, since the result is written to vertex buffer anyway.
+        class Skinning
+        {
+        public:
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            typedef Math::TriMatrix Transform;
+            static const int OFFSET_SIZE = Math::VECTOR_SIZE*Math::COMPONENTS_NUM;
+#else
+            typedef Math::Matrix Transform;
+            static const int OFFSET_SIZE = Math::VECTOR_SIZE;
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+            // columns of transformation: offset components and center of mass
+            static const int COLUMNS_NUM = OFFSET_SIZE + 1;
+            // floats in a column: VECTOR_SIZE rows padded to 4
+            static const int COLUMN_SIZE = 4;
+            static const int TRANSFORM_SIZE = COLUMNS_NUM*COLUMN_SIZE;
+            // floats in an item: COLUMNS_NUM components padded to a multiple of 4
+            static const int ITEM_SIZE = (COLUMNS_NUM + 3)/4*4;
+
+            // point = sum of transforms[clusters[i]]*items[i] (the 4th component of point is garbage)
+            typedef void (*BlendFunc)(const VertexFloat * transforms,
+                                      const int * clusters,
+                                      const VertexFloat * items,
+                                      int items_num,
+                                      /*out*/ VertexFloat point[COLUMN_SIZE]);
+
+        private:
+            // items of i'th vertex start at first_items[i] and are grouped by points:
+            // the item of j'th point and k'th including cluster is first_items[i] + j*clusters_nums[i] + k
+            IndexArray first_items;
+            IndexArray clusters_nums;
+            // cluster index of each item
+            IndexArray item_clusters;
+            // ITEM_SIZE floats for each item
+            Collections::Array<VertexFloat> items;
+            // TRANSFORM_SIZE floats for each cluster: columns of transformation
+            Collections::Array<VertexFloat> transforms;
+            // transformations, with which vertices were written last time (see Skinning::mark_written)
+            Collections::Array<VertexFloat> written_transforms;
+            // a cluster is changed if an element of its transformation differs from the written one by more than this
+            Math::Real change_epsilon;
+
+            // vertices of i'th cluster are in clusters_vertices from first_cluster_vertices[i] to first_cluster_vertices[i + 1] - 1
+            IndexArray first_cluster_vertices;
+            IndexArray clusters_vertices;
+
+            BlendFunc blend;
+
+        public:
+            static const Math::Real DEFAULT_CHANGE_EPSILON;
+
+            Skinning();
+
+            // Precomputes items for given vertices: must be called after clusters are
+            // assigned and Cluster::compute_initial_characteristics is called for them
+            void init(const Collections::Array<GraphicalVertex> & vertices, const Collections::Array<Cluster> & clusters);
+
+            // Packs current graphical transformations of all clusters
+            void set_transforms(const Collections::Array<Cluster> & clusters);
+            // Packs transformation of one cluster
+            void set_transform(int cluster_index, const Transform & transform, const Math::Vector & center);
+
+            // Returns true if transformation of the cluster has changed by more than change epsilon since it was marked written
+            bool is_changed(int cluster_index) const;
+            // Remembers current transformation of the cluster as written to vertex buffer
+            void mark_written(int cluster_index);
+            void mark_all_written();
+
+            void set_change_epsilon(Math::Real epsilon) { change_epsilon = epsilon; }
+            Math::Real get_change_epsilon() const { return change_epsilon; }
+
+            int get_cluster_vertices_num(int cluster_index) const { return first_cluster_vertices[cluster_index + 1] - first_cluster_vertices[cluster_index]; }
+            // returns index of k'th graphical vertex of given cluster
+            int get_cluster_vertex(int cluster_index, int k) const { return clusters_vertices[first_cluster_vertices[cluster_index] + k]; }
+
+            int get_vertices_num() const { return clusters_nums.size(); }
+            int get_clusters_num(int vertex_index) const { return clusters_nums[vertex_index]; }
+
+            // Computes deformed position of given point of given vertex
+            void compute_point(int vertex_index, int point_index, /*out*/ VertexFloat point[COLUMN_SIZE]) const;
+
+            // By default SSE is used if supported by CPU: it can be disabled (for comparison)
+            void set_simd_enabled(bool enabled);
+
+        private:
+            // No copying!
+            Skinning(const Skinning &);
+            Skinning & operator=(const Skinning &);
+        };
+    }
+}
@@ -0,0 +1,46 @@
+#include "Core/skinning.h"
+#include "Core/cluster_kernels.h"
+
+#if CAS_SIMD_X86
+#include <emmintrin.h>
+
+// The code below is compiled with SSE2 instructions: it is called only if CPU supports them
+#if defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif // defined(__GNUC__)
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+        // A column of transformation is a whole register: point is accumulated as a sum of
+        // columns multiplied by broadcasted item components (even and odd columns are
+        // accumulated separately to shorten dependency chains)
+        void sse2_blend_point(const VertexFloat * transforms, const int * clusters, const VertexFloat * items, int items_num, VertexFloat point[Skinning::COLUMN_SIZE])
+        {
+            __m128 even_sum = _mm_setzero_ps();
+            __m128 odd_sum = _mm_setzero_ps();
+            for(int i = 0; i < items_num; ++i)
+            {
+                const VertexFloat * transform = transforms + clusters[i]*Skinning::TRANSFORM_SIZE;
+                const VertexFloat * item = items + i*Skinning::ITEM_SIZE;
+                int c = 0;
+                for(; c + 1 < Skinning::COLUMNS_NUM; c += 2)
+                {
+                    even_sum = _mm_add_ps(even_sum, _mm_mul_ps(_mm_loadu_ps(transform + c*Skinning::COLUMN_SIZE), _mm_set1_ps(item[c])));
+                    odd_sum  = _mm_add_ps(odd_sum,  _mm_mul_ps(_mm_loadu_ps(transform + (c + 1)*Skinning::COLUMN_SIZE), _mm_set1_ps(item[c + 1])));
+                }
+                if(c < Skinning::COLUMNS_NUM)
+                    even_sum = _mm_add_ps(even_sum, _mm_mul_ps(_mm_loadu_ps(transform + c*Skinning::COLUMN_SIZE), _mm_set1_ps(item[c])));
+            }
+            _mm_storeu_ps(point, _mm_add_ps(even_sum, odd_sum));
+        }
+    }
+}
+
+#if defined(__GNUC__)
+#pragma GCC pop_options
+#endif // defined(__GNUC__)
+
+#endif // CAS_SIMD_X86
@@ -0,0 +1,79 @@
+#include "Core/surface_adjacency.h"
+
+namespace CrashAndSqueeze
+{
+    using Logging::Logger;
+
+    namespace Core
+    {
+        bool SurfaceAdjacency::build(ISurface & surface, int vertices_num)
+        {
+            clear();
+
+            // read triangles and count triangles of each vertex
+            first_triangles.create_items(vertices_num + 1);
+            for(int i = 0; i <= vertices_num; ++i)
+                first_triangles[i] = 0;
+
+            bool success = true;
+            ISurface::TriangleArray triangle_array = surface.get_triangle_array();
+            if(NULL != triangle_array.triangles)
+            {
+                for(int i = 0; i < triangle_array.triangles_num && success; ++i)
+                    success = add_triangle(triangle_array.triangles[i], vertices_num);
+            }
+            else
+            {
+                // fallback for surfaces which don't store triangles contiguously
+                ISurface::TriangleIterator * triangle_iterator = surface.get_triangles();
+                for(ISurface::TriangleIterator & t = *triangle_iterator; t.has_value() && success; ++t)
+                    success = add_triangle(*t, vertices_num);
+                surface.destroy_iterator(triangle_iterator);
+            }
+            if( ! success )
+            {
+                clear();
+                Logger::error("in SurfaceAdjacency::build: triangle refers to a vertex out of range", __FILE__, __LINE__);
+                return false;
+            }
+
+            // prefix sums of counts are the first positions
+            for(int i = 0; i < vertices_num; ++i)
+                first_triangles[i + 1] += first_triangles[i];
+
+            // fill rows in order of triangles, using positions in `next` as cursors
+            IndexArray next(vertices_num);
+            for(int i = 0; i < vertices_num; ++i)
+                next.push_back(first_triangles[i]);
+            vertices_triangles.create_items(triangles_vertices.size());
+            for(int i = 0; i < triangles_vertices.size(); ++i)
+            {
+                int vertex = triangles_vertices[i];
+                vertices_triangles[next[vertex]++] = i/ISurface::VERTICES_PER_TRIANGLE;
+            }
+            return true;
+        }
+
+        bool SurfaceAdjacency::add_triangle(const ISurface::Triangle & triangle, int vertices_num)
+        {
+            for(int j = 0; j < ISurface::VERTICES_PER_TRIANGLE; ++j)
+            {
+                if(triangle[j] >= static_cast<unsigned>(vertices_num))
+                    return false;
+            }
+            for(int j = 0; j < ISurface::VERTICES_PER_TRIANGLE; ++j)
+            {
+                triangles_vertices.push_back(triangle[j]);
+                ++first_triangles[triangle[j] + 1];
+            }
+            return true;
+        }
+
+        void SurfaceAdjacency::clear()
+        {
+            triangles_vertices.clear();
+            first_triangles.clear();
+            vertices_triangles.clear();
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "Core/core.h"
+#include "Core/isurface.h"
+#include "Collections/array.h"
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+        // Triangles of ISurface, read once, and vertex-to-triangle adjacency stored as compressed rows:
+        // triangles including i'th vertex are get_vertex_triangle(i, k) for k from 0 to get_vertex_triangles_num(i) - 1,
+        // in order of their appearance in the surface. So a value accumulated from triangles can be gathered
+        // for each vertex independently (e.g. for ranges of vertices in parallel), without virtual calls.
+        class SurfaceAdjacency
+        {
+        private:
+            // ISurface::VERTICES_PER_TRIANGLE indices for each triangle
+            IndexArray triangles_vertices;
+            // triangles of i'th vertex are in vertices_triangles from first_triangles[i] to first_triangles[i + 1] - 1
+            IndexArray first_triangles;
+            IndexArray vertices_triangles;
+
+            // adds the triangle and counts it for its vertices, returns false if it refers to a vertex out of range
+            bool add_triangle(const ISurface::Triangle & triangle, int vertices_num);
+
+        public:
+            SurfaceAdjacency() {}
+
+            // Reads triangles of `surface` (all at once if it provides ISurface::get_triangle_array,
+            // otherwise with an iterator) and builds adjacency for `vertices_num` vertices.
+            // Returns false if a triangle refers to a vertex out of range (then adjacency is left empty).
+            bool build(ISurface & surface, int vertices_num);
+            void clear();
+
+            int get_vertices_num() const { return first_triangles.size() > 0 ? first_triangles.size() - 1 : 0; }
+            int get_triangles_num() const { return triangles_vertices.size()/ISurface::VERTICES_PER_TRIANGLE; }
+
+            // returns index of j'th vertex of given triangle
+            int get_triangle_vertex(int triangle, int j) const { return triangles_vertices[triangle*ISurface::VERTICES_PER_TRIANGLE + j]; }
+
+            int get_vertex_triangles_num(int vertex) const { return first_triangles[vertex + 1] - first_triangles[vertex]; }
+            // returns index of k'th triangle including given vertex
+            int get_vertex_triangle(int vertex, int k) const { return vertices_triangles[first_triangles[vertex] + k]; }
+
+        private:
+            // No copying!
+            SurfaceAdjacency(const SurfaceAdjacency &);
+            SurfaceAdjacency & operator=(const SurfaceAdjacency &);
+        };
+    }
+}
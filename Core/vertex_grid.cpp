@@ -0,0 +1,174 @@
+#include "Core/vertex_grid.h"
+#include <algorithm> // for std::sort
+
+namespace CrashAndSqueeze
+{
+    using Math::Real;
+    using Math::Vector;
+    using Math::VECTOR_SIZE;
+
+    namespace Core
+    {
+        VertexGrid::VertexGrid()
+        {
+            clear();
+        }
+
+        void VertexGrid::clear()
+        {
+            first_cell_points.clear();
+            cells_points.clear();
+            points_cells.clear();
+            min_pos = max_pos = Vector::ZERO;
+            for(int i = 0; i < VECTOR_SIZE; ++i)
+            {
+                cells_by_axes[i] = 1;
+                cell_sizes[i] = 1;
+            }
+        }
+
+        int VertexGrid::get_cell(int axis, Real coordinate) const
+        {
+            Real offset = (coordinate - min_pos[axis])/cell_sizes[axis];
+            if(offset < 0)
+                return 0;
+            if(offset >= cells_by_axes[axis])
+                return cells_by_axes[axis] - 1;
+            return static_cast<int>(offset);
+        }
+
+        void VertexGrid::build(const Vector * points, int points_num)
+        {
+            clear();
+            if(points_num <= 0)
+                return;
+
+            // -- Find bounds of points --
+            min_pos = max_pos = points[0];
+            for(int i = 1; i < points_num; ++i)
+            {
+                for(int j = 0; j < VECTOR_SIZE; ++j)
+                {
+                    if(points[i][j] < min_pos[j])
+                        min_pos[j] = points[i][j];
+                    if(points[i][j] > max_pos[j])
+                        max_pos[j] = points[i][j];
+                }
+            }
+
+            // -- Choose cell size: a cell of non-flat dimensions contains POINTS_PER_CELL points on average --
+            Real volume = 1;
+            int dimensions = 0;
+            for(int j = 0; j < VECTOR_SIZE; ++j)
+            {
+                Real size = max_pos[j] - min_pos[j];
+                if(size > 0)
+                {
+                    volume *= size;
+                    ++dimensions;
+                }
+            }
+            if(dimensions > 0)
+            {
+                Real cell_size = pow(volume*POINTS_PER_CELL/points_num, static_cast<Real>(1)/dimensions);
+                for(int j = 0; j < VECTOR_SIZE; ++j)
+                {
+                    Real size = max_pos[j] - min_pos[j];
+                    if(size <= 0)
+                        continue;
+                    Real cells_num = size/cell_size;
+                    cells_by_axes[j] = cells_num < 1 ? 1 : (cells_num > MAX_CELLS_PER_AXIS ? MAX_CELLS_PER_AXIS : static_cast<int>(cells_num));
+                }
+            }
+
+            // -- Limit the total number of cells: if points are almost flat along some axis, it gets
+            //    only one cell, and the others get too many of them --
+            const Real max_cells_num = static_cast<Real>(points_num)*MAX_CELLS_PER_POINT;
+            for(;;)
+            {
+                Real total_cells_num = 1;
+                int split_axes = 0;
+                for(int j = 0; j < VECTOR_SIZE; ++j)
+                {
+                    total_cells_num *= cells_by_axes[j];
+                    if(cells_by_axes[j] > 1)
+                        ++split_axes;
+                }
+                if(total_cells_num <= max_cells_num)
+                    break;
+
+                // shrink split axes proportionally, each by at least one cell
+                Real factor = pow(max_cells_num/total_cells_num, static_cast<Real>(1)/split_axes);
+                for(int j = 0; j < VECTOR_SIZE; ++j)
+                {
+                    if(cells_by_axes[j] <= 1)
+                        continue;
+                    int reduced = static_cast<int>(cells_by_axes[j]*factor);
+                    if(reduced >= cells_by_axes[j])
+                        reduced = cells_by_axes[j] - 1;
+                    cells_by_axes[j] = reduced < 1 ? 1 : reduced;
+                }
+            }
+            for(int j = 0; j < VECTOR_SIZE; ++j)
+            {
+                Real size = max_pos[j] - min_pos[j];
+                if(size > 0)
+                    cell_sizes[j] = size/cells_by_axes[j];
+            }
+            int cells_num = cells_by_axes[0]*cells_by_axes[1]*cells_by_axes[2];
+
+            // -- Count points of each cell --
+            first_cell_points.create_items(cells_num + 1);
+            for(int i = 0; i <= cells_num; ++i)
+                first_cell_points[i] = 0;
+            points_cells.create_items(points_num);
+            for(int i = 0; i < points_num; ++i)
+            {
+                points_cells[i] = get_cell_index(get_cell(0, points[i][0]), get_cell(1, points[i][1]), get_cell(2, points[i][2]));
+                ++first_cell_points[points_cells[i] + 1];
+            }
+            for(int i = 0; i < cells_num; ++i)
+                first_cell_points[i + 1] += first_cell_points[i];
+
+            // -- Fill rows in order of points, using positions in `next` as cursors --
+            IndexArray next(cells_num);
+            for(int i = 0; i < cells_num; ++i)
+                next.push_back(first_cell_points[i]);
+            cells_points.create_items(points_num);
+            for(int i = 0; i < points_num; ++i)
+                cells_points[next[points_cells[i]]++] = i;
+        }
+
+        void VertexGrid::find_candidates(const Vector & min_corner, const Vector & max_corner, /*out*/ IndexArray & found) const
+        {
+            int first_found = found.size();
+            int first[VECTOR_SIZE];
+            int last[VECTOR_SIZE];
+            for(int j = 0; j < VECTOR_SIZE; ++j)
+            {
+                // the box doesn't intersect the grid (or is empty)
+                if(0 == get_cells_num() || min_corner[j] > max_corner[j] || min_corner[j] > max_pos[j] || max_corner[j] < min_pos[j])
+                    return;
+                first[j] = get_cell(j, min_corner[j]);
+                last[j] = get_cell(j, max_corner[j]);
+            }
+
+            for(int x = first[0]; x <= last[0]; ++x)
+            {
+                for(int y = first[1]; y <= last[1]; ++y)
+                {
+                    for(int z = first[2]; z <= last[2]; ++z)
+                    {
+                        int cell = get_cell_index(x, y, z);
+                        for(int i = first_cell_points[cell]; i < first_cell_points[cell + 1]; ++i)
+                            found.push_back(cells_points[i]);
+                    }
+                }
+            }
+
+            // points of each cell are in ascending order, but cells are not
+            if(found.size() > first_found)
+                std::sort(&found[first_found], &found[first_found] + (found.size() - first_found));
+        }
+    }
+}
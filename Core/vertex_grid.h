@@ -0,0 +1,61 @@
+#pragma once
+#include "Core/core.h"
+#include "Math/vector.h"
+#include "Collections/array.h"
+
+namespace CrashAndSqueeze
+{
+    namespace Core
+    {
+        // A uniform grid over points (positions of physical vertices), built from scratch by counting sort:
+        // indices of points in each cell are stored as compressed rows in order of cells. Cell size is chosen
+        // so that a cell contains a few points on average. So points inside a box are found by checking
+        // only points of cells intersecting the box.
+        class VertexGrid
+        {
+        public:
+            // desired average number of points in a cell
+            static const int POINTS_PER_CELL = 4;
+            static const int MAX_CELLS_PER_AXIS = 1024;
+            // the total number of cells is no more than the number of points times this
+            static const int MAX_CELLS_PER_POINT = 1;
+
+        private:
+            Math::Vector min_pos;
+            Math::Vector max_pos;
+            int cells_by_axes[Math::VECTOR_SIZE];
+            Math::Real cell_sizes[Math::VECTOR_SIZE];
+
+            // points of i'th cell are in cells_points from first_cell_points[i] to first_cell_points[i + 1] - 1
+            IndexArray first_cell_points;
+            IndexArray cells_points;
+
+            // cell of each point (used in build() only)
+            IndexArray points_cells;
+
+            // returns cell along given axis containing given coordinate (nearest one, if it is outside the grid)
+            int get_cell(int axis, Math::Real coordinate) const;
+            int get_cell_index(int x, int y, int z) const { return (x*cells_by_axes[1] + y)*cells_by_axes[2] + z; }
+
+        public:
+            VertexGrid();
+
+            // Distributes `points_num` points into cells of a new grid
+            void build(const Math::Vector * points, int points_num);
+            void clear();
+
+            // Appends to `found` indices of all points which can be inside the box given by its
+            // corners, in ascending order (these points still need to be checked)
+            void find_candidates(const Math::Vector & min_corner, const Math::Vector & max_corner, /*out*/ IndexArray & found) const;
+
+            int get_points_num() const { return cells_points.size(); }
+            int get_cells_num() const { return first_cell_points.size() > 0 ? first_cell_points.size() - 1 : 0; }
+            int get_cells_num(int axis) const { return cells_by_axes[axis]; }
+
+        private:
+            // No copying!
+            VertexGrid(const VertexGrid &);
+            VertexGrid & operator=(const VertexGrid &);
+        };
+    }
+}
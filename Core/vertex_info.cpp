@@ -27,7 +27,7 @@ namespace CrashAndSqueeze
 
         int VertexInfo::get_max_valid_cluster_indices_offset() const
         {
-            return vertex_size - CLUSTER_INDICES_NUM*sizeof(ClusterIndex);
+            return vertex_size - cluster_indices_num*cluster_index_size;
         }
 
         int VertexInfo::get_max_valid_clusters_num_offset() const
@@ -57,7 +57,7 @@ namespace CrashAndSqueeze
         void VertexInfo::set_cluster_indices_offset(int offset)
         {
             if( offset < 0 || offset > get_max_valid_cluster_indices_offset() )
-                Logger::error("in VertexInfo::set_cluster_indices_offset: invalid offset: it should be >= 0 and leave enough space for CLUSTER_INDICES_NUM ClusterIndex values", __FILE__, __LINE__);
+                Logger::error("in VertexInfo::set_cluster_indices_offset: invalid offset: it should be >= 0 and leave enough space for all cluster indices", __FILE__, __LINE__);
             else
                 cluster_indices_offset = offset;
         }
@@ -70,6 +70,34 @@ namespace CrashAndSqueeze
                 clusters_num_offset = offset;
         }
 
+        void VertexInfo::set_cluster_indices_format(int index_size, int indices_num)
+        {
+            if( 1 != index_size && 2 != index_size && 4 != index_size )
+            {
+                Logger::error("in VertexInfo::set_cluster_indices_format: invalid index size: it should be 1, 2 or 4 bytes", __FILE__, __LINE__);
+                return;
+            }
+            if( indices_num <= 0 )
+            {
+                Logger::error("in VertexInfo::set_cluster_indices_format: number of cluster indices is less than or equal to zero", __FILE__, __LINE__);
+                return;
+            }
+            if( cluster_indices_offset + indices_num*index_size > vertex_size )
+            {
+                Logger::error("in VertexInfo::set_cluster_indices_format: not enough space for cluster indices after cluster_indices_offset", __FILE__, __LINE__);
+                return;
+            }
+            cluster_index_size = index_size;
+            cluster_indices_num = indices_num;
+        }
+
+        unsigned VertexInfo::get_max_cluster_index() const
+        {
+            if( cluster_index_size >= static_cast<int>(sizeof(unsigned)) )
+                return ~0u;
+            return (1u << 8*cluster_index_size) - 1;
+        }
+
         void VertexInfo::add_point(int offset)
         {
             add_offset(points_offsets, offset);
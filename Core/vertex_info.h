@@ -14,6 +14,7 @@ namespace CrashAndSqueeze
             // max number of points and vectors
             // associated with each vertex
             static const int MAX_COMPONENT_NUM = 10;
+            // default number of cluster indices in vertex structure
             static const int CLUSTER_INDICES_NUM = 8;
         
         private:
@@ -34,6 +35,10 @@ namespace CrashAndSqueeze
             // So this determines whether the vector is normal (true) or tangent (false).
             Collections::Array<bool> vectors_orthogonality;
 
+            // size of each cluster index in bytes (1, 2 or 4) and number of them in vertex structure
+            int cluster_index_size;
+            int cluster_indices_num;
+
             int cluster_indices_offset;
 
             int clusters_num_offset;
@@ -57,7 +62,8 @@ namespace CrashAndSqueeze
 
             // constructor for one point and no vectors associated with vertex
             VertexInfo(int vertex_size, int position_offset, int cluster_indices_offset, int clusters_num_offset)
-                : points_offsets(MAX_COMPONENT_NUM), vectors_offsets(MAX_COMPONENT_NUM)
+                : points_offsets(MAX_COMPONENT_NUM), vectors_offsets(MAX_COMPONENT_NUM),
+                  cluster_index_size(sizeof(ClusterIndex)), cluster_indices_num(CLUSTER_INDICES_NUM)
             {
                 set_vertex_size(vertex_size);
                 set_cluster_indices_offset(cluster_indices_offset);
@@ -68,7 +74,8 @@ namespace CrashAndSqueeze
             
             // constructor for one point and one vector associated with vertex
             VertexInfo(int vertex_size, int position_offset, int vector_offset, bool is_vector_orthogonal, int cluster_indices_offset, int clusters_num_offset)
-                : points_offsets(MAX_COMPONENT_NUM), vectors_offsets(MAX_COMPONENT_NUM)
+                : points_offsets(MAX_COMPONENT_NUM), vectors_offsets(MAX_COMPONENT_NUM),
+                  cluster_index_size(sizeof(ClusterIndex)), cluster_indices_num(CLUSTER_INDICES_NUM)
             {
                 set_vertex_size(vertex_size);
                 set_cluster_indices_offset(cluster_indices_offset);
@@ -82,6 +89,17 @@ namespace CrashAndSqueeze
 
             void add_vector(int offset, bool orthogonal);
 
+            // Sets how cluster indices are stored in vertex structure: `index_size' is a size of
+            // each index in bytes (1, 2 or 4 for 8-, 16- or 32-bit unsigned integers) and
+            // `indices_num' is a number of them. By default there are CLUSTER_INDICES_NUM
+            // indices of type ClusterIndex, which limits number of clusters to 255.
+            void set_cluster_indices_format(int index_size, int indices_num);
+
+            int get_cluster_index_size() const { return cluster_index_size; }
+            int get_cluster_indices_num() const { return cluster_indices_num; }
+            // maximum value that fits into a cluster index
+            unsigned get_max_cluster_index() const;
+
             int get_vertex_size() const { return vertex_size; }
             int get_cluster_indices_offset() const { return cluster_indices_offset; }
             int get_clusters_num_offset() const { return clusters_num_offset; }
@@ -0,0 +1,143 @@
+#include "core_tester.h"
+#include "Core/cluster_kernels.h"
+#include "Math/matrix.h"
+
+namespace
+{
+    // odd number of points, so that both batches and remaining points are processed
+    const int POINTS_NUM = 11;
+    const int OFFSET_SIZE = ClusterKernels::MAX_OFFSET_SIZE;
+    const int POINT_SIZE = ClusterKernels::POINT_SIZE;
+
+    class KernelsData
+    {
+    public:
+        Real weights[POINTS_NUM];
+        Real points_values[POINT_SIZE][POINTS_NUM];
+        Real offsets_values[OFFSET_SIZE][POINTS_NUM];
+        Real matrix[POINT_SIZE*OFFSET_SIZE];
+        Real center[POINT_SIZE];
+
+        const Real * points[POINT_SIZE];
+        const Real * offsets[OFFSET_SIZE];
+
+        KernelsData()
+        {
+            for(int i = 0; i < POINTS_NUM; ++i)
+            {
+                weights[i] = 1 + i%3;
+                for(int c = 0; c < POINT_SIZE; ++c)
+                    points_values[c][i] = (i*7 + c*3) % 5 - 2.5;
+                for(int k = 0; k < OFFSET_SIZE; ++k)
+                    offsets_values[k][i] = (i*5 + k*2) % 7 - 3.0;
+            }
+            for(int j = 0; j < POINT_SIZE*OFFSET_SIZE; ++j)
+                matrix[j] = (j % 4) - 1.5;
+            for(int c = 0; c < POINT_SIZE; ++c)
+            {
+                center[c] = c - 1;
+                points[c] = points_values[c];
+            }
+            for(int k = 0; k < OFFSET_SIZE; ++k)
+                offsets[k] = offsets_values[k];
+        }
+
+        Vector get_point(int i) const { return Vector(points[0][i], points[1][i], points[2][i]); }
+
+        // transforms `size` components of i'th offset by matrix
+        Vector transform_offset(int i, int size) const
+        {
+            Vector result(center[0], center[1], center[2]);
+            for(int r = 0; r < POINT_SIZE; ++r)
+                for(int k = 0; k < size; ++k)
+                    result[r] += matrix[r*size + k]*offsets[k][i];
+            return result;
+        }
+    };
+}
+
+TEST(ClusterKernelsTest, ScalarAlwaysSupported)
+{
+    EXPECT_TRUE( ClusterKernels::is_supported(ClusterKernels::SCALAR) );
+    EXPECT_TRUE( ClusterKernels::is_supported(ClusterKernels::get_best_level()) );
+    EXPECT_TRUE( NULL != ClusterKernels::get(ClusterKernels::SCALAR) );
+    EXPECT_EQ( ClusterKernels::get(ClusterKernels::get_best_level()), &ClusterKernels::get_best() );
+    EXPECT_EQ( NULL, ClusterKernels::get(ClusterKernels::LEVELS_NUM) );
+}
+
+TEST(ClusterKernelsTest, SumWeightedPoints)
+{
+    KernelsData data;
+    Vector expected = Vector::ZERO;
+    for(int i = 0; i < POINTS_NUM; ++i)
+        expected += data.weights[i]*data.get_point(i);
+
+    for(int level = 0; level < ClusterKernels::LEVELS_NUM; ++level)
+    {
+        const ClusterKernels * kernels = ClusterKernels::get(static_cast<ClusterKernels::Level>(level));
+        if(NULL == kernels)
+            continue;
+
+        Real sum[POINT_SIZE];
+        kernels->sum_weighted_points(data.weights, data.points, POINTS_NUM, sum);
+        EXPECT_EQ( expected, Vector(sum[0], sum[1], sum[2]) ) << "level " << level;
+    }
+}
+
+TEST(ClusterKernelsTest, SumOuterProducts)
+{
+    KernelsData data;
+    Vector center(data.center[0], data.center[1], data.center[2]);
+
+    for(int level = 0; level < ClusterKernels::LEVELS_NUM; ++level)
+    {
+        const ClusterKernels * kernels = ClusterKernels::get(static_cast<ClusterKernels::Level>(level));
+        if(NULL == kernels)
+            continue;
+
+        Real sum[POINT_SIZE*OFFSET_SIZE];
+        kernels->sum_outer_products(data.weights, data.points, data.center, data.offsets, OFFSET_SIZE, POINTS_NUM, sum);
+
+        // check each block of offset components as a usual matrix
+        for(int block = 0; block < OFFSET_SIZE; block += POINT_SIZE)
+        {
+            Matrix expected = Matrix::ZERO;
+            for(int i = 0; i < POINTS_NUM; ++i)
+            {
+                Vector offset(data.offsets[block][i], data.offsets[block + 1][i], data.offsets[block + 2][i]);
+                expected += Matrix( data.weights[i]*(data.get_point(i) - center), offset );
+            }
+            for(int r = 0; r < POINT_SIZE; ++r)
+                for(int k = 0; k < POINT_SIZE; ++k)
+                    EXPECT_REAL_EQ( expected.get_at(r, k), sum[r*OFFSET_SIZE + block + k] ) << "level " << level;
+        }
+    }
+}
+
+TEST(ClusterKernelsTest, TransformOffsetsAndGoalVelocities)
+{
+    KernelsData data;
+    const Real coeff = 0.5;
+
+    for(int level = 0; level < ClusterKernels::LEVELS_NUM; ++level)
+    {
+        const ClusterKernels * kernels = ClusterKernels::get(static_cast<ClusterKernels::Level>(level));
+        if(NULL == kernels)
+            continue;
+
+        Real results_values[POINT_SIZE][POINTS_NUM];
+        Real * results[POINT_SIZE] = { results_values[0], results_values[1], results_values[2] };
+
+        // only linear part of offsets
+        kernels->transform_offsets(data.matrix, data.offsets, POINT_SIZE, data.center, POINTS_NUM, results);
+        for(int i = 0; i < POINTS_NUM; ++i)
+            EXPECT_EQ( data.transform_offset(i, POINT_SIZE), Vector(results[0][i], results[1][i], results[2][i]) ) << "level " << level;
+
+        kernels->compute_goal_velocities(data.matrix, data.offsets, OFFSET_SIZE, data.center, data.points, coeff, POINTS_NUM, results);
+        for(int i = 0; i < POINTS_NUM; ++i)
+        {
+            Vector expected = coeff*(data.transform_offset(i, OFFSET_SIZE) - data.get_point(i));
+            EXPECT_EQ( expected, Vector(results[0][i], results[1][i], results[2][i]) ) << "level " << level;
+        }
+    }
+}
@@ -0,0 +1,130 @@
+#include "core_tester.h"
+#include "Core/cluster_scheduler.h"
+
+namespace
+{
+    const int CLUSTERS_NUM = 6;
+    const Real COSTS[CLUSTERS_NUM] = {300, 10, 500, 20, 30, 400};
+
+    void set_costs(ClusterScheduler &scheduler)
+    {
+        for(int i = 0; i < CLUSTERS_NUM; ++i)
+            scheduler.set_estimated_cost(i, COSTS[i]);
+    }
+
+    // checks that each cluster is scheduled exactly once
+    void check_all_scheduled(const ClusterScheduler &scheduler)
+    {
+        int times_scheduled[CLUSTERS_NUM] = {0};
+        for(int i = 0; i < scheduler.get_batches_num(); ++i)
+        {
+            for(int j = 0; j < scheduler.get_batch_size(i); ++j)
+                ++times_scheduled[scheduler.get_batch(i)[j]];
+        }
+        for(int i = 0; i < CLUSTERS_NUM; ++i)
+            EXPECT_EQ(1, times_scheduled[i]) << "cluster #" << i;
+    }
+}
+
+TEST(ClusterSchedulerTest, BatchByEstimatedCost)
+{
+    ClusterScheduler scheduler(CLUSTERS_NUM);
+    set_costs(scheduler);
+    scheduler.set_min_batch_cost(256);
+    scheduler.schedule();
+
+    // big clusters get their own tasks, longest first, and small ones are batched together
+    ASSERT_EQ(4, scheduler.get_batches_num());
+    EXPECT_EQ(1, scheduler.get_batch_size(0));
+    EXPECT_EQ(2, scheduler.get_batch(0)[0]);
+    EXPECT_EQ(5, scheduler.get_batch(1)[0]);
+    EXPECT_EQ(0, scheduler.get_batch(2)[0]);
+    ASSERT_EQ(3, scheduler.get_batch_size(3));
+    EXPECT_EQ(4, scheduler.get_batch(3)[0]);
+    EXPECT_EQ(3, scheduler.get_batch(3)[1]);
+    EXPECT_EQ(1, scheduler.get_batch(3)[2]);
+    check_all_scheduled(scheduler);
+}
+
+TEST(ClusterSchedulerTest, BatchesOrderedByCost)
+{
+    ClusterScheduler scheduler(CLUSTERS_NUM);
+    set_costs(scheduler);
+    // clusters #0 and #1 (300 each) are batched together, and their batch costs more than the biggest cluster
+    scheduler.set_estimated_cost(1, 300);
+    scheduler.set_min_batch_cost(350);
+    scheduler.schedule();
+
+    ASSERT_EQ(4, scheduler.get_batches_num());
+    ASSERT_EQ(2, scheduler.get_batch_size(0));
+    EXPECT_EQ(0, scheduler.get_batch(0)[0]);
+    EXPECT_EQ(1, scheduler.get_batch(0)[1]);
+    EXPECT_EQ(2, scheduler.get_batch(1)[0]);
+    EXPECT_EQ(5, scheduler.get_batch(2)[0]);
+    EXPECT_EQ(2, scheduler.get_batch_size(3));
+    check_all_scheduled(scheduler);
+}
+
+TEST(ClusterSchedulerTest, MinBatchCost)
+{
+    ClusterScheduler scheduler(CLUSTERS_NUM);
+    set_costs(scheduler);
+
+    scheduler.set_min_batch_cost(0);
+    scheduler.schedule();
+    EXPECT_EQ(CLUSTERS_NUM, scheduler.get_batches_num());
+    check_all_scheduled(scheduler);
+
+    scheduler.set_min_batch_cost(10000);
+    scheduler.schedule();
+    ASSERT_EQ(1, scheduler.get_batches_num());
+    EXPECT_EQ(CLUSTERS_NUM, scheduler.get_batch_size(0));
+    check_all_scheduled(scheduler);
+}
+
+TEST(ClusterSchedulerTest, MeasuredTime)
+{
+    ClusterScheduler scheduler(CLUSTERS_NUM);
+    set_costs(scheduler);
+    scheduler.set_min_batch_cost(256);
+
+    // measured times are converted to the units of estimated costs: here 1 ms is 100
+    for(int i = 0; i < CLUSTERS_NUM; ++i)
+        scheduler.set_measured_time(i, COSTS[i]/100000);
+    // cluster #1 turned out to be the longest
+    scheduler.set_measured_time(1, 0.006);
+    scheduler.schedule();
+
+    ASSERT_EQ(4, scheduler.get_batches_num());
+    EXPECT_EQ(1, scheduler.get_batch_size(0));
+    EXPECT_EQ(1, scheduler.get_batch(0)[0]);
+    EXPECT_EQ(2, scheduler.get_batch(1)[0]);
+    check_all_scheduled(scheduler);
+}
+
+TEST(ClusterSchedulerTest, InactiveClusters)
+{
+    ClusterScheduler scheduler(CLUSTERS_NUM);
+    set_costs(scheduler);
+    scheduler.set_min_batch_cost(256);
+    // the biggest clusters are sleeping
+    scheduler.set_active(2, false);
+    scheduler.set_active(5, false);
+    scheduler.schedule();
+
+    ASSERT_EQ(2, scheduler.get_batches_num());
+    EXPECT_EQ(1, scheduler.get_batch_size(0));
+    EXPECT_EQ(0, scheduler.get_batch(0)[0]);
+    EXPECT_EQ(3, scheduler.get_batch_size(1));
+
+    // nothing to schedule
+    for(int i = 0; i < CLUSTERS_NUM; ++i)
+        scheduler.set_active(i, false);
+    scheduler.schedule();
+    EXPECT_EQ(0, scheduler.get_batches_num());
+
+    for(int i = 0; i < CLUSTERS_NUM; ++i)
+        scheduler.set_active(i, true);
+    scheduler.schedule();
+    check_all_scheduled(scheduler);
+}
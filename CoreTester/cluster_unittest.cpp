@@ -34,7 +34,8 @@ TEST(ClusterTest, Creation)
 TEST(ClusterTest, AddOne)
 {
     Cluster c;
-    PhysicalVertex v(Vector(1,2,3), 12);
+    PhysicalVertexStore store(1);
+    PhysicalVertex v(store, Vector(1,2,3), 12);
     c.add_physical_vertex(v);
     
     suppress_warnings();
@@ -51,8 +52,9 @@ TEST(ClusterTest, AddOne)
 TEST(ClusterTest, AddTwo)
 {
     Cluster c;
-    PhysicalVertex u(Vector(1,1,1), 10);
-    PhysicalVertex v(Vector(4,7,10), 20);
+    PhysicalVertexStore store(2);
+    PhysicalVertex u(store, Vector(1,1,1), 10);
+    PhysicalVertex v(store, Vector(4,7,10), 20);
     c.add_physical_vertex(u);
     c.add_physical_vertex(v);
 
@@ -72,10 +74,11 @@ TEST(ClusterTest, AddTwo)
 TEST(ClusterTest, AddSeveral)
 {
     Cluster c;
-    PhysicalVertex u(Vector(0, 0, 0), 1);
-    PhysicalVertex v(Vector(0, 2, 0), 1);
-    PhysicalVertex w(Vector(2, 0, 0), 1);
-    PhysicalVertex z(Vector(2, 2, 0), 1);
+    PhysicalVertexStore store(4);
+    PhysicalVertex u(store, Vector(0, 0, 0), 1);
+    PhysicalVertex v(store, Vector(0, 2, 0), 1);
+    PhysicalVertex w(store, Vector(2, 0, 0), 1);
+    PhysicalVertex z(store, Vector(2, 2, 0), 1);
     c.add_physical_vertex(u);
     c.add_physical_vertex(v);
     c.add_physical_vertex(w);
@@ -101,13 +104,14 @@ TEST(ClusterTest, AddMany)
 {
     Cluster c;
     const int MANY = 2*Cluster::INITIAL_ALLOCATED_VERTICES_NUM+3;
+    PhysicalVertexStore store(MANY);
     PhysicalVertex v[MANY];
     
     Real total_mass = 0;
     for(int i = 0; i < MANY; ++i)
     {
-        v[i] = PhysicalVertex(Vector(0, 0, i),
-                               abs( static_cast<Real>(MANY-1)/2 - i ) );
+        v[i] = PhysicalVertex(store, Vector(0, 0, i),
+                                      abs( static_cast<Real>(MANY-1)/2 - i ) );
         c.add_physical_vertex(v[i]);
         total_mass += v[i].get_mass();
     }
@@ -2,6 +2,7 @@
 #include <gtest/gtest.h>
 #include "Core/core.h"
 #include "Math/vector.h"
+#include "Core/isurface.h"
 
 using namespace ::CrashAndSqueeze::Math;
 using namespace ::CrashAndSqueeze::Core;
@@ -12,6 +13,15 @@ inline std::ostream &operator<<(std::ostream &stream, const Vector &vector)
     return stream << "(" << vector[0] << ", " << vector[1] << ", " << vector[2] << ")";
 }
 
+// EXPECT_DOUBLE_EQ or EXPECT_FLOAT_EQ, depending on precision of Real
+#if CAS_SINGLE_PRECISION
+#define EXPECT_REAL_EQ EXPECT_FLOAT_EQ
+#define ASSERT_REAL_EQ ASSERT_FLOAT_EQ
+#else
+#define EXPECT_REAL_EQ EXPECT_DOUBLE_EQ
+#define ASSERT_REAL_EQ ASSERT_DOUBLE_EQ
+#endif // CAS_SINGLE_PRECISION
+
 class CoreTesterException {};
 
 extern CallbackAction core_tester_err_action;
@@ -39,3 +49,34 @@ inline void unsuppress_warnings()
 {
     Logger::get_instance().set_action(Logger::WARNING, old_warn_action);
 }
+
+// A surface made of an array of vertex indices, three per triangle
+class TestSurface : public ISurface
+{
+private:
+    const unsigned * indices;
+    int triangles_num;
+
+    class Iterator : public TriangleIterator
+    {
+    private:
+        const TestSurface & surface;
+        int current;
+    public:
+        Iterator(const TestSurface & surface) : surface(surface), current(0) {}
+        virtual bool has_value() const { return current < surface.triangles_num; }
+        virtual Triangle operator*() const
+        {
+            Triangle triangle;
+            for(int i = 0; i < VERTICES_PER_TRIANGLE; ++i)
+                triangle[i] = surface.indices[current*VERTICES_PER_TRIANGLE + i];
+            return triangle;
+        }
+        virtual void operator++() { ++current; }
+    };
+
+public:
+    TestSurface(const unsigned * indices, int triangles_num) : indices(indices), triangles_num(triangles_num) {}
+    virtual TriangleIterator * get_triangles() { return new Iterator(*this); }
+    virtual void destroy_iterator(TriangleIterator * iterator) { delete iterator; }
+};
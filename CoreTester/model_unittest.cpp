@@ -3,6 +3,11 @@
 #include "Core/cluster.h"
 #include "Core/physical_vertex.h"
 #include "Parallel/single_thread_prim.h"
+#include "Parallel/std_thread_prim.h"
+#include "Parallel/worker_pool.h"
+#include "Parallel/work_stealing_scheduler.h"
+#include <thread>
+#include <cstring>
 
 using namespace ::CrashAndSqueeze::Parallel;
 
@@ -55,8 +60,37 @@ namespace
             { 0xBADF00D, -1, -1, -1},
         };
 
+    // vertex with a normal
+    struct NormalVertex
+    {
+        VertexFloat x, y, z;
+        VertexFloat nx, ny, nz;
+        ClusterIndex ci[VertexInfo::CLUSTER_INDICES_NUM];
+        unsigned cn;
+    };
+
+    // vertex with 16-bit cluster indices
+    struct WideIndicesVertex
+    {
+        VertexFloat x, y, z;
+        unsigned short ci[VertexInfo::CLUSTER_INDICES_NUM];
+        unsigned cn;
+    };
+
     template<class V> Vector get_pos(V v) { return Vector(v.x, v.y, v.z); }
 
+    // Fills `vertices` with a cube of grid_size*grid_size*grid_size vertices, `scale` apart along each axis
+    // (x changes first, then y, then z)
+    template<class V> void fill_cube(V * vertices, int grid_size, Real scale = 1)
+    {
+        for(int i = 0; i < grid_size*grid_size*grid_size; ++i)
+        {
+            vertices[i].x = static_cast<VertexFloat>((i % grid_size)*scale);
+            vertices[i].y = static_cast<VertexFloat>(((i / grid_size) % grid_size)*scale);
+            vertices[i].z = static_cast<VertexFloat>((i / (grid_size*grid_size))*scale);
+        }
+    }
+
     class MyVelocitiesChangeCallback : public VelocitiesChangedCallback
     {
     private:
@@ -83,6 +117,13 @@ protected:
 
     VertexInfo vi1;
     VertexInfo vi2;
+    VertexInfo vin;
+
+    // sizes of a cube with a face, made by make_cube_with_face
+    static const int CUBE_GRID_SIZE = 8;
+    static const int CUBE_VERTICES_NUM = CUBE_GRID_SIZE*CUBE_GRID_SIZE*CUBE_GRID_SIZE;
+    static const int FACE_VERTICES_NUM = CUBE_GRID_SIZE*CUBE_GRID_SIZE;
+    static const int FACE_TRIANGLES_NUM = 2*(CUBE_GRID_SIZE - 1)*(CUBE_GRID_SIZE - 1);
 
     SingleThreadFactory prim_factory;
 
@@ -92,7 +133,8 @@ protected:
 
     ModelTest()
         : vi1( sizeof(vertices1[0]), 0, 3*sizeof(vertices1[0].x),  sizeof(vertices1[0]) - sizeof(vertices1[0].cn)),
-          vi2( sizeof(vertices2[0]), sizeof(vertices2[0].dummy), sizeof(vertices2[0].dummy) + 3*sizeof(vertices2[0].x),  sizeof(vertices2[0]) - sizeof(vertices2[0].cn) )
+          vi2( sizeof(vertices2[0]), sizeof(vertices2[0].dummy), sizeof(vertices2[0].dummy) + 3*sizeof(vertices2[0].x),  sizeof(vertices2[0]) - sizeof(vertices2[0].cn) ),
+          vin( sizeof(NormalVertex), 0, 3*sizeof(VertexFloat), true, 6*sizeof(VertexFloat), sizeof(NormalVertex) - sizeof(unsigned) )
     {}
 
     virtual void SetUp()
@@ -128,7 +170,7 @@ protected:
             if( NULL == masses )
                 ASSERT_EQ(constant_mass, v.get_mass());
             else
-                ASSERT_EQ(masses[i], v.get_mass());
+                ASSERT_EQ(static_cast<Real>(masses[i]), v.get_mass());
 
             ASSERT_GE( v.get_including_clusters_num(), 0 );
         }
@@ -139,6 +181,34 @@ protected:
         }
     }
 
+    // Fills `cube` (of CUBE_VERTICES_NUM physical vertices) with a cube of vertices, `face` (of FACE_VERTICES_NUM
+    // graphical vertices) with its upper face having given normal, and `indices` with the face split into
+    // FACE_TRIANGLES_NUM triangles
+    void make_cube_with_face(TestVertex1 * cube, NormalVertex * face, unsigned * indices, const Vector & normal)
+    {
+        fill_cube(cube, CUBE_GRID_SIZE);
+        for(int i = 0; i < FACE_VERTICES_NUM; ++i)
+        {
+            face[i].x = static_cast<VertexFloat>(i % CUBE_GRID_SIZE);
+            face[i].y = static_cast<VertexFloat>(i / CUBE_GRID_SIZE);
+            face[i].z = static_cast<VertexFloat>(CUBE_GRID_SIZE - 1);
+            face[i].nx = static_cast<VertexFloat>(normal[0]);
+            face[i].ny = static_cast<VertexFloat>(normal[1]);
+            face[i].nz = static_cast<VertexFloat>(normal[2]);
+        }
+        unsigned * index = indices;
+        for(int row = 0; row < CUBE_GRID_SIZE - 1; ++row)
+        {
+            for(int col = 0; col < CUBE_GRID_SIZE - 1; ++col)
+            {
+                unsigned v = row*CUBE_GRID_SIZE + col;
+                const unsigned square[2*ISurface::VERTICES_PER_TRIANGLE] = {v, v + 1, v + CUBE_GRID_SIZE, v + 1, v + CUBE_GRID_SIZE + 1, v + CUBE_GRID_SIZE};
+                for(int j = 0; j < 2*ISurface::VERTICES_PER_TRIANGLE; ++j)
+                    *(index++) = square[j];
+            }
+        }
+    }
+
     void compute_next_step(Model &m, const ForcesArray &forces, VelocitiesChangedCallback & vcb)
     {
         m.wait_for_step();
@@ -223,3 +293,923 @@ TEST_F(ModelTest, Hit)
     EXPECT_EQ( exp_lin_velocity, vcb.get_linear_velocity_change() );
     EXPECT_TRUE( vectors_almost_equal(exp_ang_velocity, vcb.get_angular_velocity_change(), 0.001) ) << "expected " << exp_ang_velocity << ", got " << vcb.get_angular_velocity_change();
 }
+
+TEST_F(ModelTest, HitWithRotationExtraction)
+{
+    Model polar(stick, STICK_VERTICES_NUM, vi1, stick, STICK_VERTICES_NUM, vi1, CLUSTERS_BY_AXES, PADDING, 4, NULL, &prim_factory);
+    Model extraction(stick, STICK_VERTICES_NUM, vi1, stick, STICK_VERTICES_NUM, vi1, CLUSTERS_BY_AXES, PADDING, 4, NULL, &prim_factory);
+    SimulationParams params;
+    params.set_defaults();
+    params.rotation_extraction_iterations = DEFAULT_ROTATION_EXTRACTION_ITERATIONS;
+    extraction.set_simulation_params(params);
+
+    ForcesArray empty(0);
+    const Vector hit_velocity(0, 1, 0);
+    polar.hit( SphericalRegion( Vector(0,0,0), 0.1 ), hit_velocity);
+    extraction.hit( SphericalRegion( Vector(0,0,0), 0.1 ), hit_velocity);
+    for(int step = 0; step < 5; ++step)
+    {
+        compute_next_step(polar, empty, vcb);
+        compute_next_step(extraction, empty, vcb);
+    }
+
+    const Matrix & expected = polar.get_cluster(0).get_rotation();
+    const Matrix & rotation = extraction.get_cluster(0).get_rotation();
+    EXPECT_FALSE( Matrix::IDENTITY == rotation );
+    for(int i = 0; i < MATRIX_ELEMENTS_NUM; ++i)
+    {
+        EXPECT_NEAR( expected.get_at_index(i), rotation.get_at_index(i), 0.0001 );
+    }
+}
+
+TEST_F(ModelTest, HitWithWorkerPool)
+{
+    Model m(stick, STICK_VERTICES_NUM, vi1, stick, STICK_VERTICES_NUM, vi1, CLUSTERS_BY_AXES, PADDING, 4, NULL, &StdThreadFactory::instance);
+    WorkerPool pool;
+    pool.add_executor(&m);
+    pool.start(4);
+
+    const Vector hit_velocity(0, 1, 0);
+    const Vector exp_lin_velocity(0, 0.5, 0);
+    const Vector exp_ang_velocity(0.5, 0, 0);
+
+    ForcesArray empty(0);
+    m.hit( SphericalRegion( Vector(0,0,0), 0.1 ), hit_velocity);
+    m.compute_next_step_async(empty, dt, &vcb);
+    EXPECT_TRUE( m.wait_for_step() );
+    pool.stop();
+
+    EXPECT_EQ( exp_lin_velocity, vcb.get_linear_velocity_change() );
+    EXPECT_TRUE( vectors_almost_equal(exp_ang_velocity, vcb.get_angular_velocity_change(), 0.001) ) << "expected " << exp_ang_velocity << ", got " << vcb.get_angular_velocity_change();
+}
+
+TEST_F(ModelTest, ClustersFoundInGrid)
+{
+    const int GRID_SIZE = 10;
+    const int GRID_VERTICES_NUM = GRID_SIZE*GRID_SIZE*GRID_SIZE;
+    const int GRID_CLUSTERS_BY_AXES[VECTOR_SIZE] = {3, 2, 4};
+    const int GRID_CLUSTERS_NUM = 3*2*4;
+    const Real GRID_PADDING = 0.25;
+    // graphical vertices: the same and one more outside all clusters
+    TestVertex1 * grid = new TestVertex1[GRID_VERTICES_NUM + 1];
+    fill_cube(grid, GRID_SIZE);
+    TestVertex1 & outside = grid[GRID_VERTICES_NUM];
+    outside.x = 20;
+    outside.y = -5;
+    outside.z = 4.5f;
+
+    Model m(grid, GRID_VERTICES_NUM, vi1, grid, GRID_VERTICES_NUM + 1, vi1, GRID_CLUSTERS_BY_AXES, GRID_PADDING, 1, NULL, &prim_factory);
+    ASSERT_EQ(GRID_CLUSTERS_NUM, m.get_clusters_num());
+
+    // check against all regions, built the same way as by Model
+    const Vector sizes(Real(GRID_SIZE - 1)/3, Real(GRID_SIZE - 1)/2, Real(GRID_SIZE - 1)/4);
+    const Vector padding = sizes*GRID_PADDING;
+    int expected_counts[GRID_CLUSTERS_NUM] = {0};
+    int nearest_index = -1;
+    Real min_distance = MAX_REAL;
+    for(int i = 0; i < GRID_CLUSTERS_NUM; ++i)
+    {
+        Vector min_corner = Vector((i/8)*sizes[0], ((i/4) % 2)*sizes[1], (i % 4)*sizes[2]) - padding;
+        BoxRegion region(min_corner, min_corner + sizes + 2*padding);
+        for(int j = 0; j < GRID_VERTICES_NUM; ++j)
+        {
+            if( region.contains(get_pos(grid[j])) )
+                ++expected_counts[i];
+        }
+        Real dst = distance(get_pos(outside), region.get_center());
+        if(dst < min_distance)
+        {
+            min_distance = dst;
+            nearest_index = i;
+        }
+    }
+
+    for(int i = 0; i < GRID_CLUSTERS_NUM; ++i)
+    {
+        EXPECT_EQ(expected_counts[i], m.get_cluster(i).get_physical_vertices_num()) << "cluster #" << i;
+        EXPECT_EQ(expected_counts[i] + (i == nearest_index ? 1 : 0), m.get_cluster(i).get_graphical_vertices_num()) << "cluster #" << i;
+    }
+    EXPECT_EQ(1, outside.cn);
+    EXPECT_EQ(nearest_index, static_cast<int>(outside.ci[0]));
+    delete[] grid;
+}
+
+TEST_F(ModelTest, BalancedClustering)
+{
+    const int GRID_SIZE = 10;
+    const int GRID_VERTICES_NUM = GRID_SIZE*GRID_SIZE*GRID_SIZE;
+    const int GRID_CLUSTERS_BY_AXES[VECTOR_SIZE] = {2, 2, 2};
+    const int GRID_CLUSTERS_NUM = 2*2*2;
+    const Real GRID_PADDING = 0.1;
+    // vertices are much denser near the origin
+    TestVertex1 * grid = new TestVertex1[GRID_VERTICES_NUM];
+    fill_cube(grid, GRID_SIZE);
+    for(int i = 0; i < GRID_VERTICES_NUM; ++i)
+    {
+        grid[i].x *= grid[i].x;
+        grid[i].y *= grid[i].y;
+        grid[i].z *= grid[i].z;
+    }
+
+    Model uniform(grid, GRID_VERTICES_NUM, vi1, grid, GRID_VERTICES_NUM, vi1, GRID_CLUSTERS_BY_AXES, GRID_PADDING, 1, NULL, &prim_factory);
+    Model balanced(grid, GRID_VERTICES_NUM, vi1, grid, GRID_VERTICES_NUM, vi1, GRID_CLUSTERS_BY_AXES, GRID_PADDING, 1, NULL, &prim_factory, BALANCED_CLUSTERING);
+    ASSERT_EQ(GRID_CLUSTERS_NUM, balanced.get_clusters_num());
+
+    int uniform_max = 0;
+    int balanced_min = GRID_VERTICES_NUM;
+    int balanced_max = 0;
+    for(int i = 0; i < GRID_CLUSTERS_NUM; ++i)
+    {
+        uniform_max = maximum(uniform_max, uniform.get_cluster(i).get_physical_vertices_num());
+        balanced_min = minimum(balanced_min, balanced.get_cluster(i).get_physical_vertices_num());
+        balanced_max = maximum(balanced_max, balanced.get_cluster(i).get_physical_vertices_num());
+        EXPECT_EQ(balanced.get_cluster(i).get_physical_vertices_num(), balanced.get_cluster(i).get_graphical_vertices_num()) << "cluster #" << i;
+    }
+    // each half along an axis contains 5 or 6 (with padding) of 10 coordinates, instead of 7 and 3
+    EXPECT_EQ(5*5*5, balanced_min);
+    EXPECT_EQ(6*6*6, balanced_max);
+    EXPECT_EQ(7*7*7, uniform_max);
+
+    for(int i = 0; i < GRID_VERTICES_NUM; ++i)
+        EXPECT_LE(1, balanced.get_vertex(i).get_including_clusters_num());
+
+    ForcesArray empty(0);
+    balanced.hit( SphericalRegion( Vector(0,0,0), 0.1 ), Vector(0, 0, 1) );
+    EXPECT_NO_THROW( compute_next_step(balanced, empty, vcb) );
+    EXPECT_NE( get_pos(grid[0]), balanced.get_vertex(0).get_pos() );
+    delete[] grid;
+}
+
+TEST_F(ModelTest, BalancedClusteringWithEqualCoordinates)
+{
+    const int GRID_SIZE = 4;
+    const int GRID_VERTICES_NUM = GRID_SIZE*GRID_SIZE*GRID_SIZE;
+    // more clusters along x than there are different x coordinates: some cells are empty
+    const int GRID_CLUSTERS_BY_AXES[VECTOR_SIZE] = {4, 1, 1};
+    const Real GRID_PADDING = 0.1;
+    TestVertex1 * grid = new TestVertex1[GRID_VERTICES_NUM];
+    fill_cube(grid, GRID_SIZE);
+    for(int i = 0; i < GRID_VERTICES_NUM; ++i)
+        grid[i].x = static_cast<VertexFloat>(static_cast<int>(grid[i].x) / 2);
+
+    Model balanced(grid, GRID_VERTICES_NUM, vi1, grid, GRID_VERTICES_NUM, vi1, GRID_CLUSTERS_BY_AXES, GRID_PADDING, 1, NULL, &prim_factory, BALANCED_CLUSTERING);
+    ASSERT_EQ(4, balanced.get_clusters_num());
+
+    ForcesArray empty(0);
+    balanced.hit( SphericalRegion( Vector(0,0,0), 0.1 ), Vector(0, 0, 1) );
+    EXPECT_NO_THROW( compute_next_step(balanced, empty, vcb) );
+
+    // weights of empty cells are not NaN, so graphical vertices stay near their places
+    TestVertex1 * updated = new TestVertex1[GRID_VERTICES_NUM];
+    balanced.update_vertices(updated, vi1);
+    for(int i = 0; i < GRID_VERTICES_NUM; ++i)
+        EXPECT_GT(1, distance(get_pos(grid[i]), get_pos(updated[i]))) << "vertex #" << i;
+    delete[] updated;
+    delete[] grid;
+}
+
+TEST_F(ModelTest, ManyClustersWithWideIndices)
+{
+    const int GRID_SIZE = 8;
+    const int GRID_VERTICES_NUM = GRID_SIZE*GRID_SIZE*GRID_SIZE;
+    // more clusters than 8-bit indices allow
+    const int GRID_CLUSTERS_BY_AXES[VECTOR_SIZE] = {8, 8, 5};
+    const int GRID_CLUSTERS_NUM = 8*8*5;
+    // big padding: inner vertices belong to more than CLUSTER_INDICES_NUM clusters
+    const Real GRID_PADDING = 1;
+    WideIndicesVertex * grid = new WideIndicesVertex[GRID_VERTICES_NUM];
+    fill_cube(grid, GRID_SIZE);
+
+    VertexInfo wide_vi( sizeof(grid[0]), 0, 3*sizeof(grid[0].x), sizeof(grid[0]) - sizeof(grid[0].cn) );
+    wide_vi.set_cluster_indices_format(sizeof(grid[0].ci[0]), VertexInfo::CLUSTER_INDICES_NUM);
+    EXPECT_EQ( 0xFFFFu, wide_vi.get_max_cluster_index() );
+
+    suppress_warnings();
+    Model m(grid, GRID_VERTICES_NUM, wide_vi, grid, GRID_VERTICES_NUM, wide_vi, GRID_CLUSTERS_BY_AXES, GRID_PADDING, 1, NULL, &prim_factory);
+    unsuppress_warnings();
+    ASSERT_EQ(GRID_CLUSTERS_NUM, m.get_clusters_num());
+
+    int max_clusters_num = 0;
+    for(int i = 0; i < GRID_VERTICES_NUM; ++i)
+    {
+        int clusters_num = m.get_vertex(i).get_including_clusters_num();
+        max_clusters_num = maximum(max_clusters_num, clusters_num);
+
+        // indices that don't fit into vertex are skipped, the rest is padded with null index
+        ASSERT_EQ( static_cast<unsigned>(minimum(clusters_num, VertexInfo::CLUSTER_INDICES_NUM)), grid[i].cn );
+        for(int j = 0; j < VertexInfo::CLUSTER_INDICES_NUM; ++j)
+        {
+            if(j < static_cast<int>(grid[i].cn))
+                EXPECT_GT( GRID_CLUSTERS_NUM, static_cast<int>(grid[i].ci[j]) );
+            else
+                EXPECT_EQ( GRID_CLUSTERS_NUM, static_cast<int>(grid[i].ci[j]) );
+        }
+    }
+    EXPECT_GT( max_clusters_num, VertexInfo::CLUSTER_INDICES_NUM );
+
+    ForcesArray empty(0);
+    m.hit( SphericalRegion( Vector(0,0,0), 0.1 ), Vector(0, 0, 1) );
+    EXPECT_NO_THROW( compute_next_step(m, empty, vcb) );
+    EXPECT_NE( get_pos(grid[0]), m.get_vertex(0).get_pos() );
+
+    // 8-bit indices cannot index that many clusters
+    TestVertex1 * narrow_grid = new TestVertex1[GRID_VERTICES_NUM];
+    for(int i = 0; i < GRID_VERTICES_NUM; ++i)
+    {
+        narrow_grid[i].x = grid[i].x;
+        narrow_grid[i].y = grid[i].y;
+        narrow_grid[i].z = grid[i].z;
+    }
+    EXPECT_THROW( Model(narrow_grid, GRID_VERTICES_NUM, vi1, narrow_grid, GRID_VERTICES_NUM, vi1, GRID_CLUSTERS_BY_AXES, GRID_PADDING, 1, NULL, &prim_factory), CoreTesterException );
+
+    delete[] narrow_grid;
+    delete[] grid;
+}
+
+TEST_F(ModelTest, HitLargeModelWithWorkerPool)
+{
+    // a model big enough to be integrated in several parts
+    const int GRID_SIZE = 16;
+    const int GRID_VERTICES_NUM = GRID_SIZE*GRID_SIZE*GRID_SIZE;
+    const int GRID_CLUSTERS_BY_AXES[VECTOR_SIZE] = {2, 2, 2};
+    TestVertex1 * grid = new TestVertex1[GRID_VERTICES_NUM];
+    fill_cube(grid, GRID_SIZE);
+
+    Model parallel_model(grid, GRID_VERTICES_NUM, vi1, grid, GRID_VERTICES_NUM, vi1, GRID_CLUSTERS_BY_AXES, PADDING, 1, NULL, &StdThreadFactory::instance);
+    Model serial_model(grid, GRID_VERTICES_NUM, vi1, grid, GRID_VERTICES_NUM, vi1, GRID_CLUSTERS_BY_AXES, PADDING, 1, NULL, &prim_factory);
+    WorkerPool pool;
+    pool.add_executor(&parallel_model);
+    pool.start(4);
+
+    // hit the whole plane z == 0
+    const Vector hit_velocity(0, 0, 1);
+    const Vector exp_lin_velocity = hit_velocity/GRID_SIZE;
+    const BoxRegion hit_region( Vector(-1, -1, -0.5), Vector(GRID_SIZE, GRID_SIZE, 0.5) );
+
+    ForcesArray empty(0);
+    MyVelocitiesChangeCallback serial_vcb;
+    parallel_model.hit(hit_region, hit_velocity);
+    serial_model.hit(hit_region, hit_velocity);
+    parallel_model.compute_next_step_async(empty, dt, &vcb);
+    EXPECT_TRUE( parallel_model.wait_for_step() );
+    EXPECT_NO_THROW( compute_next_step(serial_model, empty, serial_vcb) );
+    pool.stop();
+
+    EXPECT_TRUE( vectors_almost_equal(exp_lin_velocity, vcb.get_linear_velocity_change(), 0.001) ) << "expected " << exp_lin_velocity << ", got " << vcb.get_linear_velocity_change();
+    // parts are combined in fixed order, so the result doesn't depend on threads
+    EXPECT_EQ( serial_vcb.get_linear_velocity_change(), vcb.get_linear_velocity_change() );
+    for(int i = 0; i < GRID_VERTICES_NUM; ++i)
+        EXPECT_EQ( serial_model.get_vertex(i).get_pos(), parallel_model.get_vertex(i).get_pos() );
+    delete[] grid;
+}
+
+TEST_F(ModelTest, UpdateVerticesAsyncWithWorkerPool)
+{
+    Model m(stick, STICK_VERTICES_NUM, vi1, stick, STICK_VERTICES_NUM, vi1, CLUSTERS_BY_AXES, PADDING, 4, NULL, &StdThreadFactory::instance);
+    WorkerPool pool;
+    pool.add_executor(&m);
+    pool.start(4);
+
+    ForcesArray empty(0);
+    m.hit( SphericalRegion( Vector(0,0,0), 0.1 ), Vector(0, 1, 0));
+    m.compute_next_step_async(empty, dt, &vcb);
+    EXPECT_TRUE( m.wait_for_step() );
+
+    TestVertex1 updated[STICK_VERTICES_NUM];
+    TestVertex1 expected[STICK_VERTICES_NUM];
+    m.update_vertices_async(updated, vi1);
+    EXPECT_TRUE( m.wait_for_update() );
+    pool.stop();
+
+    m.update_vertices(expected, vi1);
+    for(int i = 0; i < STICK_VERTICES_NUM; ++i)
+        EXPECT_EQ( get_pos(expected[i]), get_pos(updated[i]) );
+}
+
+TEST_F(ModelTest, GenerateNormalsAsyncWithWorkerPool)
+{
+    // physical vertices fill a cube, graphical ones are its upper face with normals, split into triangles
+    const int GRID_SIZE = CUBE_GRID_SIZE;
+    const int PHYSICAL_VERTICES_NUM = CUBE_VERTICES_NUM;
+    const int GRAPHICAL_VERTICES_NUM = FACE_VERTICES_NUM;
+    TestVertex1 * cube = new TestVertex1[PHYSICAL_VERTICES_NUM];
+    NormalVertex face[GRAPHICAL_VERTICES_NUM];
+    unsigned indices[FACE_TRIANGLES_NUM*ISurface::VERTICES_PER_TRIANGLE];
+    // normals are deliberately tilted: they must be regenerated from the surface
+    make_cube_with_face(cube, face, indices, Vector(0.6, 0, 0.8));
+    TestSurface surface(indices, FACE_TRIANGLES_NUM);
+
+    const int GRID_CLUSTERS_BY_AXES[VECTOR_SIZE] = {2, 2, 2};
+    Model parallel_model(cube, PHYSICAL_VERTICES_NUM, vi1, face, GRAPHICAL_VERTICES_NUM, vin, GRID_CLUSTERS_BY_AXES, PADDING, 1, NULL, &StdThreadFactory::instance);
+    Model serial_model(cube, PHYSICAL_VERTICES_NUM, vi1, face, GRAPHICAL_VERTICES_NUM, vin, GRID_CLUSTERS_BY_AXES, PADDING, 1, NULL, &prim_factory);
+    parallel_model.set_graphical_surface(&surface);
+    serial_model.set_graphical_surface(&surface);
+
+    WorkerPool pool;
+    pool.add_executor(&parallel_model);
+    pool.start(4);
+
+    ForcesArray empty(0);
+    MyVelocitiesChangeCallback serial_vcb;
+    const SphericalRegion hit_region( Vector(3, 3, GRID_SIZE - 1), 1.5 );
+    parallel_model.hit(hit_region, Vector(0, 0, -1));
+    serial_model.hit(hit_region, Vector(0, 0, -1));
+    parallel_model.compute_next_step_async(empty, dt, &vcb);
+    EXPECT_TRUE( parallel_model.wait_for_step() );
+    EXPECT_NO_THROW( compute_next_step(serial_model, empty, serial_vcb) );
+
+    NormalVertex updated[GRAPHICAL_VERTICES_NUM];
+    NormalVertex expected[GRAPHICAL_VERTICES_NUM];
+    parallel_model.update_vertices_async(updated, vin);
+    EXPECT_TRUE( parallel_model.wait_for_update() );
+    pool.stop();
+
+    serial_model.update_vertices(expected, vin);
+    serial_model.generate_normals();
+    serial_model.update_vertices_vectors(expected, vin);
+
+    for(int i = 0; i < GRAPHICAL_VERTICES_NUM; ++i)
+    {
+        Vector normal(updated[i].nx, updated[i].ny, updated[i].nz);
+        EXPECT_EQ( Vector(expected[i].nx, expected[i].ny, expected[i].nz), normal );
+        // the face is hardly bent after one step
+        EXPECT_GT( normal[2], 0.99 ) << "normal of vertex " << i << " is " << normal;
+    }
+    delete[] cube;
+}
+
+TEST_F(ModelTest, UpdateChangedVertices)
+{
+    // the same cube and face as in GenerateNormalsAsyncWithWorkerPool
+    const int GRID_SIZE = CUBE_GRID_SIZE;
+    const int PHYSICAL_VERTICES_NUM = CUBE_VERTICES_NUM;
+    const int GRAPHICAL_VERTICES_NUM = FACE_VERTICES_NUM;
+    TestVertex1 * cube = new TestVertex1[PHYSICAL_VERTICES_NUM];
+    NormalVertex face[GRAPHICAL_VERTICES_NUM];
+    unsigned indices[FACE_TRIANGLES_NUM*ISurface::VERTICES_PER_TRIANGLE];
+    make_cube_with_face(cube, face, indices, Vector(0, 0, 1));
+    TestSurface surface(indices, FACE_TRIANGLES_NUM);
+
+    const int GRID_CLUSTERS_BY_AXES[VECTOR_SIZE] = {4, 4, 2};
+    Model m(cube, PHYSICAL_VERTICES_NUM, vi1, face, GRAPHICAL_VERTICES_NUM, vin, GRID_CLUSTERS_BY_AXES, PADDING, 1, NULL, &prim_factory);
+    m.set_graphical_surface(&surface);
+
+    // graphical transformations are computed on the first step
+    ForcesArray empty(0);
+    EXPECT_NO_THROW( compute_next_step(m, empty, vcb) );
+    NormalVertex updated[GRAPHICAL_VERTICES_NUM];
+    NormalVertex expected[GRAPHICAL_VERTICES_NUM];
+    m.update_vertices(updated, vin);
+    m.generate_normals();
+    m.update_vertices_vectors(updated, vin);
+
+    // nothing has changed since the full update
+    VertexRangesArray ranges;
+    EXPECT_EQ( 0, m.update_changed_vertices(updated, vin, true, ranges) );
+    EXPECT_EQ( 0, ranges.size() );
+
+    m.hit(SphericalRegion(Vector(0, 0, GRID_SIZE - 1), 1), Vector(0, 0, -1));
+    for(int i = 0; i < 2; ++i)
+        EXPECT_NO_THROW( compute_next_step(m, empty, vcb) );
+
+    // changes below epsilon are ignored
+    Real epsilon = m.get_update_epsilon();
+    m.set_update_epsilon(1e6);
+    EXPECT_EQ( 0, m.update_changed_vertices(updated, vin, true, ranges) );
+    m.set_update_epsilon(epsilon);
+
+    int updated_num = m.update_changed_vertices(updated, vin, true, ranges);
+    EXPECT_GT( updated_num, 0 );
+    int ranges_vertices_num = 0;
+    for(int r = 0; r < ranges.size(); ++r)
+    {
+        EXPECT_GT( ranges[r].vertices_num, 0 );
+        ranges_vertices_num += ranges[r].vertices_num;
+    }
+    EXPECT_EQ( updated_num, ranges_vertices_num );
+
+    // the result is the same as of the full update
+    m.update_vertices(expected, vin);
+    m.generate_normals();
+    m.update_vertices_vectors(expected, vin);
+    for(int i = 0; i < GRAPHICAL_VERTICES_NUM; ++i)
+    {
+        EXPECT_EQ( Vector(expected[i].x, expected[i].y, expected[i].z), Vector(updated[i].x, updated[i].y, updated[i].z) ) << "vertex " << i;
+        EXPECT_EQ( Vector(expected[i].nx, expected[i].ny, expected[i].nz), Vector(updated[i].nx, updated[i].ny, updated[i].nz) ) << "vertex " << i;
+    }
+    delete[] cube;
+}
+
+TEST_F(ModelTest, SleepingClusters)
+{
+    const int GRID_SIZE = 8;
+    const int VERTICES_NUM = GRID_SIZE*GRID_SIZE*GRID_SIZE;
+    TestVertex1 * cube = new TestVertex1[VERTICES_NUM];
+    fill_cube(cube, GRID_SIZE);
+    const int GRID_CLUSTERS_BY_AXES[VECTOR_SIZE] = {4, 4, 4};
+    Model m(cube, VERTICES_NUM, vi1, cube, VERTICES_NUM, vi1, GRID_CLUSTERS_BY_AXES, PADDING, 1, NULL, &prim_factory);
+    const int SLEEP_STEPS = 3;
+    SimulationParams params;
+    params.set_defaults();
+    params.sleep_steps = SLEEP_STEPS;
+    m.set_simulation_params(params);
+
+    // the cube is at rest, so all clusters fall asleep after SLEEP_STEPS steps
+    ForcesArray empty(0);
+    for(int step = 0; step < SLEEP_STEPS; ++step)
+    {
+        EXPECT_EQ( 0, m.get_sleeping_clusters_num() );
+        EXPECT_NO_THROW( compute_next_step(m, empty, vcb) );
+    }
+    EXPECT_EQ( m.get_clusters_num(), m.get_sleeping_clusters_num() );
+
+    // and the step is computed without them
+    EXPECT_NO_THROW( compute_next_step(m, empty, vcb) );
+    EXPECT_TRUE( m.wait_for_step() );
+    EXPECT_EQ( m.get_clusters_num(), m.get_sleeping_clusters_num() );
+    EXPECT_EQ( Vector(1, 1, 1), m.get_vertex_current_pos(GRID_SIZE*GRID_SIZE + GRID_SIZE + 1) );
+
+    // a hit wakes up clusters of the corner and their neighbours, but not the far ones
+    m.hit(SphericalRegion(Vector(0, 0, 0), 0.5), Vector(0, 0, 1));
+    EXPECT_NO_THROW( compute_next_step(m, empty, vcb) );
+    int sleeping_num = m.get_sleeping_clusters_num();
+    EXPECT_GT( sleeping_num, 0 );
+    EXPECT_LT( sleeping_num, m.get_clusters_num() );
+    EXPECT_FALSE( m.get_cluster(0).is_sleeping() );
+    EXPECT_TRUE( m.get_cluster(m.get_clusters_num() - 1).is_sleeping() );
+
+    // a force applied to the far corner wakes up clusters there
+    ForcesArray forces;
+    PointForce force(Vector(0, 0, 1), Vector(GRID_SIZE - 1, GRID_SIZE - 1, GRID_SIZE - 1), 0.5);
+    forces.push_back(&force);
+    EXPECT_NO_THROW( compute_next_step(m, forces, vcb) );
+    EXPECT_FALSE( m.get_cluster(m.get_clusters_num() - 1).is_sleeping() );
+
+    delete[] cube;
+}
+
+TEST_F(ModelTest, SleepingClustersUnderGravity)
+{
+    const int GRID_SIZE = 6;
+    const int VERTICES_NUM = GRID_SIZE*GRID_SIZE*GRID_SIZE;
+    TestVertex1 * cube = new TestVertex1[VERTICES_NUM];
+    fill_cube(cube, GRID_SIZE);
+    const int GRID_CLUSTERS_BY_AXES[VECTOR_SIZE] = {3, 3, 3};
+    Model m(cube, VERTICES_NUM, vi1, cube, VERTICES_NUM, vi1, GRID_CLUSTERS_BY_AXES, PADDING, 1, NULL, &prim_factory);
+    const int SLEEP_STEPS = 3;
+    SimulationParams params;
+    params.set_defaults();
+    params.sleep_steps = SLEEP_STEPS;
+    m.set_simulation_params(params);
+
+    // the cube starts at rest and gravity moves it as a whole without deforming, so all clusters fall asleep
+    ForcesArray forces;
+    UniformForce gravity(Vector(0, 0, -10));
+    forces.push_back(&gravity);
+    for(int step = 0; step < SLEEP_STEPS; ++step)
+    {
+        EXPECT_EQ( 0, m.get_sleeping_clusters_num() );
+        EXPECT_NO_THROW( compute_next_step(m, forces, vcb) );
+    }
+    EXPECT_EQ( m.get_clusters_num(), m.get_sleeping_clusters_num() );
+
+    // and gravity doesn't wake them up (while the cube keeps its shape)
+    const int CORNER = 0, OPPOSITE_CORNER = VERTICES_NUM - 1;
+    Vector diagonal = m.get_vertex_current_pos(OPPOSITE_CORNER) - m.get_vertex_current_pos(CORNER);
+    for(int step = 0; step < 2*SLEEP_STEPS; ++step)
+    {
+        EXPECT_NO_THROW( compute_next_step(m, forces, vcb) );
+        EXPECT_EQ( m.get_clusters_num(), m.get_sleeping_clusters_num() );
+    }
+    EXPECT_EQ( diagonal, m.get_vertex_current_pos(OPPOSITE_CORNER) - m.get_vertex_current_pos(CORNER) );
+
+    delete[] cube;
+}
+
+namespace
+{
+    // a region without a bounding box, so that all vertices are checked
+    class UnboundedRegion : public IRegion
+    {
+    private:
+        const IRegion & region;
+    public:
+        UnboundedRegion(const IRegion & region) : region(region) {}
+        virtual Vector get_center() const { return region.get_center(); }
+        virtual bool contains(const Vector &point) const { return region.contains(point); }
+        virtual void move(const Vector &) {}
+    };
+}
+
+TEST_F(ModelTest, HitBoundedRegion)
+{
+    const int GRID_SIZE = 8;
+    const int VERTICES_NUM = GRID_SIZE*GRID_SIZE*GRID_SIZE;
+    TestVertex1 * cube = new TestVertex1[VERTICES_NUM];
+    fill_cube(cube, GRID_SIZE);
+    const int GRID_CLUSTERS_BY_AXES[VECTOR_SIZE] = {2, 2, 2};
+    Model bounded(cube, VERTICES_NUM, vi1, cube, VERTICES_NUM, vi1, GRID_CLUSTERS_BY_AXES, PADDING, 1, NULL, &prim_factory);
+    Model unbounded(cube, VERTICES_NUM, vi1, cube, VERTICES_NUM, vi1, GRID_CLUSTERS_BY_AXES, PADDING, 1, NULL, &prim_factory);
+
+    // hits between steps (when vertices have moved) must find the same vertices
+    ForcesArray empty(0);
+    const SphericalRegion sphere(Vector(2, 3, 4), 1.5);
+    const CylindricalRegion cylinder(Vector(7, 7, 7), Vector(5, 6, 0), 1);
+    const BoxRegion box(Vector(-1, -1, 6), Vector(3, 9, 9));
+    const IRegion * regions[] = {&sphere, &cylinder, &box};
+    for(int i = 0; i < 3; ++i)
+    {
+        bounded.hit(*regions[i], Vector(0, 1, -1));
+        unbounded.hit(UnboundedRegion(*regions[i]), Vector(0, 1, -1));
+        compute_next_step(bounded, empty, vcb);
+        compute_next_step(unbounded, empty, vcb);
+    }
+
+    for(int i = 0; i < VERTICES_NUM; ++i)
+    {
+        EXPECT_EQ( unbounded.get_vertex(i).get_velocity(), bounded.get_vertex(i).get_velocity() ) << "vertex #" << i;
+        EXPECT_EQ( unbounded.get_vertex_current_pos(i), bounded.get_vertex_current_pos(i) ) << "vertex #" << i;
+    }
+    EXPECT_FALSE( Vector::ZERO == bounded.get_vertex(0).get_velocity() );
+    delete[] cube;
+}
+
+TEST_F(ModelTest, HitManyModelsWithScheduler)
+{
+    const int MODELS_NUM = 4;
+    WorkStealingScheduler scheduler(3);
+    Model * models[MODELS_NUM];
+    MyVelocitiesChangeCallback callbacks[MODELS_NUM];
+    for(int i = 0; i < MODELS_NUM; ++i)
+        models[i] = new Model(stick, STICK_VERTICES_NUM, vi1, stick, STICK_VERTICES_NUM, vi1, CLUSTERS_BY_AXES, PADDING, 4, NULL, &scheduler);
+    scheduler.start();
+
+    const Vector hit_velocity(0, 1, 0);
+    const Vector exp_lin_velocity(0, 0.5, 0);
+    const Vector exp_ang_velocity(0.5, 0, 0);
+
+    ForcesArray empty(0);
+    for(int i = 0; i < MODELS_NUM; ++i)
+    {
+        models[i]->hit( SphericalRegion( Vector(0,0,0), 0.1 ), hit_velocity);
+        models[i]->compute_next_step_async(empty, dt, &callbacks[i]);
+    }
+    for(int i = 0; i < MODELS_NUM; ++i)
+        EXPECT_TRUE( models[i]->wait_for_step() );
+    scheduler.stop();
+
+    for(int i = 0; i < MODELS_NUM; ++i)
+    {
+        EXPECT_EQ( exp_lin_velocity, callbacks[i].get_linear_velocity_change() );
+        EXPECT_TRUE( vectors_almost_equal(exp_ang_velocity, callbacks[i].get_angular_velocity_change(), 0.001) ) << "expected " << exp_ang_velocity << ", got " << callbacks[i].get_angular_velocity_change();
+        delete models[i];
+    }
+}
+
+namespace
+{
+    // reactions remembering how many times and with what they were invoked
+    class CountingShapeReaction : public ShapeDeformationReaction
+    {
+    public:
+        int invoked_num;
+        int last_vertex_index;
+        Real last_distance;
+        std::thread::id last_thread;
+
+        CountingShapeReaction(const IndexArray & shape, Real threshold)
+            : ShapeDeformationReaction(shape, threshold), invoked_num(0), last_vertex_index(-1), last_distance(0) {}
+        virtual void invoke(int vertex_index, Real distance)
+        {
+            ++invoked_num;
+            last_vertex_index = vertex_index;
+            last_distance = distance;
+            last_thread = std::this_thread::get_id();
+        }
+    };
+
+    class CountingRegionReaction : public RegionReaction
+    {
+    public:
+        int invoked_num;
+        int last_vertex_index;
+
+        CountingRegionReaction(const IndexArray & shape, const IRegion & region, bool on_entering)
+            : RegionReaction(shape, region, on_entering), invoked_num(0), last_vertex_index(-1) {}
+        virtual void invoke(int vertex_index) { ++invoked_num; last_vertex_index = vertex_index; }
+    };
+
+    class CountingStretchReaction : public StretchReaction
+    {
+    public:
+        int invoked_num;
+        Real last_distance;
+
+        CountingStretchReaction(int index1, int index2, Real threshold)
+            : StretchReaction(index1, index2, threshold), invoked_num(0), last_distance(0) {}
+        virtual void invoke(Real distance) { ++invoked_num; last_distance = distance; }
+    };
+}
+
+TEST_F(ModelTest, BatchedReactions)
+{
+    Model m(stick, STICK_VERTICES_NUM, vi1, stick, STICK_VERTICES_NUM, vi1, CLUSTERS_BY_AXES, PADDING, 4, NULL, &prim_factory);
+    // not coplanar vertices, so that the frame can rotate
+    IndexArray stick_frame;
+    stick_frame.push_back(0);
+    stick_frame.push_back(1);
+    stick_frame.push_back(2);
+    stick_frame.push_back(4);
+    m.set_frame(stick_frame);
+
+    IndexArray whole_stick;
+    for(int i = 0; i < STICK_VERTICES_NUM; ++i)
+        whole_stick.push_back(i);
+    IndexArray top;
+    for(int i = STICK_VERTICES_NUM/2; i < STICK_VERTICES_NUM; ++i)
+        top.push_back(i);
+
+    const SphericalRegion bottom_region(Vector(0, 0, 0), 0.1);
+
+    // batched ones are added to the model, others are checked separately one by one
+    CountingShapeReaction batched_shape(whole_stick, 0), shape(whole_stick, 0);
+    CountingRegionReaction batched_region(top, bottom_region, false), region(top, bottom_region, false);
+    CountingStretchReaction batched_stretch(0, STICK_VERTICES_NUM - 1, 0), stretch(0, STICK_VERTICES_NUM - 1, 0);
+    m.add_shape_deformation_reaction(batched_shape);
+    m.add_region_reaction(batched_region);
+    m.add_stretch_reaction(batched_stretch);
+
+    ForcesArray empty(0);
+    m.hit( SphericalRegion( Vector(0,0,2), 0.1 ), Vector(0, 1, 0) );
+    for(int i = 0; i < 3; ++i)
+    {
+        compute_next_step(m, empty, vcb);
+        shape.invoke_if_needed(m);
+        region.invoke_if_needed(m);
+        stretch.invoke_if_needed(m);
+    }
+
+    EXPECT_LT( 0, shape.invoked_num );
+    EXPECT_EQ( shape.invoked_num, batched_shape.invoked_num );
+    EXPECT_EQ( shape.last_vertex_index, batched_shape.last_vertex_index );
+    EXPECT_EQ( shape.last_distance, batched_shape.last_distance );
+
+    EXPECT_LT( 0, region.invoked_num );
+    EXPECT_EQ( region.invoked_num, batched_region.invoked_num );
+    EXPECT_EQ( region.last_vertex_index, batched_region.last_vertex_index );
+
+    EXPECT_LT( 0, stretch.invoked_num );
+    EXPECT_EQ( stretch.invoked_num, batched_stretch.invoked_num );
+    EXPECT_EQ( stretch.last_distance, batched_stretch.last_distance );
+}
+
+TEST_F(ModelTest, ParallelReactionsWithWorkerPool)
+{
+    // reactions of `parallel` are checked by worker threads, reactions of `serial` - by react_to_events
+    Model parallel(stick, STICK_VERTICES_NUM, vi1, stick, STICK_VERTICES_NUM, vi1, CLUSTERS_BY_AXES, PADDING, 4, NULL, &StdThreadFactory::instance);
+    Model serial(stick, STICK_VERTICES_NUM, vi1, stick, STICK_VERTICES_NUM, vi1, CLUSTERS_BY_AXES, PADDING, 4, NULL, &prim_factory);
+    parallel.set_parallel_reactions(true);
+    EXPECT_TRUE( parallel.has_parallel_reactions() );
+    EXPECT_FALSE( serial.has_parallel_reactions() );
+
+    IndexArray whole_stick;
+    for(int i = 0; i < STICK_VERTICES_NUM; ++i)
+        whole_stick.push_back(i);
+    const SphericalRegion bottom_region(Vector(0, 0, 0), 0.1);
+
+    CountingShapeReaction parallel_shape(whole_stick, 0), serial_shape(whole_stick, 0);
+    CountingRegionReaction parallel_region(whole_stick, bottom_region, true), serial_region(whole_stick, bottom_region, true);
+    CountingStretchReaction parallel_stretch(0, STICK_VERTICES_NUM - 1, 0), serial_stretch(0, STICK_VERTICES_NUM - 1, 0);
+    parallel.add_shape_deformation_reaction(parallel_shape);
+    parallel.add_region_reaction(parallel_region);
+    parallel.add_stretch_reaction(parallel_stretch);
+    serial.add_shape_deformation_reaction(serial_shape);
+    serial.add_region_reaction(serial_region);
+    serial.add_stretch_reaction(serial_stretch);
+
+    WorkerPool pool;
+    pool.add_executor(&parallel);
+    pool.start(4);
+
+    ForcesArray empty(0);
+    const Vector hit_velocity(0, 1, 0);
+    parallel.hit( SphericalRegion( Vector(0,0,2), 0.1 ), hit_velocity );
+    serial.hit( SphericalRegion( Vector(0,0,2), 0.1 ), hit_velocity );
+    for(int i = 0; i < 3; ++i)
+    {
+        parallel.compute_next_step_async(empty, dt, &vcb);
+        EXPECT_TRUE( parallel.wait_for_step() );
+        parallel.react_to_events();
+
+        compute_next_step(serial, empty, vcb);
+    }
+    pool.stop();
+
+    EXPECT_LT( 0, serial_shape.invoked_num );
+    EXPECT_EQ( serial_shape.invoked_num, parallel_shape.invoked_num );
+    EXPECT_EQ( serial_shape.last_vertex_index, parallel_shape.last_vertex_index );
+    EXPECT_EQ( serial_shape.last_distance, parallel_shape.last_distance );
+    // fired reactions are invoked in the thread calling react_to_events
+    EXPECT_EQ( std::this_thread::get_id(), parallel_shape.last_thread );
+
+    EXPECT_LT( 0, serial_region.invoked_num );
+    EXPECT_EQ( serial_region.invoked_num, parallel_region.invoked_num );
+    EXPECT_EQ( serial_region.last_vertex_index, parallel_region.last_vertex_index );
+
+    EXPECT_LT( 0, serial_stretch.invoked_num );
+    EXPECT_EQ( serial_stretch.invoked_num, parallel_stretch.invoked_num );
+    EXPECT_EQ( serial_stretch.last_distance, parallel_stretch.last_distance );
+}
+
+TEST_F(ModelTest, BatchedReactionsFallbacks)
+{
+    Model m(stick, STICK_VERTICES_NUM, vi1, stick, STICK_VERTICES_NUM, vi1, CLUSTERS_BY_AXES, PADDING, 4, NULL, &prim_factory);
+    IndexArray stick_frame;
+    stick_frame.push_back(0);
+    stick_frame.push_back(1);
+    stick_frame.push_back(2);
+    stick_frame.push_back(4);
+    m.set_frame(stick_frame);
+
+    ForcesArray empty(0);
+    m.hit( SphericalRegion( Vector(0,0,2), 0.1 ), Vector(0, 1, 0) );
+    for(int i = 0; i < 3; ++i)
+        compute_next_step(m, empty, vcb);
+
+    WatchedVertices watched;
+    watched.reset(STICK_VERTICES_NUM);
+
+    // a stretch reaction, whose vertices are not watched, reads positions from the model
+    CountingStretchReaction stretch(0, STICK_VERTICES_NUM - 1, 0), expected_stretch(0, STICK_VERTICES_NUM - 1, 0);
+    static_cast<ModelReaction &>(stretch).invoke_if_needed(m, watched);
+    expected_stretch.invoke_if_needed(m);
+    EXPECT_EQ( 1, stretch.invoked_num );
+    EXPECT_EQ( expected_stretch.last_distance, stretch.last_distance );
+
+    // so do reactions, whose shape is changed after watching vertices
+    IndexArray shape, expected_shape;
+    shape.push_back(0);
+    CountingShapeReaction shape_reaction(shape, 0);
+    const SphericalRegion bottom_region(Vector(0, 0, 0), 0.1);
+    CountingRegionReaction region_reaction(shape, bottom_region, false);
+    shape_reaction.watch_vertices(watched);
+    region_reaction.watch_vertices(watched);
+    watched.compute_positions(m);
+    for(int i = 1; i < STICK_VERTICES_NUM; ++i)
+        shape.push_back(i);
+
+    CountingShapeReaction expected_shape_reaction(shape, 0);
+    CountingRegionReaction expected_region_reaction(shape, bottom_region, false);
+    static_cast<ModelReaction &>(shape_reaction).invoke_if_needed(m, watched);
+    static_cast<ModelReaction &>(region_reaction).invoke_if_needed(m, watched);
+    expected_shape_reaction.invoke_if_needed(m);
+    expected_region_reaction.invoke_if_needed(m);
+    EXPECT_EQ( 1, expected_shape_reaction.invoked_num );
+    EXPECT_EQ( expected_shape_reaction.invoked_num, shape_reaction.invoked_num );
+    EXPECT_EQ( expected_shape_reaction.last_vertex_index, shape_reaction.last_vertex_index );
+    EXPECT_EQ( expected_shape_reaction.last_distance, shape_reaction.last_distance );
+    EXPECT_EQ( 1, expected_region_reaction.invoked_num );
+    EXPECT_EQ( expected_region_reaction.invoked_num, region_reaction.invoked_num );
+    EXPECT_EQ( expected_region_reaction.last_vertex_index, region_reaction.last_vertex_index );
+
+    // a reaction, which is not checked with watched vertices, is never found fired by is_invoke_needed,
+    // but is simply invoked with invoke_if_needed(model)
+    class CountingModelReaction : public ModelReaction
+    {
+    public:
+        int invoked_num;
+        CountingModelReaction() : invoked_num(0) {}
+        virtual void invoke_if_needed(const IModel &) { ++invoked_num; }
+    } model_reaction;
+    ReactionResult result;
+    EXPECT_FALSE( model_reaction.is_checked_with_watched() );
+    EXPECT_FALSE( model_reaction.is_invoke_needed(m, watched, result) );
+    EXPECT_TRUE( NULL == result.reaction );
+    static_cast<ModelReaction &>(model_reaction).invoke_if_needed(m, watched);
+    EXPECT_EQ( 1, model_reaction.invoked_num );
+}
+
+namespace
+{
+    // a stretch reaction adding its id to the log when invoked
+    class LoggingStretchReaction : public StretchReaction
+    {
+    private:
+        int id;
+        IndexArray & log;
+    public:
+        LoggingStretchReaction(int index1, int index2, Real dist_threshold, int id, IndexArray & log)
+            : StretchReaction(index1, index2, dist_threshold), id(id), log(log) {}
+        virtual void invoke(Real distance) { ignore_unreferenced(distance); log.push_back(id); }
+    };
+
+    // Runs steps of a deterministic model on a cube of vertices with given number of workers (0 means no workers:
+    // tasks are completed in this thread) and writes positions and velocities of vertices in the end
+    void run_deterministic_steps(int workers_num, int steps_num, Real dt, /*out*/ Real * results, /*out*/ IndexArray & reactions_log)
+    {
+        const int GRID_SIZE = 16;
+        const int VERTICES_NUM = GRID_SIZE*GRID_SIZE*GRID_SIZE;
+        TestVertex1 * cube = new TestVertex1[VERTICES_NUM];
+        fill_cube(cube, GRID_SIZE, 0.1);
+        VertexInfo vi( sizeof(cube[0]), 0, 3*sizeof(cube[0].x),  sizeof(cube[0]) - sizeof(cube[0].cn));
+        const int GRID_CLUSTERS_BY_AXES[VECTOR_SIZE] = {3, 3, 3};
+        // the work is split into as many tasks as there are workers
+        StdThreadFactory factory(true, workers_num);
+        Model m(cube, VERTICES_NUM, vi, cube, VERTICES_NUM, vi, GRID_CLUSTERS_BY_AXES, PADDING, 1, NULL,
+                0 == workers_num ? static_cast<IPrimFactory*>(&SingleThreadFactory::instance) : &factory);
+        m.set_deterministic(true);
+        m.set_parallel_reactions(true);
+
+        // reactions to stretching of edges of the cube (along X axis, starting at rows of vertices)
+        const int REACTIONS_NUM = 64;
+        LoggingStretchReaction * reactions[REACTIONS_NUM];
+        for(int i = 0; i < REACTIONS_NUM; ++i)
+        {
+            int first_vertex = i*(VERTICES_NUM/REACTIONS_NUM);
+            reactions[i] = new LoggingStretchReaction(first_vertex, first_vertex + 1, 0.1, i, reactions_log);
+            m.add_stretch_reaction(*reactions[i]);
+        }
+
+        UniformForce gravity(Vector(0, 0, -9.8));
+        PointForce push(Vector(30, 10, 0), Vector(0, 0, 0), 0.5);
+        ForcesArray forces;
+        forces.push_back(&gravity);
+        forces.push_back(&push);
+
+        WorkerPool pool;
+        if(workers_num > 0)
+        {
+            pool.add_executor(&m);
+            pool.start(workers_num);
+        }
+        for(int step = 0; step < steps_num; ++step)
+        {
+            if(0 == step % 2)
+                m.hit( SphericalRegion( Vector(1.5, 1.5, 1.5), 0.3 ), Vector(-1, -2, -3) );
+            m.compute_next_step_async(forces, dt, NULL);
+            if(0 == workers_num)
+            {
+                while( m.complete_next_task() ) {}
+            }
+            EXPECT_TRUE( m.wait_for_step() );
+            m.react_to_events();
+        }
+        if(workers_num > 0)
+            pool.stop();
+
+        for(int i = 0; i < VERTICES_NUM; ++i)
+        {
+            for(int j = 0; j < VECTOR_SIZE; ++j)
+            {
+                results[(2*i)*VECTOR_SIZE + j] = m.get_vertex(i).get_pos()[j];
+                results[(2*i + 1)*VECTOR_SIZE + j] = m.get_vertex(i).get_velocity()[j];
+            }
+        }
+        for(int i = 0; i < REACTIONS_NUM; ++i)
+            delete reactions[i];
+        delete[] cube;
+    }
+}
+
+TEST_F(ModelTest, DeterministicWithDifferentWorkersNums)
+{
+    const int VERTICES_NUM = 16*16*16;
+    const int RESULTS_NUM = 2*VERTICES_NUM*VECTOR_SIZE;
+    const int STEPS_NUM = 6;
+    const int WORKERS_NUMS[] = {0, 1, 3, 8};
+    const int RUNS_NUM = sizeof(WORKERS_NUMS)/sizeof(WORKERS_NUMS[0]);
+
+    Real * expected = new Real[RESULTS_NUM];
+    Real * results = new Real[RESULTS_NUM];
+    IndexArray expected_log;
+    run_deterministic_steps(WORKERS_NUMS[0], STEPS_NUM, dt, expected, expected_log);
+    EXPECT_LT(0, expected_log.size());
+
+    for(int run = 1; run < RUNS_NUM; ++run)
+    {
+        IndexArray log;
+        run_deterministic_steps(WORKERS_NUMS[run], STEPS_NUM, dt, results, log);
+
+        // bitwise equal, not just close
+        EXPECT_EQ( 0, memcmp(expected, results, RESULTS_NUM*sizeof(Real)) ) << "with " << WORKERS_NUMS[run] << " workers";
+        ASSERT_EQ( expected_log.size(), log.size() ) << "with " << WORKERS_NUMS[run] << " workers";
+        for(int i = 0; i < log.size(); ++i)
+            EXPECT_EQ( expected_log[i], log[i] ) << "with " << WORKERS_NUMS[run] << " workers";
+    }
+    delete[] expected;
+    delete[] results;
+}
+
+TEST_F(ModelTest, DeterministicUsesScalarKernels)
+{
+    Model m(vertices1, VERTICES1_NUM, vi1, vertices1, VERTICES1_NUM, vi1, CLUSTERS_BY_AXES, PADDING, 4, NULL, &prim_factory);
+    EXPECT_FALSE( m.is_deterministic() );
+    EXPECT_EQ( &ClusterKernels::get_best(), &m.get_cluster(0).get_kernels() );
+
+    m.set_deterministic(true);
+    EXPECT_TRUE( m.is_deterministic() );
+    EXPECT_EQ( ClusterKernels::get(ClusterKernels::SCALAR), &m.get_cluster(0).get_kernels() );
+
+    m.set_deterministic(false);
+    EXPECT_EQ( &ClusterKernels::get_best(), &m.get_cluster(0).get_kernels() );
+}
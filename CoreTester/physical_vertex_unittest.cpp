@@ -9,8 +9,10 @@ TEST(PhysicalVertexTest, Properties)
     Real mass = 4;
     const Vector velocity(0,0,1);
 
-    PhysicalVertex vertex(pos, mass, velocity);
+    PhysicalVertexStore store(1);
+    PhysicalVertex vertex(store, pos, mass, velocity);
     const PhysicalVertex &v = vertex;
+    EXPECT_EQ( 0, v.get_index() );
     EXPECT_EQ( pos, v.get_pos() );
     EXPECT_EQ( mass, v.get_mass() );
     EXPECT_EQ( velocity, v.get_velocity() );
@@ -30,7 +32,8 @@ TEST(PhysicalVertexTest, InterfaceForCluster)
     const Vector velocity(0,0,1);
     const Vector addition(0,0,2);
 
-    PhysicalVertex vertex(pos, mass, velocity);
+    PhysicalVertexStore store(1);
+    PhysicalVertex vertex(store, pos, mass, velocity);
     const PhysicalVertex &v = vertex;
     
     vertex.include_to_one_more_cluster(0, 1);
@@ -42,4 +45,68 @@ TEST(PhysicalVertexTest, InterfaceForCluster)
     vertex.add_to_average_velocity_addition(Vector::ZERO, 1);
     vertex.compute_velocity_addition();
     EXPECT_EQ( addition/2, v.get_velocity_addition() );
+
+    // equilibrium position is averaged too
+    vertex.set_equilibrium_pos(Vector(2,0,0), 0);
+    vertex.set_equilibrium_pos(Vector(0,2,0), 1);
+    EXPECT_EQ( Vector(1,1,0), v.get_equilibrium_pos() );
+}
+
+TEST(PhysicalVertexTest, ManyClusters)
+{
+    const int CLUSTERS_NUM = 20;
+    PhysicalVertexStore store(2);
+    PhysicalVertex u(store, Vector(0,0,0), 1);
+    PhysicalVertex v(store, Vector(1,0,0), 1);
+
+    // no fixed limit on number of including clusters
+    for(int i = 0; i < CLUSTERS_NUM; ++i)
+    {
+        v.include_to_one_more_cluster(i, 1);
+        EXPECT_EQ( i, v.get_next_addition_index() );
+    }
+    u.include_to_one_more_cluster(0, 1);
+    EXPECT_EQ( 0, u.get_next_addition_index() );
+    EXPECT_EQ( CLUSTERS_NUM, v.get_including_clusters_num() );
+
+    for(int i = 0; i < CLUSTERS_NUM; ++i)
+    {
+        v.set_equilibrium_pos(Vector(i,0,0), i);
+        v.add_to_average_velocity_addition(Vector(0,0,i), i);
+    }
+    u.set_equilibrium_pos(Vector(0,5,0), 0);
+    EXPECT_EQ( Vector(0.5*(CLUSTERS_NUM - 1),0,0), v.get_equilibrium_pos() );
+    EXPECT_EQ( Vector(0,5,0), u.get_equilibrium_pos() );
+
+    // including to one more cluster keeps values from other clusters
+    u.include_to_one_more_cluster(1, 1);
+    EXPECT_EQ( 1, u.get_next_addition_index() );
+    u.set_equilibrium_pos(Vector(0,3,0), 1);
+    EXPECT_EQ( Vector(0,4,0), u.get_equilibrium_pos() );
+    EXPECT_TRUE( v.compute_velocity_addition() );
+    EXPECT_EQ( Vector(0,0,0.5*(CLUSTERS_NUM - 1)), v.get_velocity_addition() );
+}
+
+TEST(PhysicalVertexTest, StoreStreams)
+{
+    PhysicalVertexStore store(3);
+    PhysicalVertex u(store, Vector(0,0,0), 1);
+    PhysicalVertex v(store, Vector(1,0,0), 2, Vector(0,1,0));
+    EXPECT_EQ( 2, store.get_size() );
+    EXPECT_EQ( 3, store.get_max_size() );
+    EXPECT_EQ( 1, v.get_index() );
+
+    // vertices only refer to the store, so that changes are visible via streams
+    v.add_to_velocity( Vector(0,0,1) );
+    EXPECT_EQ( Vector(0,1,1), store.get_velocities()[1] );
+    EXPECT_EQ( 2, store.get_masses()[1] );
+
+    store.integrate_positions(2, 0, 2);
+    EXPECT_EQ( Vector(0,0,0), u.get_pos() );
+    EXPECT_EQ( Vector(1,2,2), v.get_pos() );
+
+    EXPECT_EQ( 2, store.add_vertex(Vector(0,0,0), 1, Vector::ZERO) );
+    set_tester_err_callback();
+    EXPECT_THROW( store.add_vertex(Vector(0,0,0), 1, Vector::ZERO), CoreTesterException );
+    unset_tester_err_callback();
 }
@@ -149,3 +149,73 @@ TEST(RegionsTest, BoxRegionMove)
     EXPECT_EQ(Vector(1,2,1), region_instance.get_min_corner());
     EXPECT_EQ(Vector(2,3,2), region_instance.get_max_corner());
 }
+
+TEST(RegionsTest, BoundingBoxes)
+{
+    Vector min_corner, max_corner;
+
+    const EmptyRegion empty;
+    ASSERT_TRUE( empty.get_bounding_box(min_corner, max_corner) );
+    EXPECT_GT( min_corner[0], max_corner[0] );
+
+    // boxes of regions comparing with precision are padded a bit
+    const Real PADDING = 3*DEFAULT_REAL_PRECISION;
+
+    const SphericalRegion sphere( Vector(1,2,3), 2 );
+    ASSERT_TRUE( sphere.get_bounding_box(min_corner, max_corner) );
+    for(int c = 0; c < VECTOR_SIZE; ++c)
+    {
+        EXPECT_NEAR( Vector(-1,0,1)[c], min_corner[c], PADDING );
+        EXPECT_NEAR( Vector(3,4,5)[c], max_corner[c], PADDING );
+    }
+    // a point on the border within precision is contained and is inside the box
+    const Vector sphere_border = Vector(3,2,3) + Vector(DEFAULT_REAL_PRECISION/2, 0, 0);
+    ASSERT_TRUE( sphere.contains(sphere_border) );
+    EXPECT_TRUE( is_inside_box(sphere_border, min_corner, max_corner) );
+
+    const BoxRegion box( Vector(0,0,0), Vector(1,2,3) );
+    ASSERT_TRUE( box.get_bounding_box(min_corner, max_corner) );
+    EXPECT_EQ( Vector(0,0,0), min_corner );
+    EXPECT_EQ( Vector(1,2,3), max_corner );
+
+    // along the axis caps are not extended
+    const CylindricalRegion cylinder( Vector(1,1,3), Vector(1,1,1), 0.5 );
+    ASSERT_TRUE( cylinder.get_bounding_box(min_corner, max_corner) );
+    for(int c = 0; c < VECTOR_SIZE; ++c)
+    {
+        EXPECT_NEAR( Vector(0.5,0.5,1)[c], min_corner[c], PADDING );
+        EXPECT_NEAR( Vector(1.5,1.5,3)[c], max_corner[c], PADDING );
+    }
+    const Vector cylinder_border = Vector(1.5,1,3) + Vector(DEFAULT_REAL_PRECISION/2, 0, DEFAULT_REAL_PRECISION/2);
+    ASSERT_TRUE( cylinder.contains(cylinder_border) );
+    EXPECT_TRUE( is_inside_box(cylinder_border, min_corner, max_corner) );
+
+    // an inclined cylinder: points of its surface are inside the box
+    const CylindricalRegion inclined( Vector(2,1,3), Vector(0,0,0), 1 );
+    ASSERT_TRUE( inclined.get_bounding_box(min_corner, max_corner) );
+    // u and v are orthogonal to the axis and to each other
+    Vector axis = inclined.get_axis()/inclined.get_axis().norm();
+    Vector u = cross_product(axis, Vector(1,0,0));
+    u /= u.norm();
+    Vector v = cross_product(axis, u);
+    const int STEPS = 16;
+    for(int i = 0; i <= STEPS; ++i)
+    {
+        for(int j = 0; j < STEPS; ++j)
+        {
+            Real angle = 2*3.14159265358979*j/STEPS;
+            Vector point = inclined.get_bottom_center() + inclined.get_axis()*(static_cast<Real>(i)/STEPS) + (u*cos(angle) + v*sin(angle))*0.999;
+            ASSERT_TRUE( inclined.contains(point) );
+            for(int c = 0; c < VECTOR_SIZE; ++c)
+            {
+                EXPECT_LE( min_corner[c], point[c] );
+                EXPECT_GE( max_corner[c], point[c] );
+            }
+        }
+    }
+
+    // a degenerate cylinder (caps coincide) gets the box of a sphere, not a box of NaNs
+    get_cylinder_bounding_box( Vector(1,2,3), Vector(1,2,3), 2, min_corner, max_corner );
+    EXPECT_EQ( Vector(-1,0,1), min_corner );
+    EXPECT_EQ( Vector(3,4,5), max_corner );
+}
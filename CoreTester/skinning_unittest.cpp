@@ -0,0 +1,166 @@
+#include "core_tester.h"
+#include "Core/skinning.h"
+#include "Core/cluster.h"
+#include "Core/graphical_vertex.h"
+#include "Core/physical_vertex.h"
+
+namespace
+{
+    const int CLUSTERS_NUM = 2;
+    const int VERTICES_NUM = 3;
+
+    struct TestVertex
+    {
+        VertexFloat x, y, z;
+        ClusterIndex ci[VertexInfo::CLUSTER_INDICES_NUM];
+        unsigned cn;
+    } graphical_vertices[VERTICES_NUM] =
+        {
+            { 1,    2,    3, {0}, 0},
+            {-4, 5.5f,    8, {0}, 0},
+            { 3,   -1, 0.5f, {0}, 0},
+        };
+
+    // result is computed in VertexFloat, so it is compared with some tolerance
+    void expect_near(const Vector &expected, const Vector &actual, Real accuracy)
+    {
+        for(int c = 0; c < VECTOR_SIZE; ++c)
+            EXPECT_NEAR(expected[c], actual[c], accuracy) << "expected " << expected << ", got " << actual;
+    }
+
+    class SkinningTest : public ::testing::Test
+    {
+    protected:
+        VertexInfo vi;
+        PhysicalVertexStore store;
+        PhysicalVertex physical_vertices[CLUSTERS_NUM*2];
+        ::CrashAndSqueeze::Collections::Array<Cluster> clusters;
+        ClusterMembershipStore memberships;
+        ::CrashAndSqueeze::Collections::Array<GraphicalVertex> vertices;
+        Skinning skinning;
+
+        SkinningTest()
+            : vi( sizeof(graphical_vertices[0]), 0, 3*sizeof(graphical_vertices[0].x), sizeof(graphical_vertices[0]) - sizeof(graphical_vertices[0].cn) ),
+              store(CLUSTERS_NUM*2)
+        {}
+
+        virtual void SetUp()
+        {
+            // two physical vertices in each cluster
+            clusters.create_items(CLUSTERS_NUM);
+            for(int i = 0; i < CLUSTERS_NUM; ++i)
+            {
+                physical_vertices[2*i] = PhysicalVertex(store, Vector(i, 0, 1), 1);
+                physical_vertices[2*i + 1] = PhysicalVertex(store, Vector(3*i, 2, -1), 3);
+                clusters[i].add_physical_vertex(physical_vertices[2*i]);
+                clusters[i].add_physical_vertex(physical_vertices[2*i + 1]);
+            }
+
+            // each graphical vertex is in both clusters, but with different weights
+            vertices.create_items(VERTICES_NUM);
+            for(int i = 0; i < VERTICES_NUM; ++i)
+            {
+                vertices[i] = GraphicalVertex(vi, &graphical_vertices[i], memberships);
+                vertices[i].include_to_one_more_cluster(0, 1 + i);
+                vertices[i].include_to_one_more_cluster(1, 3);
+                vertices[i].normalize_weights();
+            }
+
+            store.allocate_cluster_slots();
+            suppress_warnings();
+            for(int i = 0; i < CLUSTERS_NUM; ++i)
+                clusters[i].compute_initial_characteristics();
+            unsuppress_warnings();
+
+            skinning.init(vertices, clusters);
+        }
+
+        // an arbitrary transformation of given cluster
+        Skinning::Transform get_transform(int cluster_index) const
+        {
+            Real shift = cluster_index*0.25;
+            Matrix lin(1 + shift, 0.5, -0.25,
+                       0.125, 0.75, shift,
+                       -shift, 0.5, 1.5);
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+            Matrix quad = lin*0.125;
+            Matrix mix = lin.transposed()*(-0.0625);
+            return Skinning::Transform(lin, quad, mix);
+#else
+            return lin;
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+        }
+
+        Vector get_center(int cluster_index) const
+        {
+            return Vector(cluster_index - 1.5, 2, 0.5*cluster_index);
+        }
+
+        // the same as Skinning::compute_point, but computed directly in Real
+        Vector compute_expected_point(int vertex_index) const
+        {
+            const GraphicalVertex & vertex = vertices[vertex_index];
+            Vector result = Vector::ZERO;
+            for(int k = 0; k < vertex.get_including_clusters_num(); ++k)
+            {
+                int cluster_index = vertex.get_including_cluster_index(k);
+                Vector offset = vertex.get_point(0) - clusters[cluster_index].get_initial_center_of_mass();
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+                Vector transformed = get_transform(cluster_index)*TriVector(offset);
+#else
+                Vector transformed = get_transform(cluster_index)*offset;
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+                result += (transformed + get_center(cluster_index))*vertex.get_cluster_weight(k);
+            }
+            return result;
+        }
+
+        Vector compute_point(int vertex_index) const
+        {
+            VertexFloat point[Skinning::COLUMN_SIZE];
+            skinning.compute_point(vertex_index, 0, point);
+            return Vector(point[0], point[1], point[2]);
+        }
+    };
+}
+
+TEST_F(SkinningTest, Init)
+{
+    ASSERT_EQ(VERTICES_NUM, skinning.get_vertices_num());
+    for(int i = 0; i < VERTICES_NUM; ++i)
+        EXPECT_EQ(CLUSTERS_NUM, skinning.get_clusters_num(i));
+}
+
+TEST_F(SkinningTest, UndeformedClusters)
+{
+#if CAS_QUADRATIC_EXTENSIONS_ENABLED
+    Skinning::Transform identity(Matrix::IDENTITY, Matrix::ZERO, Matrix::ZERO);
+#else
+    Skinning::Transform identity = Matrix::IDENTITY;
+#endif // CAS_QUADRATIC_EXTENSIONS_ENABLED
+    // clusters are not moved, so positions are the initial ones
+    for(int i = 0; i < CLUSTERS_NUM; ++i)
+        skinning.set_transform(i, identity, clusters[i].get_initial_center_of_mass());
+
+    for(int i = 0; i < VERTICES_NUM; ++i)
+    {
+        Vector expected = vertices[i].get_point(0);
+        expect_near(expected, compute_point(i), 1e-5);
+    }
+}
+
+TEST_F(SkinningTest, Deformation)
+{
+    for(int i = 0; i < CLUSTERS_NUM; ++i)
+        skinning.set_transform(i, get_transform(i), get_center(i));
+
+    for(int simd = 0; simd < 2; ++simd)
+    {
+        skinning.set_simd_enabled(simd != 0);
+        for(int i = 0; i < VERTICES_NUM; ++i)
+        {
+            Vector expected = compute_expected_point(i);
+            expect_near(expected, compute_point(i), 1e-4);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#include "core_tester.h"
+#include "Core/surface_adjacency.h"
+
+namespace
+{
+    // two triangles sharing an edge, and an isolated vertex 4
+    const int VERTICES_NUM = 5;
+    const int TRIANGLES_NUM = 2;
+    const unsigned INDICES[TRIANGLES_NUM*ISurface::VERTICES_PER_TRIANGLE] =
+        {
+            0, 1, 2,
+            2, 1, 3
+        };
+
+    // provides triangles only as an array: iterator must not be used
+    class ArraySurface : public ISurface
+    {
+    private:
+        Triangle triangles[TRIANGLES_NUM];
+    public:
+        ArraySurface()
+        {
+            for(int t = 0; t < TRIANGLES_NUM; ++t)
+                for(int j = 0; j < VERTICES_PER_TRIANGLE; ++j)
+                    triangles[t][j] = INDICES[t*VERTICES_PER_TRIANGLE + j];
+        }
+        virtual TriangleIterator * get_triangles() { ADD_FAILURE() << "iterator used"; return NULL; }
+        virtual void destroy_iterator(TriangleIterator * iterator) { ignore_unreferenced(iterator); }
+        virtual TriangleArray get_triangle_array()
+        {
+            TriangleArray result = {triangles, TRIANGLES_NUM};
+            return result;
+        }
+    };
+}
+
+TEST(SurfaceAdjacencyTest, Build)
+{
+    TestSurface surface(INDICES, TRIANGLES_NUM);
+    SurfaceAdjacency adjacency;
+    ASSERT_TRUE( adjacency.build(surface, VERTICES_NUM) );
+
+    EXPECT_EQ(VERTICES_NUM, adjacency.get_vertices_num());
+    ASSERT_EQ(TRIANGLES_NUM, adjacency.get_triangles_num());
+    for(int t = 0; t < TRIANGLES_NUM; ++t)
+        for(int j = 0; j < ISurface::VERTICES_PER_TRIANGLE; ++j)
+            EXPECT_EQ(static_cast<int>(INDICES[t*ISurface::VERTICES_PER_TRIANGLE + j]), adjacency.get_triangle_vertex(t, j));
+
+    const int EXPECTED_TRIANGLES_NUMS[VERTICES_NUM] = {1, 2, 2, 1, 0};
+    for(int i = 0; i < VERTICES_NUM; ++i)
+        EXPECT_EQ(EXPECTED_TRIANGLES_NUMS[i], adjacency.get_vertex_triangles_num(i));
+
+    // triangles of a vertex are in the order of the surface
+    EXPECT_EQ(0, adjacency.get_vertex_triangle(0, 0));
+    EXPECT_EQ(0, adjacency.get_vertex_triangle(1, 0));
+    EXPECT_EQ(1, adjacency.get_vertex_triangle(1, 1));
+    EXPECT_EQ(0, adjacency.get_vertex_triangle(2, 0));
+    EXPECT_EQ(1, adjacency.get_vertex_triangle(2, 1));
+    EXPECT_EQ(1, adjacency.get_vertex_triangle(3, 0));
+}
+
+TEST(SurfaceAdjacencyTest, BuildFromTriangleArray)
+{
+    TestSurface iterated_surface(INDICES, TRIANGLES_NUM);
+    ArraySurface array_surface;
+    SurfaceAdjacency expected, adjacency;
+    ASSERT_TRUE( expected.build(iterated_surface, VERTICES_NUM) );
+    ASSERT_TRUE( adjacency.build(array_surface, VERTICES_NUM) );
+
+    ASSERT_EQ(expected.get_triangles_num(), adjacency.get_triangles_num());
+    for(int t = 0; t < TRIANGLES_NUM; ++t)
+        for(int j = 0; j < ISurface::VERTICES_PER_TRIANGLE; ++j)
+            EXPECT_EQ(expected.get_triangle_vertex(t, j), adjacency.get_triangle_vertex(t, j));
+    for(int i = 0; i < VERTICES_NUM; ++i)
+    {
+        ASSERT_EQ(expected.get_vertex_triangles_num(i), adjacency.get_vertex_triangles_num(i));
+        for(int k = 0; k < expected.get_vertex_triangles_num(i); ++k)
+            EXPECT_EQ(expected.get_vertex_triangle(i, k), adjacency.get_vertex_triangle(i, k));
+    }
+}
+
+TEST(SurfaceAdjacencyTest, VertexOutOfRange)
+{
+    TestSurface surface(INDICES, TRIANGLES_NUM);
+    SurfaceAdjacency adjacency;
+
+    set_tester_err_callback();
+    EXPECT_THROW( adjacency.build(surface, 3), CoreTesterException );
+    unset_tester_err_callback();
+
+    EXPECT_EQ(0, adjacency.get_vertices_num());
+    EXPECT_EQ(0, adjacency.get_triangles_num());
+}
@@ -0,0 +1,113 @@
+#include "core_tester.h"
+#include "Core/vertex_grid.h"
+
+namespace
+{
+    bool is_inside(const Vector & point, const Vector & min_corner, const Vector & max_corner)
+    {
+        for(int c = 0; c < VECTOR_SIZE; ++c)
+        {
+            if(point[c] < min_corner[c] || point[c] > max_corner[c])
+                return false;
+        }
+        return true;
+    }
+
+    // checks that candidates are in ascending order and include all points inside the box
+    void check_candidates(const VertexGrid & grid, const Vector * points, int points_num, const Vector & min_corner, const Vector & max_corner)
+    {
+        ::CrashAndSqueeze::Collections::Array<int> found;
+        grid.find_candidates(min_corner, max_corner, found);
+        for(int i = 1; i < found.size(); ++i)
+            EXPECT_LT( found[i - 1], found[i] );
+        for(int i = 0; i < points_num; ++i)
+        {
+            if(is_inside(points[i], min_corner, max_corner))
+            {
+                EXPECT_TRUE( found.contains(i) ) << "point #" << i << " " << points[i] << " is not found";
+            }
+        }
+    }
+}
+
+TEST(VertexGridTest, Build)
+{
+    const int POINTS_NUM = 1000;
+    Vector points[POINTS_NUM];
+    for(int i = 0; i < POINTS_NUM; ++i)
+        points[i] = Vector(i % 10, (i / 10) % 10, i / 100);
+
+    VertexGrid grid;
+    grid.build(points, POINTS_NUM);
+    EXPECT_EQ( POINTS_NUM, grid.get_points_num() );
+    // a few points in a cell
+    EXPECT_GT( grid.get_cells_num(), POINTS_NUM/VertexGrid::POINTS_PER_CELL/4 );
+    EXPECT_LE( grid.get_cells_num(), POINTS_NUM );
+
+    grid.clear();
+    EXPECT_EQ( 0, grid.get_points_num() );
+    EXPECT_EQ( 0, grid.get_cells_num() );
+}
+
+TEST(VertexGridTest, FindCandidates)
+{
+    const int POINTS_NUM = 500;
+    Vector points[POINTS_NUM];
+    // irregularly scattered points
+    for(int i = 0; i < POINTS_NUM; ++i)
+        points[i] = Vector((i*37 % 101)*0.1, (i*53 % 97)*0.05, (i*71 % 89)*0.2);
+
+    VertexGrid grid;
+    grid.build(points, POINTS_NUM);
+
+    check_candidates(grid, points, POINTS_NUM, Vector(2, 1, 3), Vector(4, 2, 7));
+    check_candidates(grid, points, POINTS_NUM, Vector(-100, -100, -100), Vector(100, 100, 100));
+    check_candidates(grid, points, POINTS_NUM, points[17], points[17]);
+
+    // a small box doesn't give all points
+    ::CrashAndSqueeze::Collections::Array<int> found;
+    grid.find_candidates(Vector(0.5, 0.5, 0.5), Vector(1, 1, 1), found);
+    EXPECT_LT( found.size(), POINTS_NUM/4 );
+
+    // boxes outside the grid or empty ones give nothing
+    found.clear();
+    grid.find_candidates(Vector(20, 0, 0), Vector(30, 10, 10), found);
+    grid.find_candidates(Vector(1, 1, 1), Vector(0, 0, 0), found);
+    EXPECT_EQ( 0, found.size() );
+}
+
+TEST(VertexGridTest, FlatPoints)
+{
+    // all points are on a line
+    const int POINTS_NUM = 100;
+    Vector points[POINTS_NUM];
+    for(int i = 0; i < POINTS_NUM; ++i)
+        points[i] = Vector(1, i, 2);
+
+    VertexGrid grid;
+    grid.build(points, POINTS_NUM);
+    EXPECT_EQ( 1, grid.get_cells_num(0) );
+    EXPECT_GT( grid.get_cells_num(1), 1 );
+    EXPECT_EQ( 1, grid.get_cells_num(2) );
+    check_candidates(grid, points, POINTS_NUM, Vector(0, 10, 0), Vector(2, 20, 3));
+}
+
+TEST(VertexGridTest, AlmostFlatPoints)
+{
+    // points are on a square, but one of them is slightly above it: the thin axis gets one cell,
+    // while the others would get MAX_CELLS_PER_AXIS cells each without the limit of the total number
+    const int SIDE = 10;
+    const int POINTS_NUM = SIDE*SIDE;
+    Vector points[POINTS_NUM];
+    for(int i = 0; i < POINTS_NUM; ++i)
+        points[i] = Vector(i % SIDE, i / SIDE, 0);
+    points[POINTS_NUM/2][2] = 1e-3;
+
+    VertexGrid grid;
+    grid.build(points, POINTS_NUM);
+    EXPECT_EQ( 1, grid.get_cells_num(2) );
+    EXPECT_GT( grid.get_cells_num(), 1 );
+    EXPECT_LE( grid.get_cells_num(), POINTS_NUM*VertexGrid::MAX_CELLS_PER_POINT );
+    check_candidates(grid, points, POINTS_NUM, Vector(2, 3, -1), Vector(5, 4, 1));
+    check_candidates(grid, points, POINTS_NUM, points[POINTS_NUM/2], points[POINTS_NUM/2]);
+}
@@ -44,6 +44,30 @@ TEST(VertexInfoTest, BadOffsetsCreation)
     unset_tester_err_callback();
 }
 
+TEST(VertexInfoTest, ClusterIndicesFormat)
+{
+    VertexInfo vi(48, 0, 24, 44);
+    EXPECT_EQ(static_cast<int>(sizeof(ClusterIndex)), vi.get_cluster_index_size());
+    EXPECT_EQ(VertexInfo::CLUSTER_INDICES_NUM, vi.get_cluster_indices_num());
+    EXPECT_EQ(255u, vi.get_max_cluster_index());
+
+    vi.set_cluster_indices_format(2, 10);
+    EXPECT_EQ(2, vi.get_cluster_index_size());
+    EXPECT_EQ(10, vi.get_cluster_indices_num());
+    EXPECT_EQ(65535u, vi.get_max_cluster_index());
+
+    vi.set_cluster_indices_format(4, 5);
+    EXPECT_EQ(4, vi.get_cluster_index_size());
+    EXPECT_EQ(5, vi.get_cluster_indices_num());
+    EXPECT_EQ(4294967295u, vi.get_max_cluster_index());
+
+    set_tester_err_callback();
+    EXPECT_THROW( vi.set_cluster_indices_format(3, 4), CoreTesterException ); // bad index size
+    EXPECT_THROW( vi.set_cluster_indices_format(2, 0), CoreTesterException );
+    EXPECT_THROW( vi.set_cluster_indices_format(4, 7), CoreTesterException ); // no room for cluster indices
+    unset_tester_err_callback();
+}
+
 TEST(VertexInfoTest, AddPoint)
 {
     VertexInfo vi(48, 0, 40, 36);
@@ -5,15 +5,31 @@
 // Helpers for 'proper' comparing floating point numbers: assuming equal those ones,
 // whose difference is less than given epsilon
 
+// ** Options (preprocessor switches) **
+
+// Set to 1 (e.g. in project settings, for all projects) to use single precision
+// for internal calculations: it is enough for most visual effects, and it doubles
+// the width of SIMD calculations and halves memory traffic
+#ifndef CAS_SINGLE_PRECISION
+#define CAS_SINGLE_PRECISION 0
+#endif // CAS_SINGLE_PRECISION
+
 namespace CrashAndSqueeze
 {
     namespace Math
     {
         // floating-point type of internal calculations
+#if CAS_SINGLE_PRECISION
+        typedef float Real;
+        const Real MAX_REAL = FLT_MAX;
+
+        const Real DEFAULT_REAL_PRECISION = 1e-5f;
+#else
         typedef double Real;
         const Real MAX_REAL = DBL_MAX; 
         
         const Real DEFAULT_REAL_PRECISION = 1e-9;
+#endif // CAS_SINGLE_PRECISION
 
         inline bool equal(Real a, Real b, Real epsilon = DEFAULT_REAL_PRECISION)
         {
@@ -41,9 +57,15 @@ namespace CrashAndSqueeze
             return (a < b) ? a : b;
         }
 
+        template <typename T> /* requires LessThanComparable<T> */
+        inline T maximum(T a, T b)
+        {
+            return (a < b) ? b : a;
+        }
+
         inline Real cube_root(Real value)
         {
-            return pow( abs(value), 1.0/3)*sign(value);
+            return pow( fabs(value), static_cast<Real>(1)/3 )*sign(value);
         }
     };
 };
@@ -331,12 +331,33 @@ namespace CrashAndSqueeze
             {
                 return equal(0, value) ? 0 : (1 / value);
             }
+
+            // maximum angle of one refinement of rotation in Matrix::extract_rotation: a step
+            // computed far from the solution (or near a saddle point) may be arbitrarily large
+            const Real MAX_ROTATION_STEP_ANGLE = 1;
+
+            // makes columns of the (almost orthogonal) matrix orthonormal by Gram-Schmidt process,
+            // so that rounding errors of repeated refinements don't accumulate (the third column
+            // is computed as cross product, so that the result is a rotation)
+            void orthonormalize_columns(/*in/out*/ Matrix &matrix)
+            {
+                Vector column0 = matrix.get_column(0).normalized();
+                Vector column1 = matrix.get_column(1);
+                column1 = (column1 - (column0*column1)*column0).normalized();
+                Vector column2 = cross_product(column0, column1);
+                for(int i = 0; i < VECTOR_SIZE; ++i)
+                {
+                    matrix.set_at(i, 0, column0[i]);
+                    matrix.set_at(i, 1, column1[i]);
+                    matrix.set_at(i, 2, column2[i]);
+                }
+            }
         }
 
         void Matrix::do_polar_decomposition(/*out*/ Matrix &orthogonal_part,
                                             /*out*/ Matrix &symmetric_part,
                                             int diagonalization_rotations_count /*= DEFAULT_JACOBI_ROTATIONS_COUNT*/,
-                                            int invert_rotations_count /*= 2*DEFAULT_JACOBI_ROTATIONS_COUNT*/,
+                                            int invert_rotations_count /*= DEFAULT_INVERT_JACOBI_ROTATIONS_COUNT*/,
                                             Real diag_precision /*=DEFAULT_REAL_PRECISION*/) const
         {
             symmetric_part = (this->transposed()*(*this)).compute_function(safe_sqrt, diagonalization_rotations_count, diag_precision);
@@ -348,7 +369,62 @@ namespace CrashAndSqueeze
             orthogonal_part = (*this)*sym_inv;
         }
 
-        bool Matrix::invert_sym(int diag_rotations /*= 2*DEFAULT_JACOBI_ROTATIONS_COUNT*/, Real diag_precision /*=DEFAULT_REAL_PRECISION*/)
+        int Matrix::extract_rotation(/*in/out*/ Matrix &rotation,
+                                     int max_iterations /*= DEFAULT_ROTATION_EXTRACTION_ITERATIONS*/,
+                                     Real precision /*=DEFAULT_REAL_PRECISION*/) const
+        {
+            int iter;
+            for(iter = 0; iter < max_iterations; ++iter)
+            {
+                // The rotation maximizes trace(transposed(R)*A). For a small rotation (by vector omega)
+                // applied to current R, this trace is approximately
+                // trace(N) + omega*gradient - omega*hessian*omega/2, where N = A*transposed(R)
+                Matrix n = (*this)*rotation.transposed();
+                Vector gradient( n.get_at(2, 1) - n.get_at(1, 2),
+                                 n.get_at(0, 2) - n.get_at(2, 0),
+                                 n.get_at(1, 0) - n.get_at(0, 1) );
+                Real trace = n.get_at(0, 0) + n.get_at(1, 1) + n.get_at(2, 2);
+                Matrix hessian = Matrix::IDENTITY*trace - (n + n.transposed())/2;
+
+                Vector omega;
+                if( hessian.get_at(0, 0) > 0
+                    && hessian.get_at(0, 0)*hessian.get_at(1, 1) - hessian.get_at(0, 1)*hessian.get_at(1, 0) > 0
+                    && hessian.determinant() > 0
+                    && hessian.invert() )
+                {
+                    // hessian is positive definite (this is the case near the solution): Newton step
+                    omega = hessian*gradient;
+                }
+                else
+                {
+                    // far from the solution: approximate hessian by its trace part
+                    // (this is the step of Mueller et al.)
+                    omega = gradient/(fabs(trace) + precision);
+                }
+
+                Real angle = omega.norm();
+                if( less_or_equal(angle, 0, precision) )
+                {
+                    break;
+                }
+                rotation = axis_rotation(omega/angle, minimum(angle, MAX_ROTATION_STEP_ANGLE))*rotation;
+            }
+            // the rotation is refined again and again on each call, so keep it orthonormal
+            orthonormalize_columns(rotation);
+            return iter;
+        }
+
+        Matrix Matrix::axis_rotation(const Vector &axis, Real angle)
+        {
+            Real c = cos(angle);
+            Real s = sin(angle);
+            Real t = 1 - c;
+            return Matrix( t*axis[0]*axis[0] + c,         t*axis[0]*axis[1] - s*axis[2], t*axis[0]*axis[2] + s*axis[1],
+                           t*axis[0]*axis[1] + s*axis[2], t*axis[1]*axis[1] + c,         t*axis[1]*axis[2] - s*axis[0],
+                           t*axis[0]*axis[2] - s*axis[1], t*axis[1]*axis[2] + s*axis[0], t*axis[2]*axis[2] + c         );
+        }
+
+        bool Matrix::invert_sym(int diag_rotations /*= DEFAULT_INVERT_JACOBI_ROTATIONS_COUNT*/, Real diag_precision /*=DEFAULT_REAL_PRECISION*/)
         {
             *this = compute_function(safe_inv, diag_rotations, diag_precision);
             return true;
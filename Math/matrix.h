@@ -12,7 +12,18 @@ namespace CrashAndSqueeze
         typedef Real (*Operation)(Real self_element, Real another_element);
         typedef Real (*Function)(Real value);
         
+        // number of Jacobi rotations for diagonalizing a matrix to compute its function
         const int DEFAULT_JACOBI_ROTATIONS_COUNT = 6;
+        // number of Jacobi rotations for diagonalizing a symmetric matrix to invert it:
+        // enough to reach the precision of Real (in single precision it is reached earlier)
+#if CAS_SINGLE_PRECISION
+        const int DEFAULT_INVERT_JACOBI_ROTATIONS_COUNT = 10;
+#else
+        const int DEFAULT_INVERT_JACOBI_ROTATIONS_COUNT = 2*DEFAULT_JACOBI_ROTATIONS_COUNT;
+#endif // CAS_SINGLE_PRECISION
+        // maximum number of iterations for extracting rotation (see Matrix::extract_rotation):
+        // convergence is quadratic, so it is enough even when starting from a distant rotation
+        const int DEFAULT_ROTATION_EXTRACTION_ITERATIONS = 8;
 
         class Matrix
         {
@@ -182,7 +193,7 @@ namespace CrashAndSqueeze
             bool invert();
 
             // Inverts symmetric (!) matrix in place (!) by diagonalizing it using diag_rotations Jacobi rotations
-            bool invert_sym(int diag_rotations = 2*DEFAULT_JACOBI_ROTATIONS_COUNT, Real diag_precision = DEFAULT_REAL_PRECISION);
+            bool invert_sym(int diag_rotations = DEFAULT_INVERT_JACOBI_ROTATIONS_COUNT, Real diag_precision = DEFAULT_REAL_PRECISION);
 
             // squared Frobenius norm of matrix
             Real squared_norm() const;
@@ -237,8 +248,25 @@ namespace CrashAndSqueeze
             void do_polar_decomposition(/*out*/ Matrix &orthogonal_part,
                                         /*out*/ Matrix &symmetric_part,
                                         int diagonalization_rotations_count = DEFAULT_JACOBI_ROTATIONS_COUNT,
-                                        int invert_rotations_count = 2*DEFAULT_JACOBI_ROTATIONS_COUNT,
+                                        int invert_rotations_count = DEFAULT_INVERT_JACOBI_ROTATIONS_COUNT,
                                         Real invert_precision = DEFAULT_REAL_PRECISION) const;
+
+            // Finds orthogonal term of polar decomposition iteratively, refining given
+            // rotation in place (!) by small rotations: Newton steps near the solution, and steps of
+            // Mueller et al. ("A Robust Method to Extract the Rotational Part of Deformations") far from it.
+            // The previous value of rotation (e.g. found on previous step) is used as a starting
+            // point, so only a couple of iterations are done when it changes slowly, much cheaper
+            // than do_polar_decomposition. Stops after max_iterations or when the angle of
+            // refinement is less than precision. The angle of each refinement is limited, and the
+            // result is orthonormalized in the end, so that errors don't accumulate over many warm-started
+            // calls. The result is always a rotation (determinant is 1), even if the determinant of the matrix is negative.
+            // Returns the number of iterations done.
+            int extract_rotation(/*in/out*/ Matrix &rotation,
+                                 int max_iterations = DEFAULT_ROTATION_EXTRACTION_ITERATIONS,
+                                 Real precision = DEFAULT_REAL_PRECISION) const;
+
+            // Returns a matrix of rotation around given axis (a unit vector) by given angle (in radians)
+            static Matrix axis_rotation(const Vector &axis, Real angle);
         };
 
         inline Matrix operator*(const Real &scalar, const Matrix &matrix)
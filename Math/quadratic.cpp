@@ -310,6 +310,170 @@ namespace CrashAndSqueeze
             }
         }
 
+        // -- SymNineMatrix --
+
+        void SymNineMatrix::set_all(const Real &value)
+        {
+            for (int k = 0; k < PACKED_SIZE; ++k)
+            {
+                values[k] = value;
+            }
+        }
+
+        void SymNineMatrix::add_outer_product(const TriVector &vector, Real weight)
+        {
+            Real components[SIZE];
+            for (int i = 0; i < SIZE; ++i)
+            {
+                components[i] = vector.vectors[i / 3][i % 3];
+            }
+
+            Real * value = values;
+            for (int i = 0; i < SIZE; ++i)
+            {
+                Real weighted = weight*components[i];
+                for (int j = 0; j <= i; ++j)
+                {
+                    *(value++) += weighted*components[j];
+                }
+            }
+        }
+
+        bool SymNineMatrix::factorize_ldlt(const Real min_pivots[SIZE])
+        {
+            for (int j = 0; j < SIZE; ++j)
+            {
+                // d[j] = a[j][j] - sum of l[j][k]^2*d[k]
+                Real pivot = values[packed_index(j, j)];
+                for (int k = 0; k < j; ++k)
+                {
+                    Real l = values[packed_index(j, k)];
+                    pivot -= l*l*values[packed_index(k, k)];
+                }
+                if (pivot <= min_pivots[j])
+                    return false;
+                values[packed_index(j, j)] = pivot;
+
+                // l[i][j] = (a[i][j] - sum of l[i][k]*l[j][k]*d[k]) / d[j]
+                for (int i = j + 1; i < SIZE; ++i)
+                {
+                    Real value = values[packed_index(i, j)];
+                    for (int k = 0; k < j; ++k)
+                    {
+                        value -= values[packed_index(i, k)]*values[packed_index(j, k)]*values[packed_index(k, k)];
+                    }
+                    values[packed_index(i, j)] = value/pivot;
+                }
+            }
+            return true;
+        }
+
+        bool SymNineMatrix::invert_sym(Real regularization /*= DEFAULT_REAL_PRECISION*/)
+        {
+            Real max_diagonal = 0;
+            for (int i = 0; i < SIZE; ++i)
+            {
+                max_diagonal = maximum(max_diagonal, get_at(i, i));
+            }
+            if (max_diagonal <= 0)
+            {
+                // zero (or not positive semi-definite) matrix: nothing to invert
+                set_all(0);
+                return max_diagonal == 0;
+            }
+
+            // A pivot is considered degenerate, if it is not greater than regularization*(its diagonal element),
+            // i.e. the row is almost a linear combination of previous ones. Thresholds are relative to each
+            // diagonal element (not to the maximum one), so that thin clusters are not regularized
+            // in their thin directions. Zero (or negligible) rows get a threshold relative to the maximum.
+            Real min_pivots[SIZE];
+            const Real zero_pivots[SIZE] = {0};
+            for (int i = 0; i < SIZE; ++i)
+            {
+                min_pivots[i] = regularization*maximum(get_at(i, i), regularization*max_diagonal);
+            }
+
+            SymNineMatrix factorized = *this;
+            if ( ! factorized.factorize_ldlt(min_pivots) )
+            {
+                // nearly singular: regularize and try again
+                factorized = *this;
+                for (int i = 0; i < SIZE; ++i)
+                {
+                    factorized.values[packed_index(i, i)] += min_pivots[i];
+                }
+                if ( ! factorized.factorize_ldlt(zero_pivots) )
+                    return false;
+            }
+
+            // solve L*D*transposed(L)*x = e for each column e of unit matrix:
+            // only the lower part of result (rows j..SIZE-1 of column j) is needed
+            for (int j = 0; j < SIZE; ++j)
+            {
+                Real x[SIZE];
+                // forward substitution: L*y = e, y[i] = 0 for i < j
+                for (int i = 0; i < SIZE; ++i)
+                {
+                    x[i] = (i == j) ? 1 : 0;
+                    for (int k = j; k < i; ++k)
+                    {
+                        x[i] -= factorized.values[packed_index(i, k)]*x[k];
+                    }
+                }
+                // diagonal: D*z = y
+                for (int i = j; i < SIZE; ++i)
+                {
+                    x[i] /= factorized.values[packed_index(i, i)];
+                }
+                // backward substitution: transposed(L)*x = z
+                for (int i = SIZE - 1; i >= j; --i)
+                {
+                    for (int k = i + 1; k < SIZE; ++k)
+                    {
+                        x[i] -= factorized.values[packed_index(k, i)]*x[k];
+                    }
+                }
+                for (int i = j; i < SIZE; ++i)
+                {
+                    values[packed_index(i, j)] = x[i];
+                }
+            }
+            return true;
+        }
+
+        void SymNineMatrix::left_mult_by(/*in*/  const TriMatrix  & m3,
+                                         /*out*/ TriMatrix & res) const
+        {
+            for (int r = 0; r < VECTOR_SIZE; ++r)
+            {
+                Real row[SIZE];
+                for (int k = 0; k < SIZE; ++k)
+                {
+                    row[k] = m3.matrices[k / 3].get_at(r, k % 3);
+                }
+                for (int j = 0; j < SIZE; ++j)
+                {
+                    Real value = 0;
+                    for (int k = 0; k < SIZE; ++k)
+                    {
+                        value += row[k]*get_at(k, j);
+                    }
+                    res.matrices[j / 3].set_at(r, j % 3, value);
+                }
+            }
+        }
+
+        void SymNineMatrix::to_nine_matrix(/*out*/ NineMatrix & result) const
+        {
+            for (int i = 0; i < SIZE; ++i)
+            {
+                for (int j = 0; j < SIZE; ++j)
+                {
+                    result.set_at(i, j, get_at(i, j));
+                }
+            }
+        }
+
 #ifndef NDEBUG
         void NineMatrix::print(char * header /*= ""*/) const
         {
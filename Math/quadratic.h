@@ -188,5 +188,62 @@ namespace CrashAndSqueeze
 
         };
 
+        // A symmetric 9x9 matrix, packed: only its lower triangle is stored, row by row.
+        // Used instead of NineMatrix for the symmetric term of QX shape matching:
+        // it is accumulated from outer products and inverted by LDL' factorization,
+        // which is much cheaper than diagonalizing a NineMatrix.
+        class SymNineMatrix {
+        public:
+            static const int SIZE = NineMatrix::SIZE; // = 9
+            static const int PACKED_SIZE = SIZE*(SIZE + 1)/2; // = 45
+
+        private:
+            Real values[PACKED_SIZE];
+
+            // index of element (i, j), i >= j, in values
+            static int packed_index(int i, int j) { return i*(i + 1)/2 + j; }
+
+            // Factorizes matrix as L*D*transposed(L) in place (!): L (with unit diagonal) is written
+            // into lower triangle, D into diagonal. Returns false, if some D[i] is not
+            // greater than min_pivots[i] (the matrix is not positive definite enough), leaving
+            // the matrix corrupted.
+            bool factorize_ldlt(const Real min_pivots[SIZE]);
+
+        public:
+            explicit SymNineMatrix() {}
+
+            // i, j = [0..9]: (i, j) and (j, i) are the same element
+            Real get_at(int i, int j) const
+            {
+                return (i >= j) ? values[packed_index(i, j)] : values[packed_index(j, i)];
+            }
+            void set_at(int i, int j, Real value)
+            {
+                if(i >= j)
+                    values[packed_index(i, j)] = value;
+                else
+                    values[packed_index(j, i)] = value;
+            }
+            void set_all(const Real &value);
+
+            // adds weight*vector*transposed(vector)
+            void add_outer_product(const TriVector &vector, Real weight);
+
+            // Inverts positive semi-definite (!) matrix in place (!) using LDL' factorization.
+            // If the matrix is nearly singular (e.g. for a flat or linear cluster, which has
+            // linearly dependent quadratic terms), it is regularized first: each diagonal element
+            // is increased by `regularization` times itself (but not less than regularization^2 times
+            // the maximum one), so that the matrix is inverted only in directions where it is
+            // not degenerate. The zero matrix is "inverted" to zero.
+            // Returns false if inverting fails even after regularization.
+            bool invert_sym(Real regularization = DEFAULT_REAL_PRECISION);
+
+            // Multiplication of TriMatrix and SymNineMatrix: yields TriMatrix
+            void left_mult_by(/*in*/  const TriMatrix  & m3,
+                              /*out*/ TriMatrix & res) const;
+
+            void to_nine_matrix(/*out*/ NineMatrix & result) const;
+        };
+
     }
 }
@@ -0,0 +1,43 @@
+#include "Parallel/abstract_task.h"
+#include "Parallel/itask_queue.h"
+#include <cstddef>
+
+namespace CrashAndSqueeze
+{
+    namespace Parallel
+    {
+        AbstractTask::AbstractTask()
+            : _is_complete(false), successors(NULL), successors_num(0), successors_queue(NULL), predecessors_num(0), incomplete_predecessors_num(0)
+        {
+        }
+
+        void AbstractTask::set_successors(AbstractTask ** successors, int successors_num, ITaskQueue * queue)
+        {
+            for(int i = 0; i < this->successors_num; ++i)
+            {
+                --this->successors[i]->predecessors_num;
+                this->successors[i]->reset_dependencies();
+            }
+
+            this->successors = successors;
+            this->successors_num = successors_num;
+            this->successors_queue = queue;
+
+            for(int i = 0; i < successors_num; ++i)
+            {
+                ++successors[i]->predecessors_num;
+                successors[i]->reset_dependencies();
+            }
+        }
+
+        void AbstractTask::release_successors()
+        {
+            for(int i = 0; i < successors_num; ++i)
+            {
+                // the last completed predecessor pushes the successor
+                if( 0 == --successors[i]->incomplete_predecessors_num )
+                    successors_queue->push(successors[i]);
+            }
+        }
+    }
+}
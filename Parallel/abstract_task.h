@@ -1,13 +1,31 @@
 #pragma once
+#include <atomic>
 
 namespace CrashAndSqueeze
 {
     namespace Parallel
     {
+        class ITaskQueue;
+
         class AbstractTask
         {
         private:
-            volatile bool _is_complete;
+            std::atomic<bool> _is_complete;
+
+            // -- dependencies between tasks (for building task graphs) --
+
+            // tasks which cannot be started until this one is completed
+            AbstractTask ** successors;
+            int successors_num;
+            // the queue where successors are pushed when they become ready
+            ITaskQueue * successors_queue;
+
+            // number of tasks which must be completed before this one
+            int predecessors_num;
+            std::atomic<int> incomplete_predecessors_num;
+
+            // pushes to `successors_queue` those successors, which have all their predecessors completed now
+            void release_successors();
         
         protected:
             // Custom implementation of task execution process
@@ -16,7 +34,7 @@ namespace CrashAndSqueeze
             virtual void on_reset() {}
         
         public:
-            AbstractTask() : _is_complete(false) {}
+            AbstractTask();
             bool is_complete() { return _is_complete; }
             
             // This function should be called from a worker thread
@@ -25,6 +43,7 @@ namespace CrashAndSqueeze
             {
                 execute();
                 _is_complete = true;
+                release_successors();
             }
 
             // This functions is called from the main thread to
@@ -35,6 +54,18 @@ namespace CrashAndSqueeze
                 on_reset();
             }
 
+            // Makes this task a predecessor of each of `successors` (replacing previously set ones):
+            // when this task is completed, each of them is pushed to `queue` as soon as all its
+            // predecessors are completed. Thus no task has to wait for another one inside execute().
+            // The array `successors` is not copied and must exist while it is used.
+            void set_successors(AbstractTask ** successors, int successors_num, ITaskQueue * queue);
+
+            int get_predecessors_num() const { return predecessors_num; }
+
+            // Makes the task wait for all its predecessors again: it is called
+            // from the main thread before each pass through a task graph
+            void reset_dependencies() { incomplete_predecessors_num = predecessors_num; }
+
             virtual ~AbstractTask() {}
         };
     }
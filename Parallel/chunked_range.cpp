@@ -0,0 +1,43 @@
+#include "Parallel/chunked_range.h"
+#include "Logging/logger.h"
+
+namespace CrashAndSqueeze
+{
+    using Logging::Logger;
+
+    namespace Parallel
+    {
+        ChunkedRange::ChunkedRange()
+            : first(0), items_num(0), chunk_size(1), chunks_num(0), next_chunk(0)
+        {
+        }
+
+        void ChunkedRange::reset(int first, int items_num, int chunk_size)
+        {
+            if(items_num < 0 || chunk_size <= 0)
+            {
+                Logger::error("in ChunkedRange::reset: items_num must be non-negative and chunk_size must be positive", __FILE__, __LINE__);
+                return;
+            }
+
+            this->first = first;
+            this->items_num = items_num;
+            this->chunk_size = chunk_size;
+            chunks_num = (items_num + chunk_size - 1)/chunk_size;
+            next_chunk = 0;
+        }
+
+        bool ChunkedRange::claim(/*out*/ int & chunk_first, /*out*/ int & chunk_items_num)
+        {
+            // chunks are independent, so the order of claiming doesn't need to be synchronized with anything
+            int chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+            if(chunk >= chunks_num)
+                return false;
+
+            int offset = chunk*chunk_size;
+            chunk_first = first + offset;
+            chunk_items_num = (items_num - offset < chunk_size) ? items_num - offset : chunk_size;
+            return true;
+        }
+    }
+}
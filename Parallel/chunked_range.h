@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+
+namespace CrashAndSqueeze
+{
+    namespace Parallel
+    {
+        // A range of items split into chunks of equal size (except the last one, which may be smaller).
+        // Chunks are claimed one by one by concurrent tasks: each task claims chunks until none is left,
+        // so that faster workers process more chunks and the work is balanced dynamically.
+        //
+        // Claiming is lock-free (one atomic increment per chunk). The range must be reset
+        // before tasks are pushed, not while they are claiming chunks.
+        class ChunkedRange
+        {
+        private:
+            int first;
+            int items_num;
+            int chunk_size;
+            int chunks_num;
+
+            std::atomic<int> next_chunk;
+
+        public:
+            ChunkedRange();
+
+            // Splits items from `first` to `first + items_num - 1` into chunks of `chunk_size` items,
+            // all of them unclaimed
+            void reset(int first, int items_num, int chunk_size);
+
+            // Claims the next chunk and returns true, or returns false if all chunks are already claimed
+            bool claim(/*out*/ int & chunk_first, /*out*/ int & chunk_items_num);
+
+            int get_chunk_size() const { return chunk_size; }
+            int get_chunks_num() const { return chunks_num; }
+
+        private:
+            // No copying!
+            ChunkedRange(const ChunkedRange &);
+            ChunkedRange & operator=(const ChunkedRange &);
+        };
+    }
+}
@@ -6,7 +6,11 @@ namespace CrashAndSqueeze
 {
     namespace Parallel
     {
+        class ITaskQueue;
+        class ITaskExecutor;
+
         // An abstract factory for creating synchronization primitives
+        // (and task queues built on them)
         class IPrimFactory
         {
         public:
@@ -19,6 +23,18 @@ namespace CrashAndSqueeze
             virtual IEventSet * create_event_set(int size, bool initially_set) = 0;
             virtual void destroy_event_set(IEventSet * event_set) = 0;
 
+            // Creates a queue for tasks of `owner` (it is aborted if its task fails
+            // in a thread which is not managed by the owner, see WorkStealingScheduler)
+            virtual ITaskQueue * create_task_queue(int max_size, ITaskExecutor * owner) = 0;
+            virtual void destroy_task_queue(ITaskQueue * task_queue) = 0;
+
+            // Returns the number of threads expected to complete tasks of executors created with
+            // this factory: executors split parallel work into about this number of tasks.
+            // By default returns UNKNOWN_WORKERS_NUM: then executors choose the number themselves
+            virtual int get_workers_num() { return UNKNOWN_WORKERS_NUM; }
+
+            static const int UNKNOWN_WORKERS_NUM = 0;
+
             virtual ~IPrimFactory() {}
         };
     }
@@ -17,6 +17,8 @@ namespace CrashAndSqueeze
 
             // aborts all tasks
             virtual void abort() = 0;
+
+            virtual ~ITaskExecutor() {}
         };
     }
 }
\ No newline at end of file
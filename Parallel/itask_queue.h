@@ -0,0 +1,43 @@
+#pragma once
+#include "Parallel/abstract_task.h"
+
+namespace CrashAndSqueeze
+{
+    namespace Parallel
+    {
+        // An abstract queue (FIFO) of pointers to abstract tasks of fixed maximum size.
+        // Tasks may be pushed and popped from many threads: the main thread pushes
+        // tasks of a step, and worker threads push tasks which become ready
+        // when their predecessors are completed (see AbstractTask::set_successors). Implementations are created by IPrimFactory:
+        // TaskQueue (using a lock) or LockFreeTaskQueue.
+        class ITaskQueue
+        {
+        public:
+            // this function should be called from a worker thread to obtain
+            // the next task to be completed. Returns NULL if no task available.
+            virtual AbstractTask * pop() = 0;
+
+            // this function is called from the main thread (or from a worker completing a predecessor of the task) to add the task to the queue.
+            // If `set_event` is true, then the queue is marked as having tasks after pushing. It is useful to pass false for all tasks except the last.
+            virtual void push(AbstractTask *task, bool set_event = true) = 0;
+
+            // this function is called from the main thread to mark all complete
+            // tasks incomplete again, and return them back to the queue
+            virtual void reset() = 0;
+
+            // remove tasks from queue without completing them
+            virtual void clear() = 0;
+
+            // wait until there are some tasks to pop
+            virtual void wait_for_tasks() = 0;
+            // wait for a given time until there are some tasks to pop (returns true if the task become available, false if time elapsed)
+            virtual bool wait_for_tasks(unsigned milliseconds) = 0;
+
+            virtual bool is_empty() = 0;
+            // true if no more tasks can be pushed until all tasks are popped
+            virtual bool is_full() = 0;
+
+            virtual ~ITaskQueue() {}
+        };
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+
+namespace CrashAndSqueeze
+{
+    namespace Parallel
+    {
+        // A bounded queue (FIFO) of results (copyable values), which can be pushed from many
+        // worker threads and popped from one thread (usually the main one) without locking.
+        //
+        // The queue is a ring of cells. Each cell stores a sequence number, telling whether the cell
+        // is free for the push at given position (sequence == position) or holds an item ready for
+        // the pop at given position (sequence == position + 1), so that an item is never popped
+        // before it is completely written, and a cell is never overwritten before it is popped.
+        template<class T>
+        class LockFreeResultQueue
+        {
+        private:
+            struct Cell
+            {
+                std::atomic<unsigned> sequence;
+                T item;
+            };
+
+            // array of cells (in heap, but fixed size)
+            Cell * cells;
+            // number of cells minus one (number of cells is a power of 2)
+            unsigned mask;
+
+            // position of the next push (claimed by pushing threads with compare-and-swap)
+            std::atomic<unsigned> push_position;
+            // position of the next pop (changed only by the popping thread)
+            std::atomic<unsigned> pop_position;
+
+        public:
+            // creates a queue with at least `max_size` cells
+            LockFreeResultQueue(int max_size);
+
+            // this function is called from any thread to add the item to the queue.
+            // Returns false if the queue is full (then the item is not added)
+            bool push(const T & item);
+
+            // this function is called from one thread to take the first item from the queue.
+            // Returns false if no item available
+            bool pop(/*out*/ T & item);
+
+            bool is_empty() const { return push_position.load() == pop_position.load(); }
+            int get_max_size() const { return static_cast<int>(mask + 1); }
+
+            ~LockFreeResultQueue() { delete[] cells; }
+
+        private:
+            // No copying!
+            LockFreeResultQueue(const LockFreeResultQueue &);
+            LockFreeResultQueue & operator=(const LockFreeResultQueue &);
+        };
+
+        template<class T>
+        LockFreeResultQueue<T>::LockFreeResultQueue(int max_size)
+            : push_position(0), pop_position(0)
+        {
+            unsigned size = 1;
+            while(size < static_cast<unsigned>(max_size))
+                size *= 2;
+
+            mask = size - 1;
+            cells = new Cell[size];
+            for(unsigned i = 0; i < size; ++i)
+            {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        template<class T>
+        bool LockFreeResultQueue<T>::push(const T & item)
+        {
+            unsigned position = push_position.load(std::memory_order_relaxed);
+            for(;;)
+            {
+                Cell & cell = cells[position & mask];
+                unsigned sequence = cell.sequence.load(std::memory_order_acquire);
+                int difference = static_cast<int>(sequence - position);
+                if(0 == difference)
+                {
+                    // the cell is free: claim it (on failure `position` is reloaded)
+                    if(push_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        cell.item = item;
+                        // publish the item for pop()
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if(difference < 0)
+                {
+                    // the cell still holds an item pushed a full ring ago: the queue is full
+                    return false;
+                }
+                else
+                {
+                    // another thread has claimed this position
+                    position = push_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        template<class T>
+        bool LockFreeResultQueue<T>::pop(T & item)
+        {
+            unsigned position = pop_position.load(std::memory_order_relaxed);
+            Cell & cell = cells[position & mask];
+            if(cell.sequence.load(std::memory_order_acquire) != position + 1)
+            {
+                // the queue is empty, or the first item is not written completely yet
+                return false;
+            }
+
+            item = cell.item;
+            // free the cell for the push one ring later
+            cell.sequence.store(position + mask + 1, std::memory_order_release);
+            pop_position.store(position + 1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+}
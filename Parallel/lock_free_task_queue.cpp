@@ -0,0 +1,159 @@
+#include "Parallel/lock_free_task_queue.h"
+#include "Logging/logger.h"
+
+namespace CrashAndSqueeze
+{
+    using Logging::Logger;
+
+    namespace Parallel
+    {
+        LockFreeTaskQueue::LockFreeTaskQueue(int max_size, IPrimFactory * prim_factory)
+            : size(max_size), state(0), prim_factory(prim_factory)
+        {
+            if(size > MAX_SIZE)
+            {
+                Logger::error("in LockFreeTaskQueue::LockFreeTaskQueue: max_size is too big", __FILE__, __LINE__);
+                size = MAX_SIZE;
+            }
+            tasks = new std::atomic<AbstractTask *>[size];
+            for(int i = 0; i < size; ++i)
+                tasks[i] = NULL;
+            has_tasks_event = prim_factory->create_event(false);
+            push_lock = prim_factory->create_lock();
+        }
+
+        LockFreeTaskQueue::State LockFreeTaskQueue::make_state(int first, int count, State tag)
+        {
+            return (tag << TAG_SHIFT) | (static_cast<State>(first) << FIRST_SHIFT) | static_cast<State>(count);
+        }
+
+        void LockFreeTaskQueue::push(AbstractTask * task, bool set_event /*= true*/)
+        {
+            // producers must not write the same slot, but workers still pop without waiting for them
+            push_lock->lock();
+            State old_state = state;
+            for(;;)
+            {
+                int first = get_first(old_state);
+                int count = get_count(old_state);
+                State tag = get_tag(old_state);
+
+                if(first >= count)
+                {
+                    // all tasks are already popped (workers never change the state of empty queue):
+                    // move pointers back to the beginning
+                    first = count = 0;
+                    ++tag;
+                }
+
+                if(count == size)
+                {
+                    push_lock->unlock();
+                    Logger::error("in LockFreeTaskQueue::push: queue is full: it should be cleared after each step", __FILE__, __LINE__);
+                    return;
+                }
+
+                // first store task, then increment count to make it accessible
+                // (if the state has changed meanwhile, e.g. the queue is cleared - try again)
+                tasks[count] = task;
+                if( state.compare_exchange_weak(old_state, make_state(first, count + 1, tag)) )
+                    break;
+            }
+            push_lock->unlock();
+
+            if (set_event)
+            {
+                has_tasks_event->set();
+            }
+        }
+
+        AbstractTask * LockFreeTaskQueue::pop()
+        {
+            State old_state = state;
+            for(;;)
+            {
+                int first = get_first(old_state);
+                int count = get_count(old_state);
+                if(first >= count)
+                    return NULL;
+
+                // read the task before claiming it: after that its slot may be reused by push()
+                AbstractTask * task = tasks[first];
+                if( state.compare_exchange_weak(old_state, make_state(first + 1, count, get_tag(old_state))) )
+                {
+                    if(first + 1 == count)
+                    {
+                        // it was the last task => nothing more to wait for
+                        on_emptied();
+                    }
+                    return task;
+                }
+            }
+        }
+
+        void LockFreeTaskQueue::on_emptied()
+        {
+            has_tasks_event->unset();
+            // a task could be pushed between emptying the queue and unsetting the event
+            if( ! is_empty() )
+                has_tasks_event->set();
+        }
+
+        void LockFreeTaskQueue::reset()
+        {
+            State old_state = state;
+            if( get_first(old_state) < get_count(old_state) )
+            {
+                Logger::error("in LockFreeTaskQueue::reset: queue is not empty", __FILE__, __LINE__);
+                return;
+            }
+
+            // mark popped tasks incomplete before they become accessible again...
+            int count = get_count(old_state);
+            for(int i = 0; i < count; ++i)
+            {
+                static_cast<AbstractTask *>(tasks[i])->reset();
+            }
+            // ...and return them back by reseting `first' index to 0
+            state.compare_exchange_strong(old_state, make_state(0, count, get_tag(old_state) + 1));
+
+            has_tasks_event->set();
+        }
+
+        void LockFreeTaskQueue::clear()
+        {
+            State old_state = state;
+            while( ! state.compare_exchange_weak(old_state, make_state(0, 0, get_tag(old_state) + 1)) ) {}
+            on_emptied();
+        }
+
+        void LockFreeTaskQueue::wait_for_tasks()
+        {
+            has_tasks_event->wait();
+        }
+
+        bool LockFreeTaskQueue::wait_for_tasks(unsigned milliseconds)
+        {
+            return has_tasks_event->wait_for(milliseconds);
+        }
+
+        bool LockFreeTaskQueue::is_empty()
+        {
+            State current_state = state;
+            return get_first(current_state) >= get_count(current_state);
+        }
+
+        bool LockFreeTaskQueue::is_full()
+        {
+            return get_count(state) == size;
+        }
+
+        LockFreeTaskQueue::~LockFreeTaskQueue()
+        {
+            has_tasks_event->unset();
+            delete[] tasks;
+            prim_factory->destroy_event(has_tasks_event);
+            prim_factory->destroy_lock(push_lock);
+        }
+    }
+}
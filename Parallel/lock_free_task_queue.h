@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include "Parallel/itask_queue.h"
+#include "Parallel/iprim_factory.h"
+
+namespace CrashAndSqueeze
+{
+    namespace Parallel
+    {
+        // A queue (FIFO) of pointers to abstract tasks, which can be
+        // popped from many worker threads without locking.
+        // Pushing is serialized with a lock, which is never taken by pop(),
+        // so that tasks can be pushed both from the main thread and from workers.
+        //
+        // Index of the next task to pop and number of pushed tasks are packed
+        // into one atomic word and changed together with compare-and-swap,
+        // so a worker never takes a slot which is not published yet
+        // or which was concurrently cleared.
+        class LockFreeTaskQueue : public ITaskQueue
+        {
+        private:
+            typedef unsigned long long State;
+
+            // array of AbstractTask * (in heap, but fixed size);
+            std::atomic<AbstractTask *> * tasks;
+            int size;
+
+            // Packed state of the queue: number of pushed tasks (bits 0-23), index of the next task
+            // to pop (bits 24-47) and a tag (bits 48-63), which is changed each time the queue is
+            // cleared or reset, so that a worker cannot mistake a refilled queue for an unchanged one
+            std::atomic<State> state;
+
+            static int get_count(State s) { return static_cast<int>(s & INDEX_MASK); }
+            static int get_first(State s) { return static_cast<int>((s >> FIRST_SHIFT) & INDEX_MASK); }
+            static State get_tag(State s) { return s >> TAG_SHIFT; }
+            static State make_state(int first, int count, State tag);
+
+            // factory for creating event objects
+            IPrimFactory * prim_factory;
+            // an event object to notify when there are new tasks available
+            IEvent * has_tasks_event;
+            // a lock object for limiting access to push: only one thread pushes at a time
+            ILock * push_lock;
+
+            // unsets has_tasks_event when the queue becomes empty (and sets it back if some task was pushed concurrently)
+            void on_emptied();
+
+        public:
+            static const int FIRST_SHIFT = 24;
+            static const int TAG_SHIFT = 48;
+            static const State INDEX_MASK = (1ull << FIRST_SHIFT) - 1;
+            // maximum size of LockFreeTaskQueue (limited by the width of packed indices)
+            static const int MAX_SIZE = static_cast<int>(INDEX_MASK);
+
+            LockFreeTaskQueue(int max_size, IPrimFactory * prim_factory);
+
+            // this function should be called from a worker thread to obtain
+            // the next task to be completed. Returns NULL if no task available.
+            virtual AbstractTask * pop();
+
+            // this function is called from the main thread (or from a worker completing a predecessor of the task) to add the task to the queue
+            // If `set_event` is true, then `has_task_event` will be set after pushing. It is useful to pass false for all tasks except the last.
+            // If all pushed tasks are already popped, the queue is cleared before pushing, so that it is never full of already popped tasks.
+            virtual void push(AbstractTask *task, bool set_event = true);
+
+            // this function is called from the main thread to mark all complete
+            // tasks incomplete again, and return them back to the queue
+            virtual void reset();
+
+            // remove tasks from queue without completing them
+            virtual void clear();
+
+            // wait until there are some tasks to pop
+            virtual void wait_for_tasks();
+            // wait for a given time until there are some tasks to pop (returns true if the task become available, false if time elapsed)
+            virtual bool wait_for_tasks(unsigned milliseconds);
+
+            virtual bool is_empty();
+            virtual bool is_full();
+
+            virtual ~LockFreeTaskQueue();
+
+        private:
+            // No copying!
+            LockFreeTaskQueue(const LockFreeTaskQueue &);
+            LockFreeTaskQueue & operator=(const LockFreeTaskQueue &);
+        };
+    }
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Parallel/iprim_factory.h"
+#include "Parallel/task_queue.h"
 
 //
 // Defined here are synchronization primitives that doesn't do
@@ -76,6 +77,12 @@ namespace CrashAndSqueeze
             virtual IEventSet * create_event_set(int size, bool initially_set) { return new SingleThreadEventSet(size, initially_set); }
             virtual void destroy_event_set(IEventSet * event_set) { delete event_set; }
 
+            virtual ITaskQueue * create_task_queue(int max_size, ITaskExecutor * /*owner*/) { return new TaskQueue(max_size, this); }
+            virtual void destroy_task_queue(ITaskQueue * task_queue) { delete task_queue; }
+
+            // tasks are completed by the only thread
+            virtual int get_workers_num() { return 1; }
+
             static SingleThreadFactory instance;
         };
     }
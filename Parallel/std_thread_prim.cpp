@@ -0,0 +1,183 @@
+#include "Parallel/std_thread_prim.h"
+#include "Parallel/worker_pool.h"
+#include "Logging/logger.h"
+#include <chrono>
+
+namespace CrashAndSqueeze
+{
+    using Logging::Logger;
+
+    namespace Parallel
+    {
+        typedef std::unique_lock<std::mutex> MutexLock;
+
+        StdThreadFactory StdThreadFactory::instance;
+
+        ITaskQueue * StdThreadFactory::create_task_queue(int max_size, ITaskExecutor * /*owner*/)
+        {
+            if(lock_free_queues)
+                return new LockFreeTaskQueue(max_size, this);
+            else
+                return new TaskQueue(max_size, this);
+        }
+
+        int StdThreadFactory::get_workers_num()
+        {
+            if(workers_num <= 0)
+                return WorkerPool::get_hardware_threads_num();
+            return workers_num;
+        }
+
+        void StdThreadEvent::set()
+        {
+            MutexLock lock(mutex);
+            is_set = true;
+            condition.notify_all();
+        }
+
+        void StdThreadEvent::unset()
+        {
+            MutexLock lock(mutex);
+            is_set = false;
+        }
+
+        void StdThreadEvent::wait()
+        {
+            MutexLock lock(mutex);
+            while( ! is_set )
+                condition.wait(lock);
+        }
+
+        bool StdThreadEvent::wait_for(unsigned milliseconds)
+        {
+            MutexLock lock(mutex);
+            const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+            while( ! is_set )
+            {
+                if( std::cv_status::timeout == condition.wait_until(lock, deadline) )
+                    return is_set;
+            }
+            return true;
+        }
+
+        StdThreadEventSet::StdThreadEventSet(int size, bool initially_set)
+            : size(size), unset_count(initially_set ? 0 : size)
+        {
+            are_set = new bool[size];
+
+            for(int i = 0; i < size; ++i)
+                are_set[i] = initially_set;
+        }
+
+        bool StdThreadEventSet::check_index(int index)
+        {
+            if(index < 0 || index >= size)
+            {
+                Logger::error("in StdThreadEventSet::check_index: incorrect index passed to set(int), unset(int) or wait(int)", __FILE__, __LINE__);
+                return false;
+            }
+            return true;
+        }
+
+        void StdThreadEventSet::set_unsafe(int index)
+        {
+            if( ! are_set[index] )
+            {
+                are_set[index] = true;
+                --unset_count;
+            }
+        }
+
+        void StdThreadEventSet::unset_unsafe(int index)
+        {
+            if( are_set[index] )
+            {
+                are_set[index] = false;
+                ++unset_count;
+            }
+        }
+
+        void StdThreadEventSet::set(int index)
+        {
+            if( ! check_index(index) )
+                return;
+
+            MutexLock lock(mutex);
+            set_unsafe(index);
+            condition.notify_all();
+        }
+
+        void StdThreadEventSet::unset(int index)
+        {
+            if( ! check_index(index) )
+                return;
+
+            MutexLock lock(mutex);
+            unset_unsafe(index);
+        }
+
+        void StdThreadEventSet::wait(int index)
+        {
+            if( ! check_index(index) )
+                return;
+
+            MutexLock lock(mutex);
+            while( ! are_set[index] )
+                condition.wait(lock);
+        }
+
+        bool StdThreadEventSet::wait_for(int index, unsigned milliseconds)
+        {
+            if( ! check_index(index) )
+                return false;
+
+            MutexLock lock(mutex);
+            const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+            while( ! are_set[index] )
+            {
+                if( std::cv_status::timeout == condition.wait_until(lock, deadline) )
+                    return are_set[index];
+            }
+            return true;
+        }
+
+        void StdThreadEventSet::set()
+        {
+            MutexLock lock(mutex);
+            for(int i = 0; i < size; ++i)
+                set_unsafe(i);
+            condition.notify_all();
+        }
+
+        void StdThreadEventSet::unset()
+        {
+            MutexLock lock(mutex);
+            for(int i = 0; i < size; ++i)
+                unset_unsafe(i);
+        }
+
+        void StdThreadEventSet::wait()
+        {
+            MutexLock lock(mutex);
+            while( unset_count > 0 )
+                condition.wait(lock);
+        }
+
+        bool StdThreadEventSet::wait_for(unsigned milliseconds)
+        {
+            MutexLock lock(mutex);
+            const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+            while( unset_count > 0 )
+            {
+                if( std::cv_status::timeout == condition.wait_until(lock, deadline) )
+                    return 0 == unset_count;
+            }
+            return true;
+        }
+
+        StdThreadEventSet::~StdThreadEventSet()
+        {
+            delete[] are_set;
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <mutex>
+#include <condition_variable>
+#include "Parallel/iprim_factory.h"
+#include "Parallel/task_queue.h"
+#include "Parallel/lock_free_task_queue.h"
+
+//
+// Defined here are synchronization primitives built on top of
+// the standard threading library (std::mutex, std::condition_variable),
+// so that they can be used on any platform with a C++11 compiler
+// (with any threads: std::thread, see Parallel::WorkerPool, or native ones).
+//
+
+namespace CrashAndSqueeze
+{
+    namespace Parallel
+    {
+        // ILock implementation wrapping a std::mutex (non-recursive)
+        class StdThreadLock : public ILock
+        {
+        private:
+            std::mutex mutex;
+        public:
+            virtual void lock()   { mutex.lock();   }
+            virtual void unlock() { mutex.unlock(); }
+        };
+
+        // A manual-reset event: once set, it stays set (and all
+        // waiting threads are released) until unset() is called
+        class StdThreadEvent : public IEvent
+        {
+        private:
+            std::mutex mutex;
+            std::condition_variable condition;
+            bool is_set;
+        public:
+            StdThreadEvent(bool initially_set) : is_set(initially_set) {}
+
+            virtual void set();
+            virtual void unset();
+
+            virtual void wait();
+            // waits for a given amount of time, returns true if event happened and false - if time elapsed, but event did not happen
+            virtual bool wait_for(unsigned milliseconds);
+        };
+
+        // A set of manual-reset events sharing one mutex and condition variable.
+        // Keeps count of unset events, so that waiting for all of them is cheap.
+        class StdThreadEventSet : public IEventSet
+        {
+        private:
+            std::mutex mutex;
+            std::condition_variable condition;
+            int size;
+            bool *are_set;
+            int unset_count;
+
+            bool check_index(int index);
+            // both must be called from within already captured lock
+            void set_unsafe(int index);
+            void unset_unsafe(int index);
+        public:
+            StdThreadEventSet(int size, bool initially_set);
+            virtual void set(int index);
+            virtual void unset(int index);
+            virtual void wait(int index);
+            // waits for a given amount of time, returns true if event happened and false - if time elapsed, but event did not happen
+            virtual bool wait_for(int index, unsigned milliseconds);
+            virtual void set();
+            virtual void unset();
+            virtual void wait();
+            // waits for a given amount of time, returns true if event happened and false - if time elapsed, but event did not happen
+            virtual bool wait_for(unsigned milliseconds);
+
+            virtual ~StdThreadEventSet();
+        };
+
+        // A factory for these primitives which allocates them dynamically in heap.
+        // Task queues created by it are lock-free (LockFreeTaskQueue) unless
+        // `lock_free_queues` is false: then locking TaskQueue is used.
+        // `workers_num` is the number of threads completing the tasks (e.g. of WorkerPool),
+        // or HARDWARE_THREADS for as many as hardware supports.
+        class StdThreadFactory : public IPrimFactory
+        {
+        private:
+            bool lock_free_queues;
+            int workers_num;
+        public:
+            // Default value for constructor, meaning "as many threads as hardware supports"
+            static const int HARDWARE_THREADS = -1;
+
+            StdThreadFactory(bool lock_free_queues = true, int workers_num = HARDWARE_THREADS)
+                : lock_free_queues(lock_free_queues), workers_num(workers_num) {}
+
+            virtual ILock * create_lock() { return new StdThreadLock(); }
+            virtual void destroy_lock(ILock * lock) { delete lock; }
+
+            virtual IEvent * create_event(bool initially_set) { return new StdThreadEvent(initially_set); }
+            virtual void destroy_event(IEvent * event) { delete event; }
+
+            virtual IEventSet * create_event_set(int size, bool initially_set) { return new StdThreadEventSet(size, initially_set); }
+            virtual void destroy_event_set(IEventSet * event_set) { delete event_set; }
+
+            virtual ITaskQueue * create_task_queue(int max_size, ITaskExecutor * owner);
+            virtual void destroy_task_queue(ITaskQueue * task_queue) { delete task_queue; }
+
+            virtual int get_workers_num();
+
+            static StdThreadFactory instance;
+        };
+    }
+}
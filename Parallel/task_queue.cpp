@@ -17,15 +17,23 @@ namespace CrashAndSqueeze
 
         void TaskQueue::push(AbstractTask * task, bool set_event /*= true*/)
         {
+            pop_lock->lock();
+            if( is_empty() )
+            {
+                // all tasks are already popped: move pointers back to the beginning
+                first = 0;
+                last = -1;
+            }
+
             if( is_full())
             {
+                pop_lock->unlock();
                 Logger::error("in TaskQueue::push: queue is full: it should be cleared after each step", __FILE__, __LINE__);
                 return;
             }
 
             // first store task, then increment index to make it accessible
             tasks[last+1] = task;
-            pop_lock->lock();
             ++last;
 
             if (set_event)
@@ -46,8 +54,9 @@ namespace CrashAndSqueeze
 
                 if (is_empty())
                 {
-                    // if it was the las task => call clear to reset queue to its initial state with pointers at the beginning
-                    clear_unsafe();
+                    // if it was the last task => nothing more to wait for. Pointers are left as they are, so that
+                    // popped tasks can be returned with reset(), and are moved to the beginning on next push()
+                    has_tasks_event->unset();
                 }
             }
             pop_lock->unlock();
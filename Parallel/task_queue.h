@@ -1,5 +1,5 @@
 #pragma once
-#include "Parallel/abstract_task.h"
+#include "Parallel/itask_queue.h"
 #include "Parallel/iprim_factory.h"
 
 namespace CrashAndSqueeze
@@ -7,9 +7,9 @@ namespace CrashAndSqueeze
     namespace Parallel
     {
         // A queue (FIFO) of pointers to abstract tasks.
-        // Only one thread pushes tasks to the queue, but they may
-        // be popped from many worker threads.
-        class TaskQueue
+        // Tasks may be pushed and popped from many threads.
+        // Both pushing and popping is done under the lock (see LockFreeTaskQueue for lock-free implementation).
+        class TaskQueue : public ITaskQueue
         {
         private:
             // array of AbstractTask * (in heap, but fixed size);
@@ -22,7 +22,7 @@ namespace CrashAndSqueeze
             
             // factory for creating lock objects
             IPrimFactory * prim_factory;
-            // a lock object for limiting access to pop: only one thread pops at a time
+            // a lock object for limiting access to push and pop: only one thread changes the queue at a time
             ILock * pop_lock;
             // an event object to notify when there are new tasks available
             IEvent * has_tasks_event;
@@ -34,29 +34,29 @@ namespace CrashAndSqueeze
 
             // this function should be called from a worker thread to obtain
             // the next task to be completed. Returns NULL if no task available.
-            AbstractTask * pop();
+            virtual AbstractTask * pop();
 
-            // this function is called from the main thread to add the task to the queue
-            // NB: this function is not reentrant! It is assumed that pushing tasks happens only from one thread (but popping can be done from many threads).
+            // this function is called from the main thread (or from a worker completing a predecessor of the task) to add the task to the queue
             // If `set_event` is true, then `has_task_event` will be set after pushing. It is useful to pass false for all tasks except the last.
-            void push(AbstractTask *task, bool set_event = true);
+            // If all pushed tasks are already popped, the queue is cleared before pushing, so that it is never full of already popped tasks.
+            virtual void push(AbstractTask *task, bool set_event = true);
 
             // this function is called from the main thread to mark all complete
             // tasks incomplete again, and return them back to the queue
-            void reset();
+            virtual void reset();
 
             // remove tasks from queue without completing them
-            void clear();
+            virtual void clear();
 
             // wait until there are some tasks to pop
-            void wait_for_tasks();
+            virtual void wait_for_tasks();
             // wait for a given time until there are some tasks to pop (returns true if the task become available, false if time elapsed)
-            bool wait_for_tasks(unsigned milliseconds);
+            virtual bool wait_for_tasks(unsigned milliseconds);
 
-            bool is_empty() { return first > last; }
-            bool is_full() { return last == size - 1; }
+            virtual bool is_empty() { return first > last; }
+            virtual bool is_full() { return last == size - 1; }
 
-            ~TaskQueue();
+            virtual ~TaskQueue();
         };
     }
 }
@@ -0,0 +1,405 @@
+#include "Parallel/work_stealing_scheduler.h"
+#include "Parallel/worker_pool.h"
+#include "Logging/logger.h"
+
+namespace CrashAndSqueeze
+{
+    using Logging::Logger;
+
+    namespace Parallel
+    {
+        typedef std::lock_guard<std::mutex> MutexGuard;
+
+        namespace
+        {
+            // the scheduler, whose worker is the current thread (if any), and the index of the worker
+            thread_local const WorkStealingScheduler * current_scheduler = NULL;
+            thread_local int current_worker_index = 0;
+
+            // returns a pseudo-random number (xorshift), changing the state
+            unsigned next_random(/*in/out*/ unsigned & state)
+            {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                return state;
+            }
+        }
+
+        // -- SchedulerQueue --
+
+        WorkStealingScheduler::SchedulerQueue::SchedulerQueue(WorkStealingScheduler * scheduler, int max_size, ITaskExecutor * owner)
+            : scheduler(scheduler), owner(owner), size(max_size), pushed_count(0), queued_count(0)
+        {
+            pushed_tasks = new AbstractTask*[size];
+            // one more for the shared deque
+            deque_counts = new std::atomic<int>[scheduler->deques_num + 1];
+            for(int i = 0; i <= scheduler->deques_num; ++i)
+            {
+                deque_counts[i] = 0;
+            }
+            has_tasks_event = scheduler->create_event(false);
+        }
+
+        void WorkStealingScheduler::SchedulerQueue::push(AbstractTask * task, bool set_event /*= true*/)
+        {
+            std::unique_lock<std::mutex> lock(push_mutex);
+            if( is_empty() )
+            {
+                // all tasks are already taken: start from the beginning
+                pushed_count = 0;
+            }
+
+            if( is_full() )
+            {
+                lock.unlock();
+                Logger::error("in WorkStealingScheduler::SchedulerQueue::push: queue is full: it should be cleared after each step", __FILE__, __LINE__);
+                return;
+            }
+
+            pushed_tasks[pushed_count++] = task;
+
+            // first count task, then make it accessible
+            ++queued_count;
+            Entry entry = { this, task };
+            scheduler->push_entry(scheduler->get_push_deque(), entry);
+
+            if (set_event)
+            {
+                lock.unlock();
+                has_tasks_event->set();
+            }
+        }
+
+        AbstractTask * WorkStealingScheduler::SchedulerQueue::pop()
+        {
+            Entry entry;
+            if( scheduler->take_entry_of(this, entry) )
+                return entry.task;
+            else
+                return NULL;
+        }
+
+        void WorkStealingScheduler::SchedulerQueue::on_removed(int count)
+        {
+            if( 0 == (queued_count -= count) )
+            {
+                on_emptied();
+            }
+        }
+
+        void WorkStealingScheduler::SchedulerQueue::on_emptied()
+        {
+            has_tasks_event->unset();
+            // a task could be pushed between emptying the queue and unsetting the event
+            if( ! is_empty() )
+                has_tasks_event->set();
+        }
+
+        void WorkStealingScheduler::SchedulerQueue::reset()
+        {
+            std::unique_lock<std::mutex> lock(push_mutex);
+            if( ! is_empty() )
+            {
+                lock.unlock();
+                Logger::error("in WorkStealingScheduler::SchedulerQueue::reset: queue is not empty", __FILE__, __LINE__);
+                return;
+            }
+
+            // return all pushed tasks back
+            int index = scheduler->get_push_deque();
+            for(int i = 0; i < pushed_count; ++i)
+            {
+                pushed_tasks[i]->reset();
+                ++queued_count;
+                Entry entry = { this, pushed_tasks[i] };
+                scheduler->push_entry(index, entry);
+            }
+            lock.unlock();
+            has_tasks_event->set();
+        }
+
+        void WorkStealingScheduler::SchedulerQueue::clear()
+        {
+            {
+                MutexGuard guard(push_mutex);
+                scheduler->remove_entries_of(this);
+                pushed_count = 0;
+            }
+            on_emptied();
+        }
+
+        void WorkStealingScheduler::SchedulerQueue::wait_for_tasks()
+        {
+            has_tasks_event->wait();
+        }
+
+        bool WorkStealingScheduler::SchedulerQueue::wait_for_tasks(unsigned milliseconds)
+        {
+            return has_tasks_event->wait_for(milliseconds);
+        }
+
+        WorkStealingScheduler::SchedulerQueue::~SchedulerQueue()
+        {
+            scheduler->remove_entries_of(this);
+            delete[] pushed_tasks;
+            delete[] deque_counts;
+            scheduler->destroy_event(has_tasks_event);
+        }
+
+        // -- WorkStealingScheduler --
+
+        WorkStealingScheduler::WorkStealingScheduler(int threads_num /*= HARDWARE_THREADS*/)
+            : threads(NULL), threads_num(0), stopped(true), queued_count(0), errors_count(0)
+        {
+            if(HARDWARE_THREADS == threads_num)
+                threads_num = WorkerPool::get_hardware_threads_num();
+            if(threads_num <= 0)
+            {
+                Logger::error("in WorkStealingScheduler::WorkStealingScheduler: threads_num must be positive", __FILE__, __LINE__);
+                threads_num = 1;
+            }
+            deques_num = threads_num;
+            // one more for the shared deque
+            deques = new WorkerDeque[deques_num + 1];
+        }
+
+        ITaskQueue * WorkStealingScheduler::create_task_queue(int max_size, ITaskExecutor * owner)
+        {
+            return new SchedulerQueue(this, max_size, owner);
+        }
+
+        void WorkStealingScheduler::start()
+        {
+            if(is_started())
+            {
+                Logger::error("in WorkStealingScheduler::start: the scheduler is already started, call stop() first", __FILE__, __LINE__);
+                return;
+            }
+
+            stopped = false;
+            threads_num = deques_num;
+            threads = new std::thread[threads_num];
+            for(int i = 0; i < threads_num; ++i)
+            {
+                threads[i] = std::thread(&WorkStealingScheduler::work, this, i);
+            }
+        }
+
+        void WorkStealingScheduler::stop()
+        {
+            if( ! is_started() )
+                return;
+
+            {
+                MutexGuard guard(sleep_mutex);
+                stopped = true;
+            }
+            has_tasks.notify_all();
+
+            for(int i = 0; i < threads_num; ++i)
+            {
+                threads[i].join();
+            }
+            delete[] threads;
+            threads = NULL;
+            threads_num = 0;
+        }
+
+        int WorkStealingScheduler::get_push_deque() const
+        {
+            return (this == current_scheduler) ? current_worker_index : get_shared_deque();
+        }
+
+        void WorkStealingScheduler::push_entry(int deque_index, const Entry & entry)
+        {
+            {
+                MutexGuard guard(deques[deque_index].mutex);
+                deques[deque_index].entries.push_back(entry);
+                ++entry.queue->get_count_in_deque(deque_index);
+            }
+            {
+                // counter is changed under the lock, so that a worker going to sleep doesn't miss it
+                MutexGuard guard(sleep_mutex);
+                ++queued_count;
+            }
+            has_tasks.notify_one();
+        }
+
+        bool WorkStealingScheduler::take_entry(int deque_index, bool from_bottom, /*out*/ Entry & entry)
+        {
+            {
+                MutexGuard guard(deques[deque_index].mutex);
+                std::deque<Entry> & entries = deques[deque_index].entries;
+                if( entries.empty() )
+                    return false;
+                if( from_bottom )
+                {
+                    entry = entries.back();
+                    entries.pop_back();
+                }
+                else
+                {
+                    entry = entries.front();
+                    entries.pop_front();
+                }
+                --entry.queue->get_count_in_deque(deque_index);
+            }
+            --queued_count;
+            entry.queue->on_removed(1);
+            return true;
+        }
+
+        bool WorkStealingScheduler::steal_entry(int worker_index, /*in/out*/ unsigned & random_state, /*out*/ Entry & entry)
+        {
+            if( deques_num < 2 )
+                return false;
+
+            // try all other workers, starting with a random one
+            int first_victim = static_cast<int>( next_random(random_state) % static_cast<unsigned>(deques_num - 1) );
+            for(int i = 0; i < deques_num - 1; ++i)
+            {
+                // skip own deque
+                int victim = (worker_index + 1 + (first_victim + i) % (deques_num - 1)) % deques_num;
+                if( take_entry(victim, false, entry) )
+                    return true;
+            }
+            return false;
+        }
+
+        bool WorkStealingScheduler::take_entry_of(SchedulerQueue * queue, /*out*/ Entry & entry)
+        {
+            // look into own deque first (from the bottom, as its owner does), then into the shared one, then into others
+            int own_deque = get_push_deque();
+            for(int i = 0; i <= deques_num; ++i)
+            {
+                int deque_index = (own_deque + i) % (deques_num + 1);
+                if( 0 == queue->get_count_in_deque(deque_index) )
+                    continue;
+
+                bool from_bottom = (deque_index == own_deque && deque_index != get_shared_deque());
+                bool found = false;
+                {
+                    MutexGuard guard(deques[deque_index].mutex);
+                    std::deque<Entry> & entries = deques[deque_index].entries;
+                    if( from_bottom )
+                    {
+                        for(std::deque<Entry>::reverse_iterator it = entries.rbegin(); it != entries.rend(); ++it)
+                        {
+                            if(it->queue == queue)
+                            {
+                                entry = *it;
+                                std::deque<Entry>::iterator position = it.base();
+                                entries.erase(--position);
+                                found = true;
+                                break;
+                            }
+                        }
+                    }
+                    else
+                    {
+                        for(std::deque<Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+                        {
+                            if(it->queue == queue)
+                            {
+                                entry = *it;
+                                entries.erase(it);
+                                found = true;
+                                break;
+                            }
+                        }
+                    }
+                    if(found)
+                        --queue->get_count_in_deque(deque_index);
+                }
+                if(found)
+                {
+                    --queued_count;
+                    queue->on_removed(1);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void WorkStealingScheduler::remove_entries_of(SchedulerQueue * queue)
+        {
+            int removed_count = 0;
+            for(int i = 0; i <= deques_num; ++i)
+            {
+                if( 0 == queue->get_count_in_deque(i) )
+                    continue;
+
+                MutexGuard guard(deques[i].mutex);
+                std::deque<Entry> & entries = deques[i].entries;
+                for(std::deque<Entry>::iterator it = entries.begin(); it != entries.end(); )
+                {
+                    if(it->queue == queue)
+                    {
+                        it = entries.erase(it);
+                        ++removed_count;
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+                queue->get_count_in_deque(i) = 0;
+            }
+            if(removed_count > 0)
+            {
+                queued_count -= removed_count;
+                queue->on_removed(removed_count);
+            }
+        }
+
+        void WorkStealingScheduler::complete(const Entry & entry)
+        {
+            try
+            {
+                entry.task->complete();
+            }
+            catch(...)
+            {
+                ++errors_count;
+                if(NULL != entry.queue->get_owner())
+                    entry.queue->get_owner()->abort();
+            }
+        }
+
+        void WorkStealingScheduler::work(int worker_index)
+        {
+            current_scheduler = this;
+            current_worker_index = worker_index;
+            unsigned random_state = 2654435761u*static_cast<unsigned>(worker_index + 1);
+
+            Entry entry;
+            while( ! stopped )
+            {
+                // take the last pushed task from own deque first, then the first one from the shared deque,
+                // then try to steal from others
+                bool found = take_entry(worker_index, true, entry)
+                             || take_entry(get_shared_deque(), false, entry)
+                             || steal_entry(worker_index, random_state, entry);
+
+                if(found)
+                {
+                    complete(entry);
+                }
+                else
+                {
+                    std::unique_lock<std::mutex> lock(sleep_mutex);
+                    while( 0 == queued_count && ! stopped )
+                        has_tasks.wait(lock);
+                }
+            }
+            current_scheduler = NULL;
+        }
+
+        WorkStealingScheduler::~WorkStealingScheduler()
+        {
+            stop();
+            delete[] deques;
+        }
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include "Parallel/std_thread_prim.h"
+#include "Parallel/itask_queue.h"
+#include "Parallel/itask_executor.h"
+
+namespace CrashAndSqueeze
+{
+    namespace Parallel
+    {
+        // A pool of worker threads, which completes tasks of many executors
+        // (e.g. instances of Core::Model) with work stealing. Pass it as IPrimFactory
+        // when creating executors: tasks they push to their task queues
+        // go to the scheduler, so that each worker has its own deque of tasks
+        // (of any executors). Executors can still complete their tasks
+        // from other threads calling ITaskExecutor::complete_next_task.
+        //
+        // A task pushed by a worker (e.g. a successor released by a task it has just completed,
+        // see AbstractTask::set_successors) goes to the bottom of the worker's own deque, and the
+        // worker takes tasks from there first (last pushed first), so it continues with data
+        // which is still in its cache. Tasks pushed by other threads (e.g. the main one) go to
+        // a shared deque, and are taken from it in the order they were pushed. When both are empty,
+        // the worker steals the oldest task from the top of a randomly chosen other worker, and
+        // sleeps only when there are no tasks at all.
+        //
+        // If completing a task fails (an exception is thrown, e.g. by Logger::error),
+        // its executor is aborted and the worker goes on with other tasks.
+        //
+        // NB: executors must be destroyed before the scheduler.
+        class WorkStealingScheduler : public StdThreadFactory
+        {
+        private:
+            class SchedulerQueue;
+
+            struct Entry
+            {
+                SchedulerQueue * queue;
+                AbstractTask * task;
+            };
+
+            // a deque of entries: its owner pushes and takes them at the bottom (back), thieves take them at the top (front)
+            struct WorkerDeque
+            {
+                std::mutex mutex;
+                std::deque<Entry> entries;
+            };
+
+            // Task queue of one executor: stores its tasks in deques of the scheduler
+            class SchedulerQueue : public ITaskQueue
+            {
+            private:
+                WorkStealingScheduler * scheduler;
+                ITaskExecutor * owner;
+
+                // all tasks pushed since the queue was empty (for reset)
+                AbstractTask ** pushed_tasks;
+                int size;
+                int pushed_count;
+                // a lock for the fields above: the queue can be cleared from a worker thread (on abort)
+                std::mutex push_mutex;
+
+                // number of pushed tasks, which are not taken from deques yet
+                std::atomic<int> queued_count;
+                // the same for each deque of the scheduler, so that only deques having
+                // tasks of this queue are searched (changed under the lock of the deque)
+                std::atomic<int> * deque_counts;
+                IEvent * has_tasks_event;
+
+                void on_emptied();
+
+            public:
+                SchedulerQueue(WorkStealingScheduler * scheduler, int max_size, ITaskExecutor * owner);
+
+                ITaskExecutor * get_owner() { return owner; }
+                std::atomic<int> & get_count_in_deque(int deque_index) { return deque_counts[deque_index]; }
+                // called by the scheduler when `count` tasks of this queue are taken or removed from deques
+                void on_removed(int count);
+
+                // -- implement ITaskQueue --
+                virtual AbstractTask * pop();
+                virtual void push(AbstractTask *task, bool set_event = true);
+                virtual void reset();
+                virtual void clear();
+                virtual void wait_for_tasks();
+                virtual bool wait_for_tasks(unsigned milliseconds);
+                virtual bool is_empty() { return 0 == queued_count; }
+                virtual bool is_full() { return pushed_count == size; }
+
+                virtual ~SchedulerQueue();
+            };
+
+            // deques of workers, followed by the shared deque for tasks pushed by other threads
+            WorkerDeque * deques;
+            // number of workers
+            int deques_num;
+
+            std::thread *threads;
+            int threads_num;
+            std::atomic<bool> stopped;
+
+            // total number of tasks in all deques
+            std::atomic<int> queued_count;
+            // used by idle workers to sleep until some task is pushed
+            std::mutex sleep_mutex;
+            std::condition_variable has_tasks;
+
+            std::atomic<int> errors_count;
+
+            // -- used by SchedulerQueue --
+
+            // returns the own deque of the calling thread, if it is a worker of this scheduler, otherwise the shared deque
+            int get_push_deque() const;
+            // pushes the entry to the bottom of given deque
+            void push_entry(int deque_index, const Entry & entry);
+            // takes a task of `queue` (searching only deques having its tasks), returns false if none
+            bool take_entry_of(SchedulerQueue * queue, /*out*/ Entry & entry);
+            // removes all tasks of `queue` from all deques
+            void remove_entries_of(SchedulerQueue * queue);
+
+            int get_shared_deque() const { return deques_num; }
+            // takes a task from the bottom (the last pushed one) or the top (the first pushed one)
+            // of given deque, returns false if none
+            bool take_entry(int deque_index, bool from_bottom, /*out*/ Entry & entry);
+            // takes a task from the top of another worker's deque, starting with a random one
+            bool steal_entry(int worker_index, /*in/out*/ unsigned & random_state, /*out*/ Entry & entry);
+            void complete(const Entry & entry);
+
+            // a loop executed by each worker thread
+            void work(int worker_index);
+
+        public:
+            // Creates a scheduler with `threads_num` workers (or as many as hardware supports, if HARDWARE_THREADS is given).
+            // Workers are not started until start() is called.
+            WorkStealingScheduler(int threads_num = HARDWARE_THREADS);
+
+            // Starts worker threads
+            void start();
+            // Stops all worker threads and waits for them to finish their current tasks
+            void stop();
+
+            bool is_started() const { return NULL != threads; }
+            int get_threads_num() const { return deques_num; }
+
+            // Returns the number of tasks failed since the scheduler was created
+            int get_errors_count() const { return errors_count; }
+
+            // -- implement IPrimFactory --
+            virtual ITaskQueue * create_task_queue(int max_size, ITaskExecutor * owner);
+            virtual void destroy_task_queue(ITaskQueue * task_queue) { delete task_queue; }
+            virtual int get_workers_num() { return deques_num; }
+
+            // Default value for constructor, meaning "as many threads as hardware supports"
+            static const int HARDWARE_THREADS = -1;
+
+            virtual ~WorkStealingScheduler();
+
+        private:
+            // No copying!
+            WorkStealingScheduler(const WorkStealingScheduler &);
+            WorkStealingScheduler & operator=(const WorkStealingScheduler &);
+        };
+    }
+}
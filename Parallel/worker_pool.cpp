@@ -0,0 +1,122 @@
+#include "Parallel/worker_pool.h"
+#include "Logging/logger.h"
+#include <chrono>
+
+namespace CrashAndSqueeze
+{
+    using Logging::Logger;
+
+    namespace Parallel
+    {
+        typedef std::lock_guard<std::mutex> MutexGuard;
+
+        WorkerPool::WorkerPool(unsigned max_wait_ms /*= DEFAULT_MAX_WAIT_MS*/)
+            : threads(NULL), threads_num(0), stopped(true), max_wait_ms(max_wait_ms), errors_count(0)
+        {
+        }
+
+        int WorkerPool::get_hardware_threads_num()
+        {
+            int num = static_cast<int>( std::thread::hardware_concurrency() );
+            return (num > 0) ? num : 1;
+        }
+
+        void WorkerPool::add_executor(ITaskExecutor * executor)
+        {
+            if(NULL == executor)
+            {
+                Logger::error("in WorkerPool::add_executor: null pointer given", __FILE__, __LINE__);
+                return;
+            }
+            MutexGuard guard(executors_mutex);
+            executors.push_back(executor);
+        }
+
+        ITaskExecutor * WorkerPool::get_executor(int index)
+        {
+            MutexGuard guard(executors_mutex);
+            return executors[index];
+        }
+
+        int WorkerPool::get_executors_num()
+        {
+            MutexGuard guard(executors_mutex);
+            return executors.size();
+        }
+
+        void WorkerPool::start(int threads_num /*= HARDWARE_THREADS*/)
+        {
+            if(is_started())
+            {
+                Logger::error("in WorkerPool::start: the pool is already started, call stop() first", __FILE__, __LINE__);
+                return;
+            }
+            if(HARDWARE_THREADS == threads_num)
+                threads_num = get_hardware_threads_num();
+            if(threads_num <= 0)
+            {
+                Logger::error("in WorkerPool::start: threads_num must be positive", __FILE__, __LINE__);
+                return;
+            }
+
+            stopped = false;
+            this->threads_num = threads_num;
+            threads = new std::thread[threads_num];
+            for(int i = 0; i < threads_num; ++i)
+            {
+                threads[i] = std::thread(&WorkerPool::work, this);
+            }
+        }
+
+        void WorkerPool::stop()
+        {
+            if( ! is_started() )
+                return;
+
+            stopped = true;
+            for(int i = 0; i < threads_num; ++i)
+            {
+                threads[i].join();
+            }
+            delete[] threads;
+            threads = NULL;
+            threads_num = 0;
+        }
+
+        void WorkerPool::work()
+        {
+            while( ! stopped )
+            {
+                int executors_num = get_executors_num();
+                if(0 == executors_num)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(max_wait_ms));
+                    continue;
+                }
+
+                for(int i = 0; i < executors_num && ! stopped; ++i)
+                {
+                    ITaskExecutor * executor = get_executor(i);
+                    try
+                    {
+                        if( false == executor->wait_for_tasks(max_wait_ms) )
+                            continue;
+
+                        // complete tasks of this executor while there are some
+                        while( ! stopped && false != executor->complete_next_task() ) {}
+                    }
+                    catch(...)
+                    {
+                        ++errors_count;
+                        executor->abort();
+                    }
+                }
+            }
+        }
+
+        WorkerPool::~WorkerPool()
+        {
+            stop();
+        }
+    }
+}
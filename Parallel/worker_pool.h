@@ -0,0 +1,76 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include "Parallel/itask_executor.h"
+#include "Collections/array.h"
+
+namespace CrashAndSqueeze
+{
+    namespace Parallel
+    {
+        // A pool of worker threads (std::thread), each of which repeatedly takes
+        // tasks from all added executors (e.g. instances of Core::Model) and completes them,
+        // until the pool is stopped. Use it together with StdThreadFactory (or another
+        // thread-safe IPrimFactory) passed to executors on their creation.
+        //
+        // If completing a task fails (an exception is thrown, e.g. by Logger::error),
+        // the executor is aborted and the worker goes on with other tasks.
+        //
+        // NB: executors must not be destroyed while the pool is running: call stop() first.
+        class WorkerPool
+        {
+        private:
+            std::thread *threads;
+            int threads_num;
+
+            std::atomic<bool> stopped;
+            // how long to wait for tasks of one executor before trying the next one
+            unsigned max_wait_ms;
+
+            Collections::Array<ITaskExecutor *> executors;
+            // a lock for accessing `executors`, which can be added while threads are running
+            std::mutex executors_mutex;
+
+            std::atomic<int> errors_count;
+
+            ITaskExecutor * get_executor(int index);
+            int get_executors_num();
+
+            // a loop executed by each worker thread
+            void work();
+
+        public:
+            static const unsigned DEFAULT_MAX_WAIT_MS = 1;
+            // Default value for `start`, meaning "as many threads as hardware supports"
+            static const int HARDWARE_THREADS = -1;
+
+            WorkerPool(unsigned max_wait_ms = DEFAULT_MAX_WAIT_MS);
+
+            // Adds an executor to be served by workers. It can be done both before and after start().
+            void add_executor(ITaskExecutor * executor);
+
+            // Starts `threads_num` worker threads (or as many as hardware supports, if HARDWARE_THREADS is given)
+            void start(int threads_num = HARDWARE_THREADS);
+
+            // Stops all worker threads and waits for them to finish their current tasks
+            void stop();
+
+            bool is_started() const { return NULL != threads; }
+            int get_threads_num() const { return threads_num; }
+
+            // Returns the number of tasks failed since the pool was created
+            int get_errors_count() const { return errors_count; }
+
+            // Returns the number of concurrent threads supported by hardware (at least one)
+            static int get_hardware_threads_num();
+
+            ~WorkerPool();
+
+        private:
+            // No copying!
+            WorkerPool(const WorkerPool &);
+            WorkerPool & operator=(const WorkerPool &);
+        };
+    }
+}
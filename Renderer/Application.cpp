@@ -60,7 +60,7 @@ Application::Application(Logger &logger) :
     renderer(window, &camera),
     emulation_enabled(true), emultate_one_step(true), forces_enabled(false),
     vertices_update_needed(false), impact_region(NULL), impact_happened(false),
-    forces(NULL), logger(logger), impact_model(NULL), prim_factory(false),
+    forces(NULL), logger(logger), impact_model(NULL), prim_factory(false, THREADS_COUNT),
     impact_axis(0), total_performance_reporter(logger, "total")
 {
     sim_settings.set_defaults(); // TODO: load from config file
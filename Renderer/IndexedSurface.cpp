@@ -74,6 +74,12 @@ ISurface::TriangleIterator * IndexedSurface::get_triangles()
     return new IndexedSurfaceTriangleIterator(triangles);
 }
 
+ISurface::TriangleArray IndexedSurface::get_triangle_array()
+{
+    TriangleArray result = {triangles.empty() ? NULL : &triangles[0], static_cast<int>(triangles.size())};
+    return result;
+}
+
 
 IndexedSurface::~IndexedSurface()
 {
@@ -16,6 +16,9 @@ public:
     // Deallocates the iterator when it is no longer needed
     virtual void destroy_iterator(TriangleIterator * iterator) override { delete iterator; }
 
+    // Returns triangles stored in vector
+    virtual TriangleArray get_triangle_array() override;
+
     virtual ~IndexedSurface();
 };
 
@@ -105,8 +105,8 @@ namespace
 }
 
 // -- Factory --
-WinFactory::WinFactory(bool detect_dead_locks)
-: detect_dead_locks(detect_dead_locks)
+WinFactory::WinFactory(bool detect_dead_locks, int workers_num)
+: detect_dead_locks(detect_dead_locks), workers_num(workers_num)
 {
 }
 
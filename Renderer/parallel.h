@@ -1,6 +1,7 @@
 #pragma once
 #include "main.h"
 #include "Parallel/iprim_factory.h"
+#include "Parallel/task_queue.h"
 
 using CrashAndSqueeze::Parallel::ILock;
 using CrashAndSqueeze::Parallel::IEvent;
@@ -19,12 +20,14 @@ public:
     ~WinLock() { DeleteCriticalSection(&cs); }
 };
 
+// `workers_num` is the number of threads completing tasks of models created with this factory
 class WinFactory : public CrashAndSqueeze::Parallel::IPrimFactory
 {
 private:
     bool detect_dead_locks;
+    int workers_num;
 public:
-    WinFactory(bool detect_dead_locks);
+    WinFactory(bool detect_dead_locks, int workers_num);
 
     virtual ILock * create_lock();
     virtual void destroy_lock(ILock * lock) { delete lock; }
@@ -34,4 +37,9 @@ public:
     
     virtual IEventSet * create_event_set(int size, bool initially_set);
     virtual void destroy_event_set(IEventSet * event_set) { delete event_set; }
+
+    virtual CrashAndSqueeze::Parallel::ITaskQueue * create_task_queue(int max_size, CrashAndSqueeze::Parallel::ITaskExecutor * /*owner*/) { return new CrashAndSqueeze::Parallel::TaskQueue(max_size, this); }
+    virtual void destroy_task_queue(CrashAndSqueeze::Parallel::ITaskQueue * task_queue) { delete task_queue; }
+
+    virtual int get_workers_num() { return workers_num; }
 };
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "tools_tester.h"
+#include "Parallel/chunked_range.h"
+#include <thread>
+#include <atomic>
+
+using namespace CrashAndSqueeze::Parallel;
+
+TEST(ChunkedRangeTest, Init)
+{
+    ChunkedRange range;
+    int first, num;
+    EXPECT_EQ(0, range.get_chunks_num());
+    EXPECT_FALSE(range.claim(first, num));
+}
+
+TEST(ChunkedRangeTest, ClaimAll)
+{
+    ChunkedRange range;
+    range.reset(5, 23, 10);
+    EXPECT_EQ(3, range.get_chunks_num());
+
+    int first, num;
+    ASSERT_TRUE(range.claim(first, num));
+    EXPECT_EQ(5, first);
+    EXPECT_EQ(10, num);
+    ASSERT_TRUE(range.claim(first, num));
+    EXPECT_EQ(15, first);
+    EXPECT_EQ(10, num);
+    // the last chunk is smaller
+    ASSERT_TRUE(range.claim(first, num));
+    EXPECT_EQ(25, first);
+    EXPECT_EQ(3, num);
+    EXPECT_FALSE(range.claim(first, num));
+    EXPECT_FALSE(range.claim(first, num));
+}
+
+TEST(ChunkedRangeTest, Reset)
+{
+    ChunkedRange range;
+    range.reset(0, 20, 10);
+    int first, num;
+    while(range.claim(first, num)) {}
+
+    range.reset(0, 20, 5);
+    EXPECT_EQ(4, range.get_chunks_num());
+    ASSERT_TRUE(range.claim(first, num));
+    EXPECT_EQ(0, first);
+    EXPECT_EQ(5, num);
+}
+
+TEST(ChunkedRangeTest, ConcurrentClaim)
+{
+    const int ITEMS_NUM = 10007;
+    const int THREADS_NUM = 4;
+    std::atomic<int> * claims_counts = new std::atomic<int>[ITEMS_NUM];
+    for(int i = 0; i < ITEMS_NUM; ++i)
+        claims_counts[i] = 0;
+
+    ChunkedRange range;
+    range.reset(0, ITEMS_NUM, 16);
+
+    std::thread threads[THREADS_NUM];
+    for(int i = 0; i < THREADS_NUM; ++i)
+    {
+        threads[i] = std::thread([&range, claims_counts]()
+        {
+            int first, num;
+            while(range.claim(first, num))
+            {
+                for(int j = first; j < first + num; ++j)
+                    ++claims_counts[j];
+            }
+        });
+    }
+    for(int i = 0; i < THREADS_NUM; ++i)
+        threads[i].join();
+
+    // each item is claimed exactly once
+    for(int i = 0; i < ITEMS_NUM; ++i)
+        EXPECT_EQ(1, claims_counts[i]);
+    delete[] claims_counts;
+}
@@ -12,7 +12,7 @@ TEST(FloatingPointTest, Sign)
 
 TEST(FloatingPointTest, CubeRoot)
 {
-    EXPECT_DOUBLE_EQ( 2, cube_root(8) );
-    EXPECT_DOUBLE_EQ( 0, cube_root(0) );
-    EXPECT_DOUBLE_EQ( -6, cube_root(-216) );
+    EXPECT_REAL_EQ( 2, cube_root(8) );
+    EXPECT_REAL_EQ( 0, cube_root(0) );
+    EXPECT_REAL_EQ( -6, cube_root(-216) );
 }
@@ -0,0 +1,119 @@
+#include "tools_tester.h"
+#include "Parallel/lock_free_result_queue.h"
+#include <thread>
+#include <atomic>
+
+using namespace CrashAndSqueeze::Parallel;
+
+TEST(LockFreeResultQueueTest, Init)
+{
+    LockFreeResultQueue<int> queue(5);
+    int item;
+    // size is rounded up to a power of 2
+    EXPECT_EQ(8, queue.get_max_size());
+    EXPECT_TRUE(queue.is_empty());
+    EXPECT_FALSE(queue.pop(item));
+}
+
+TEST(LockFreeResultQueueTest, PushPop)
+{
+    LockFreeResultQueue<int> queue(4);
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_FALSE(queue.is_empty());
+
+    int item;
+    ASSERT_TRUE(queue.pop(item));
+    EXPECT_EQ(1, item);
+    ASSERT_TRUE(queue.pop(item));
+    EXPECT_EQ(2, item);
+    EXPECT_FALSE(queue.pop(item));
+    EXPECT_TRUE(queue.is_empty());
+}
+
+TEST(LockFreeResultQueueTest, Full)
+{
+    LockFreeResultQueue<int> queue(4);
+    for(int i = 0; i < 4; ++i)
+        EXPECT_TRUE(queue.push(i));
+    EXPECT_FALSE(queue.push(4));
+
+    // the freed cell can be used again
+    int item;
+    ASSERT_TRUE(queue.pop(item));
+    EXPECT_EQ(0, item);
+    EXPECT_TRUE(queue.push(4));
+    for(int i = 1; i <= 4; ++i)
+    {
+        ASSERT_TRUE(queue.pop(item));
+        EXPECT_EQ(i, item);
+    }
+}
+
+TEST(LockFreeResultQueueTest, WrapAround)
+{
+    LockFreeResultQueue<int> queue(4);
+    int item;
+    for(int i = 0; i < 100; ++i)
+    {
+        ASSERT_TRUE(queue.push(i));
+        ASSERT_TRUE(queue.push(-i));
+        ASSERT_TRUE(queue.pop(item));
+        EXPECT_EQ(i, item);
+        ASSERT_TRUE(queue.pop(item));
+        EXPECT_EQ(-i, item);
+    }
+    EXPECT_TRUE(queue.is_empty());
+}
+
+TEST(LockFreeResultQueueTest, ConcurrentPush)
+{
+    const int THREADS_NUM = 4;
+    const int ITEMS_PER_THREAD = 10000;
+    const int ITEMS_NUM = THREADS_NUM*ITEMS_PER_THREAD;
+    // smaller than the number of items, so that pushing threads have to wait for popping
+    LockFreeResultQueue<int> queue(256);
+
+    std::thread threads[THREADS_NUM];
+    for(int i = 0; i < THREADS_NUM; ++i)
+    {
+        threads[i] = std::thread([&queue, i, ITEMS_PER_THREAD]()
+        {
+            for(int j = 0; j < ITEMS_PER_THREAD; ++j)
+            {
+                while( ! queue.push(i*ITEMS_PER_THREAD + j) )
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    // each item is popped exactly once, and items of one thread are popped in order of pushing
+    int * pops_counts = new int[ITEMS_NUM];
+    for(int i = 0; i < ITEMS_NUM; ++i)
+        pops_counts[i] = 0;
+    int last_items[THREADS_NUM];
+    for(int i = 0; i < THREADS_NUM; ++i)
+        last_items[i] = -1;
+
+    int item;
+    for(int popped = 0; popped < ITEMS_NUM; )
+    {
+        if( ! queue.pop(item) )
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_TRUE(item >= 0 && item < ITEMS_NUM);
+        ++pops_counts[item];
+        EXPECT_LT(last_items[item / ITEMS_PER_THREAD], item);
+        last_items[item / ITEMS_PER_THREAD] = item;
+        ++popped;
+    }
+    for(int i = 0; i < THREADS_NUM; ++i)
+        threads[i].join();
+
+    for(int i = 0; i < ITEMS_NUM; ++i)
+        EXPECT_EQ(1, pops_counts[i]);
+    EXPECT_TRUE(queue.is_empty());
+    delete[] pops_counts;
+}
@@ -0,0 +1,155 @@
+#include "tools_tester.h"
+#include "Parallel/lock_free_task_queue.h"
+#include "Parallel/std_thread_prim.h"
+#include <thread>
+#include <atomic>
+
+using namespace CrashAndSqueeze::Parallel;
+
+namespace
+{
+    class CountingTask : public AbstractTask
+    {
+    public:
+        std::atomic<int> executions_count;
+        CountingTask() : executions_count(0) {}
+    protected:
+        virtual void execute() { ++executions_count; }
+    };
+}
+
+class LockFreeTaskQueueTest : public ::testing::Test
+{
+protected:
+    StdThreadFactory factory;
+    CountingTask t1, t2;
+
+    static const int TQ_SIZE = 10;
+    LockFreeTaskQueue *tq;
+    LockFreeTaskQueue *small_queue;
+
+    virtual void SetUp()
+    {
+        set_tester_err_callback();
+        tq = new LockFreeTaskQueue(TQ_SIZE, &factory);
+        small_queue = new LockFreeTaskQueue(1, &factory);
+    }
+
+    virtual void TearDown()
+    {
+        delete tq;
+        delete small_queue;
+        unset_tester_err_callback();
+    }
+};
+
+TEST_F(LockFreeTaskQueueTest, Init)
+{
+    EXPECT_TRUE(tq->is_empty());
+    EXPECT_FALSE(tq->is_full());
+    EXPECT_FALSE(tq->wait_for_tasks(0));
+}
+
+TEST_F(LockFreeTaskQueueTest, PushNPop)
+{
+    tq->push(&t1);
+    tq->push(&t2);
+    EXPECT_FALSE(tq->is_empty());
+    EXPECT_TRUE(tq->wait_for_tasks(0));
+    EXPECT_EQ(&t1, tq->pop());
+    EXPECT_EQ(&t2, tq->pop());
+    EXPECT_TRUE(tq->is_empty());
+    EXPECT_FALSE(tq->wait_for_tasks(0));
+    EXPECT_EQ(NULL, tq->pop());
+}
+
+TEST_F(LockFreeTaskQueueTest, PushToFull)
+{
+    small_queue->push(&t1);
+    EXPECT_THROW( small_queue->push(&t2), ToolsTesterException );
+}
+
+TEST_F(LockFreeTaskQueueTest, PushAfterAllPopped)
+{
+    small_queue->push(&t1);
+    small_queue->pop();
+    // all tasks are popped, so the queue is reused from the beginning
+    small_queue->push(&t2);
+    EXPECT_EQ(&t2, small_queue->pop());
+}
+
+TEST_F(LockFreeTaskQueueTest, Reset)
+{
+    small_queue->push(&t1);
+    small_queue->pop()->complete();
+
+    // Here the queue is empty, but it is "full" because adding index has reached the end
+    EXPECT_TRUE(small_queue->is_empty());
+    EXPECT_TRUE(small_queue->is_full());
+    small_queue->reset();
+    // After we reset() the queue, popped tasks return and become incomplete again
+    EXPECT_FALSE(small_queue->is_empty());
+    EXPECT_TRUE(small_queue->is_full());
+    EXPECT_FALSE(small_queue->pop()->is_complete());
+}
+
+TEST_F(LockFreeTaskQueueTest, Clear)
+{
+    tq->push(&t1);
+    tq->clear();
+
+    EXPECT_TRUE(tq->is_empty());
+    EXPECT_EQ( NULL, tq->pop() );
+}
+
+TEST_F(LockFreeTaskQueueTest, ConcurrentPop)
+{
+    const int TASKS_NUM = 10000;
+    const int THREADS_NUM = 4;
+    CountingTask * tasks = new CountingTask[TASKS_NUM];
+    LockFreeTaskQueue queue(TASKS_NUM, &factory);
+
+    std::atomic<bool> all_pushed(false);
+    std::thread threads[THREADS_NUM];
+    for(int i = 0; i < THREADS_NUM; ++i)
+    {
+        threads[i] = std::thread([&queue, &all_pushed]()
+        {
+            while( ! all_pushed )
+            {
+                if( false == queue.wait_for_tasks(1) )
+                    continue;
+                AbstractTask * task;
+                while( NULL != (task = queue.pop()) )
+                    task->complete();
+            }
+        });
+    }
+    for(int i = 0; i < TASKS_NUM; ++i)
+        queue.push(&tasks[i], i % 100 == 0);
+    all_pushed = true;
+
+    for(int i = 0; i < THREADS_NUM; ++i)
+        threads[i].join();
+
+    // some tasks may be left in the queue if workers finished before popping them
+    AbstractTask * task;
+    while( NULL != (task = queue.pop()) )
+        task->complete();
+
+    for(int i = 0; i < TASKS_NUM; ++i)
+        EXPECT_EQ(1, tasks[i].executions_count);
+    delete[] tasks;
+}
+
+TEST_F(LockFreeTaskQueueTest, CreatedByFactory)
+{
+    ITaskQueue * queue = factory.create_task_queue(TQ_SIZE, NULL);
+    EXPECT_TRUE(NULL != dynamic_cast<LockFreeTaskQueue*>(queue));
+    factory.destroy_task_queue(queue);
+
+    StdThreadFactory locking_factory(false);
+    queue = locking_factory.create_task_queue(TQ_SIZE, NULL);
+    EXPECT_TRUE(NULL != dynamic_cast<TaskQueue*>(queue));
+    locking_factory.destroy_task_queue(queue);
+}
@@ -3,6 +3,11 @@
 
 using namespace ::CrashAndSqueeze::Math;
 
+namespace
+{
+    // exp of Real (in single precision, C library has no such overload)
+    Real real_exp(Real value) { return exp(value); }
+}
 
 class MatrixTest : public ::testing::Test
 {
@@ -497,14 +502,14 @@ TEST_F(MatrixTest, DiagonalizationOfDiagonalized)
 
 TEST_F(MatrixTest, FunctionOfDiagonalized)
 {
-    EXPECT_EQ(exp_diagonal, diagonal.compute_function(exp));
+    EXPECT_EQ(exp_diagonal, diagonal.compute_function(real_exp));
 }
 
 TEST_F(MatrixTest, FunctionOfArbitrary)
 {
     const Matrix argument = orthogonal.transposed()*diagonal*orthogonal; // transform diagonal matrix somehow
     const Matrix expected = orthogonal.transposed()*exp_diagonal*orthogonal; // transform result the same way
-    EXPECT_EQ(expected, argument.compute_function(exp, 3));
+    EXPECT_EQ(expected, argument.compute_function(real_exp, 3));
 }
 
 TEST_F(MatrixTest, BadFunction)
@@ -524,7 +529,7 @@ void MatrixTest::test_polar_decomposition(Matrix const &matrix, int rotations, R
     
     if ( !equal(0, matrix.determinant()) )
     {
-        EXPECT_NEAR(1, abs(R.determinant()), accuracy);
+        EXPECT_NEAR(1, abs(R.determinant()), maximum(accuracy, MIN_TEST_ACCURACY));
     }
     
     Matrix S_simmetrized = S;
@@ -546,3 +551,81 @@ TEST_F(MatrixTest, PolarDecompositionOfUninvertible)
 {
     test_polar_decomposition(m1, 9, 1e-10);
 }
+
+TEST_F(MatrixTest, AxisRotation)
+{
+    const Real PI = 3.14159265358979;
+    Matrix R = Matrix::axis_rotation(Vector(0, 0, 1), PI/2);
+    EXPECT_EQ( Vector(0, 1, 0), R*Vector(1, 0, 0) );
+    EXPECT_EQ( Vector(-1, 0, 0), R*Vector(0, 1, 0) );
+    EXPECT_EQ( Vector(0, 0, 1), R*Vector(0, 0, 1) );
+}
+
+TEST_F(MatrixTest, ExtractRotation)
+{
+    const Matrix rotation = -orthogonal;
+    const Matrix symmetric(  3, 0.5, 0.2,
+                           0.5,   2, 0.1,
+                           0.2, 0.1,   1 );
+    Matrix R = I;
+    EXPECT_GT( DEFAULT_ROTATION_EXTRACTION_ITERATIONS, (rotation*symmetric).extract_rotation(R) );
+    EXPECT_EQ( rotation, R );
+    EXPECT_NEAR( 1, R.determinant(), maximum(DEFAULT_REAL_PRECISION, MIN_TEST_ACCURACY) );
+}
+
+TEST_F(MatrixTest, ExtractRotationWarmStarted)
+{
+    const Matrix rotation = -orthogonal;
+    const Matrix symmetric(  3, 0.5, 0.2,
+                           0.5,   2, 0.1,
+                           0.2, 0.1,   1 );
+    const Matrix matrix = rotation*symmetric;
+
+    Matrix R = rotation;
+    EXPECT_EQ( 0, matrix.extract_rotation(R) );
+    EXPECT_EQ( rotation, R );
+
+    // a small change of rotation is found in a few iterations
+    R = Matrix::axis_rotation(Vector(1, 2, 3).normalized(), 0.05)*rotation;
+    EXPECT_GT( DEFAULT_ROTATION_EXTRACTION_ITERATIONS, matrix.extract_rotation(R) );
+    EXPECT_EQ( rotation, R );
+}
+
+TEST_F(MatrixTest, ExtractRotationManyWarmStarts)
+{
+    const Matrix symmetric(  3, 0.5, 0.2,
+                           0.5,   2, 0.1,
+                           0.2, 0.1,   1 );
+    const Real accuracy = maximum(DEFAULT_REAL_PRECISION, MIN_TEST_ACCURACY);
+
+    // a slowly rotating deformed matrix, tracked by one or two iterations per call, like in simulation
+    Matrix R = I;
+    for(int step = 0; step < 10000; ++step)
+    {
+        const Matrix rotation = Matrix::axis_rotation(Vector(1, 2, 3).normalized(), 0.01*step);
+        (rotation*symmetric).extract_rotation(R, 1 + step % 2);
+
+        // R stays a rotation
+        EXPECT_EQ( I, R.transposed()*R ) << "step " << step;
+        EXPECT_NEAR( 1, R.determinant(), accuracy ) << "step " << step;
+    }
+
+    // even after a step from the opposite rotation (where step is the largest)
+    R = -I;
+    R.set_at(2, 2, 1);
+    symmetric.extract_rotation(R, 1);
+    EXPECT_EQ( I, R.transposed()*R );
+    EXPECT_NEAR( 1, R.determinant(), accuracy );
+}
+
+TEST_F(MatrixTest, ExtractRotationLikePolarDecomposition)
+{
+    Matrix R_polar;
+    Matrix S_polar;
+    m2.do_polar_decomposition(R_polar, S_polar, 20, 20); // m2 has negative determinant...
+    Matrix matrix = -m2; // ...and this one has positive
+
+    Matrix R = I;
+    matrix.extract_rotation(R);
+    EXPECT_EQ( -R_polar, R );
+}
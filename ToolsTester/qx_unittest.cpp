@@ -264,3 +264,113 @@ TEST(QxTest, NineMatrixInvert)
     EXPECT_EQ(expected.submatrix(1, 1), m.submatrix(1, 1));
     EXPECT_EQ(expected.submatrix(0, 1), m.submatrix(0, 1));
 }
+
+namespace
+{
+    // points in general position: their trivectors span all 9 dimensions
+    const int SYM_POINTS_NUM = 12;
+    const Vector SYM_POINTS[SYM_POINTS_NUM] = {
+        Vector( 1, 0, 0), Vector( 0, 1, 0), Vector( 0, 0, 1), Vector(-1, 2, 1),
+        Vector( 2,-1, 3), Vector( 1, 1, 1), Vector(-2,-1, 0), Vector( 0, 3,-1),
+        Vector( 1,-2,-2), Vector( 3, 1,-1), Vector(-1, 0, 2), Vector( 2, 2,-3)
+    };
+
+    const Real SYM_ACCURACY = maximum<Real>(1e-7, 1000*MIN_TEST_ACCURACY);
+
+    // expects that a*b*a == a (with accuracy relative to elements of a, because b is regularized)
+    void expect_pseudo_inverse(const NineMatrix & a, const NineMatrix & b)
+    {
+        NineMatrix product = a;
+        product *= b;
+        product *= a;
+        for (int i = 0; i < NineMatrix::SIZE; ++i)
+            for (int j = 0; j < NineMatrix::SIZE; ++j)
+                EXPECT_NEAR(a.get_at(i, j), product.get_at(i, j), SYM_ACCURACY*(1 + fabs(a.get_at(i, j)))) << "at " << i << ", " << j;
+    }
+}
+
+TEST(QxTest, SymNineMatrixOuterProduct)
+{
+    const TriVector tv(Vector(1, 2, 3), Vector(1, 1, -1), Vector(4, -2, 1));
+    SymNineMatrix sym;
+    sym.set_all(0);
+    sym.add_outer_product(tv, 2);
+    sym.add_outer_product(tv, 1);
+    NineMatrix actual;
+    sym.to_nine_matrix(actual);
+
+    EXPECT_TRUE(NineMatrix(tv*3, tv) == actual);
+    EXPECT_EQ(sym.get_at(2, 7), sym.get_at(7, 2));
+}
+
+TEST(QxTest, SymNineMatrixMulTriMatrix)
+{
+    const TriVector tv(Vector(1, 2, 3), Vector(1, 1, -1), Vector(4, -2, 1));
+    const NineMatrix nm(tv, tv);
+    SymNineMatrix sym;
+    sym.set_all(0);
+    sym.add_outer_product(tv, 1);
+    const TriMatrix tm(
+        Matrix(1, 2, 0,
+               0, 1, 0,
+               3, 0, 1),
+        Matrix(1, 2, 3,
+               3, 4, 5,
+               3, 2, 1),
+        Matrix(1, 1,-1,
+               0,-1, 1,
+               0, 0,-1)
+    );
+    TriMatrix expected;
+    nm.left_mult_by(tm, expected);
+    TriMatrix actual;
+    sym.left_mult_by(tm, actual);
+    EXPECT_EQ(expected.matrices[0], actual.matrices[0]);
+    EXPECT_EQ(expected.matrices[1], actual.matrices[1]);
+    EXPECT_EQ(expected.matrices[2], actual.matrices[2]);
+}
+
+TEST(QxTest, SymNineMatrixInvert)
+{
+    SymNineMatrix sym;
+    sym.set_all(0);
+    for (int i = 0; i < SYM_POINTS_NUM; ++i)
+        sym.add_outer_product(TriVector(SYM_POINTS[i]), i + 1);
+    NineMatrix original;
+    sym.to_nine_matrix(original);
+
+    EXPECT_TRUE(sym.invert_sym());
+    NineMatrix inverted;
+    sym.to_nine_matrix(inverted);
+
+    NineMatrix product = original;
+    product *= inverted;
+    for (int i = 0; i < NineMatrix::SIZE; ++i)
+        for (int j = 0; j < NineMatrix::SIZE; ++j)
+            EXPECT_NEAR((i == j) ? 1 : 0, product.get_at(i, j), SYM_ACCURACY) << "at " << i << ", " << j;
+}
+
+TEST(QxTest, SymNineMatrixInvertFlat)
+{
+    // points in plane z = 0: terms with z are all zeros, so the matrix is singular
+    SymNineMatrix sym;
+    sym.set_all(0);
+    for (int i = 0; i < SYM_POINTS_NUM; ++i)
+        sym.add_outer_product(TriVector(Vector(SYM_POINTS[i][0], SYM_POINTS[i][1], 0)), 1);
+    NineMatrix original;
+    sym.to_nine_matrix(original);
+
+    EXPECT_TRUE(sym.invert_sym());
+    NineMatrix inverted;
+    sym.to_nine_matrix(inverted);
+    expect_pseudo_inverse(original, inverted);
+}
+
+TEST(QxTest, SymNineMatrixInvertZero)
+{
+    SymNineMatrix sym;
+    sym.set_all(0);
+    EXPECT_TRUE(sym.invert_sym());
+    for (int i = 0; i < NineMatrix::SIZE; ++i)
+        EXPECT_EQ(0, sym.get_at(i, i));
+}
@@ -0,0 +1,168 @@
+#include "tools_tester.h"
+#include "Parallel/std_thread_prim.h"
+#include "Parallel/worker_pool.h"
+#include "Parallel/task_queue.h"
+#include <atomic>
+
+using namespace CrashAndSqueeze::Parallel;
+
+namespace
+{
+    class CountingTask : public AbstractTask
+    {
+    private:
+        std::atomic<int> * counter;
+    protected:
+        virtual void execute() { ++(*counter); }
+    public:
+        CountingTask() : counter(NULL) {}
+        void setup(std::atomic<int> * counter) { this->counter = counter; }
+    };
+
+    class FailingTask : public AbstractTask
+    {
+    protected:
+        virtual void execute() { Logger::error("FailingTask failed", __FILE__, __LINE__); }
+    };
+
+    // the simplest executor: just a queue of tasks
+    class QueueExecutor : public ITaskExecutor
+    {
+    private:
+        TaskQueue queue;
+    public:
+        std::atomic<int> aborts_count;
+
+        QueueExecutor(int max_size, IPrimFactory * prim_factory) : queue(max_size, prim_factory), aborts_count(0) {}
+
+        void push(AbstractTask * task, bool set_event) { queue.push(task, set_event); }
+
+        virtual void wait_for_tasks() { queue.wait_for_tasks(); }
+        virtual bool wait_for_tasks(unsigned milliseconds) { return queue.wait_for_tasks(milliseconds); }
+        virtual bool complete_next_task()
+        {
+            AbstractTask * task = queue.pop();
+            if(NULL == task)
+                return false;
+            task->complete();
+            return true;
+        }
+        virtual void abort() { ++aborts_count; queue.clear(); }
+    };
+
+    const unsigned TEST_TIMEOUT_MS = 5000;
+}
+
+class StdThreadPrimTest : public ::testing::Test
+{
+protected:
+    StdThreadFactory factory;
+
+    virtual void SetUp()
+    {
+        set_tester_err_callback();
+    }
+
+    virtual void TearDown()
+    {
+        unset_tester_err_callback();
+    }
+};
+
+TEST_F(StdThreadPrimTest, Event)
+{
+    IEvent * event = factory.create_event(false);
+    EXPECT_FALSE(event->wait_for(1));
+    event->set();
+    EXPECT_TRUE(event->wait_for(1));
+    event->wait();
+    event->unset();
+    EXPECT_FALSE(event->wait_for(0));
+    factory.destroy_event(event);
+}
+
+TEST_F(StdThreadPrimTest, EventSet)
+{
+    const int SIZE = 3;
+    IEventSet * event_set = factory.create_event_set(SIZE, true);
+    EXPECT_TRUE(event_set->wait_for(1));
+    event_set->unset(1);
+    EXPECT_FALSE(event_set->wait_for(1));
+    EXPECT_TRUE(event_set->wait_for(0, 1));
+    EXPECT_FALSE(event_set->wait_for(1, 1));
+    event_set->set(1);
+    EXPECT_TRUE(event_set->wait_for(1));
+
+    event_set->unset();
+    for(int i = 0; i < SIZE; ++i)
+        EXPECT_FALSE(event_set->wait_for(i, 0));
+    event_set->set();
+    event_set->wait();
+
+    EXPECT_THROW(event_set->set(SIZE), ToolsTesterException);
+    factory.destroy_event_set(event_set);
+}
+
+TEST_F(StdThreadPrimTest, EventSetFromOtherThread)
+{
+    const int SIZE = 8;
+    IEventSet * event_set = factory.create_event_set(SIZE, false);
+    void (IEventSet::*set_one)(int) = &IEventSet::set;
+    std::thread setters[SIZE];
+    for(int i = 0; i < SIZE; ++i)
+        setters[i] = std::thread(set_one, event_set, i);
+
+    EXPECT_TRUE(event_set->wait_for(TEST_TIMEOUT_MS));
+
+    for(int i = 0; i < SIZE; ++i)
+        setters[i].join();
+    factory.destroy_event_set(event_set);
+}
+
+TEST_F(StdThreadPrimTest, WorkerPoolCompletesAllTasks)
+{
+    const int TASKS_NUM = 1000;
+    std::atomic<int> counter(0);
+    CountingTask * tasks = new CountingTask[TASKS_NUM];
+    QueueExecutor executor(TASKS_NUM, &factory);
+
+    WorkerPool pool;
+    pool.add_executor(&executor);
+    pool.start(4);
+    EXPECT_EQ(4, pool.get_threads_num());
+
+    for(int i = 0; i < TASKS_NUM; ++i)
+    {
+        tasks[i].setup(&counter);
+        executor.push(&tasks[i], i == TASKS_NUM - 1);
+    }
+
+    for(unsigned waited = 0; counter < TASKS_NUM && waited < TEST_TIMEOUT_MS; ++waited)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    pool.stop();
+    EXPECT_FALSE(pool.is_started());
+    EXPECT_EQ(TASKS_NUM, counter);
+    EXPECT_EQ(0, pool.get_errors_count());
+    for(int i = 0; i < TASKS_NUM; ++i)
+        EXPECT_TRUE(tasks[i].is_complete());
+    delete[] tasks;
+}
+
+TEST_F(StdThreadPrimTest, WorkerPoolAbortsOnError)
+{
+    FailingTask task;
+    QueueExecutor executor(1, &factory);
+    executor.push(&task, true);
+
+    WorkerPool pool;
+    pool.add_executor(&executor);
+    pool.start(2);
+
+    for(unsigned waited = 0; 0 == executor.aborts_count && waited < TEST_TIMEOUT_MS; ++waited)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    pool.stop();
+    EXPECT_EQ(1, executor.aborts_count);
+    EXPECT_EQ(1, pool.get_errors_count());
+}
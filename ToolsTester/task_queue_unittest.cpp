@@ -91,4 +91,48 @@ TEST_F(TaskQueueTest, Clear)
 
     EXPECT_TRUE(tq->is_empty());
     EXPECT_EQ( NULL, tq->pop() );
+}
+
+TEST_F(TaskQueueTest, SuccessorPushedAfterAllPredecessors)
+{
+    DummyTask t3;
+    AbstractTask * successors[] = { &t3 };
+    t1.set_successors(successors, 1, tq);
+    t2.set_successors(successors, 1, tq);
+    EXPECT_EQ(2, t3.get_predecessors_num());
+
+    t1.complete();
+    EXPECT_TRUE(tq->is_empty());
+    t2.complete();
+    EXPECT_EQ(&t3, tq->pop());
+    EXPECT_TRUE(tq->is_empty());
+
+    // without resetting dependencies the successor is not pushed again...
+    t1.complete();
+    t2.complete();
+    EXPECT_TRUE(tq->is_empty());
+    // ...and after resetting it waits for both predecessors again
+    t3.reset_dependencies();
+    t1.complete();
+    EXPECT_TRUE(tq->is_empty());
+    t2.complete();
+    EXPECT_EQ(&t3, tq->pop());
+}
+
+TEST_F(TaskQueueTest, SuccessorsReplaced)
+{
+    DummyTask t3, t4;
+    AbstractTask * successors[] = { &t3, &t4 };
+    t1.set_successors(successors, 2, tq);
+    t2.set_successors(successors, 1, tq);
+    EXPECT_EQ(2, t3.get_predecessors_num());
+    EXPECT_EQ(1, t4.get_predecessors_num());
+
+    t2.set_successors(NULL, 0, tq);
+    EXPECT_EQ(1, t3.get_predecessors_num());
+
+    t1.complete();
+    EXPECT_EQ(&t3, tq->pop());
+    EXPECT_EQ(&t4, tq->pop());
+    EXPECT_TRUE(tq->is_empty());
 }
\ No newline at end of file
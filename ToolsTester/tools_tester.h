@@ -17,6 +17,22 @@ inline std::ostream &operator<<(std::ostream &stream, const Matrix &m)
                   <<  "{" << m.get_at(2,0) << ", " << m.get_at(2,1) << ", " << m.get_at(2,2) << "}}";
 }
 
+// EXPECT_DOUBLE_EQ or EXPECT_FLOAT_EQ, depending on precision of Real
+#if CAS_SINGLE_PRECISION
+#define EXPECT_REAL_EQ EXPECT_FLOAT_EQ
+#define ASSERT_REAL_EQ ASSERT_FLOAT_EQ
+#else
+#define EXPECT_REAL_EQ EXPECT_DOUBLE_EQ
+#define ASSERT_REAL_EQ ASSERT_DOUBLE_EQ
+#endif // CAS_SINGLE_PRECISION
+
+// the best accuracy which can be checked in tests (with given precision of Real)
+#if CAS_SINGLE_PRECISION
+const Real MIN_TEST_ACCURACY = 1e-6f;
+#else
+const Real MIN_TEST_ACCURACY = 0;
+#endif // CAS_SINGLE_PRECISION
+
 class ToolsTesterException {};
 
 extern CallbackAction tools_tester_err_action;
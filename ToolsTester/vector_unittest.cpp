@@ -19,7 +19,7 @@ TEST(VectorTest, Construct)
     const Point p(2, 3, 4.8);
     EXPECT_EQ( 2.0, p[0] );
     EXPECT_EQ( 3.0, p[1] );
-    EXPECT_EQ( 4.8, p[2] );
+    EXPECT_REAL_EQ( 4.8, p[2] );
 }
 
 TEST(VectorTest, CopyConstruct)
@@ -148,7 +148,7 @@ TEST(VectorTest, ScalarMultiply)
     Point p1(a, b, c);
     Point p2(d, e, f);
 
-    EXPECT_DOUBLE_EQ( a*d + b*e + c*f, p1*p2 );
+    EXPECT_REAL_EQ( a*d + b*e + c*f, p1*p2 );
 }
 
 TEST(VectorTest, SquaredNorm)
@@ -156,14 +156,14 @@ TEST(VectorTest, SquaredNorm)
     const Point p1(1, 2, 3);
     const Point p2(1, -1, 0);
 
-    EXPECT_DOUBLE_EQ( 14, p1.squared_norm() );
-    EXPECT_DOUBLE_EQ(  2, p2.squared_norm() );
+    EXPECT_REAL_EQ( 14, p1.squared_norm() );
+    EXPECT_REAL_EQ(  2, p2.squared_norm() );
 }
 
 TEST(VectorTest, Norm)
 {
     const Point p(3, -4, 0);
-    EXPECT_DOUBLE_EQ( 5, p.norm() );
+    EXPECT_REAL_EQ( 5, p.norm() );
 }
 
 TEST(VectorTest, Normalize)
@@ -193,7 +193,7 @@ TEST(VectorTest, Distance)
 {
     const Point p1(1, 2, -3);
     const Point p2(4, -2, -3);
-    EXPECT_DOUBLE_EQ( 5, distance( p1, p2 ) );
+    EXPECT_REAL_EQ( 5, distance( p1, p2 ) );
 }
 
 TEST(VectorTest, VectorMultiply)
@@ -257,7 +257,7 @@ TEST(VectorTest, ProjectOrthogonal)
     ASSERT_TRUE( normal.is_orthogonal_to(vector) ); // self-check
 
     Vector normal_component;
-    EXPECT_DOUBLE_EQ( 0, vector.project_to(normal, & normal_component) );
+    EXPECT_REAL_EQ( 0, vector.project_to(normal, & normal_component) );
     EXPECT_EQ(vector, normal_component);
 }
 
@@ -268,9 +268,9 @@ TEST(VectorTest, ProjectToAxes)
     const Vector y(0, 1, 0);
     const Vector z(0, 0, 1);
     
-    EXPECT_DOUBLE_EQ( vector[0], vector.project_to(x) );
-    EXPECT_DOUBLE_EQ( vector[1], vector.project_to(y) );
-    EXPECT_DOUBLE_EQ( vector[2], vector.project_to(z) );
+    EXPECT_REAL_EQ( vector[0], vector.project_to(x) );
+    EXPECT_REAL_EQ( vector[1], vector.project_to(y) );
+    EXPECT_REAL_EQ( vector[2], vector.project_to(z) );
 }
 
 TEST(VectorTest, ProjectToArbitrary)
@@ -279,6 +279,6 @@ TEST(VectorTest, ProjectToArbitrary)
     const Vector direction(1, 1, 0);
     
     Vector normal_component;
-    EXPECT_DOUBLE_EQ( sqrt(2.)/2, vector.project_to(direction, & normal_component) );
+    EXPECT_REAL_EQ( sqrt(2.)/2, vector.project_to(direction, & normal_component) );
     EXPECT_EQ( Vector( 0.5, -0.5, 1), normal_component );
 }
@@ -0,0 +1,290 @@
+#include "tools_tester.h"
+#include "Parallel/work_stealing_scheduler.h"
+#include <atomic>
+#include <chrono>
+
+using namespace CrashAndSqueeze::Parallel;
+
+namespace
+{
+    class CountingTask : public AbstractTask
+    {
+    public:
+        std::atomic<int> executions_count;
+        CountingTask() : executions_count(0) {}
+    protected:
+        virtual void execute() { ++executions_count; }
+    };
+
+    // a task remembering the order of its start among tasks sharing the counter
+    class OrderedTask : public AbstractTask
+    {
+    private:
+        std::atomic<int> * counter;
+    public:
+        int order;
+        OrderedTask() : counter(NULL), order(-1) {}
+        void setup(std::atomic<int> * counter) { this->counter = counter; }
+    protected:
+        virtual void execute() { order = (*counter)++; }
+    };
+
+    class FailingTask : public AbstractTask
+    {
+    protected:
+        virtual void execute() { Logger::error("FailingTask failed", __FILE__, __LINE__); }
+    };
+
+    // an executor having a queue created by given factory
+    class QueueExecutor : public ITaskExecutor
+    {
+    private:
+        IPrimFactory * factory;
+    public:
+        ITaskQueue * queue;
+        std::atomic<int> aborts_count;
+
+        QueueExecutor(int max_size, IPrimFactory * factory) : factory(factory), aborts_count(0)
+        {
+            queue = factory->create_task_queue(max_size, this);
+        }
+
+        virtual void wait_for_tasks() { queue->wait_for_tasks(); }
+        virtual bool wait_for_tasks(unsigned milliseconds) { return queue->wait_for_tasks(milliseconds); }
+        virtual bool complete_next_task()
+        {
+            AbstractTask * task = queue->pop();
+            if(NULL == task)
+                return false;
+            task->complete();
+            return true;
+        }
+        virtual void abort() { ++aborts_count; queue->clear(); }
+
+        ~QueueExecutor() { factory->destroy_task_queue(queue); }
+    };
+
+    const unsigned TEST_TIMEOUT_MS = 5000;
+
+    template<class T>
+    bool all_complete(T * tasks, int tasks_num)
+    {
+        for(int i = 0; i < tasks_num; ++i)
+        {
+            if( ! tasks[i].is_complete() )
+                return false;
+        }
+        return true;
+    }
+}
+
+class WorkStealingSchedulerTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        set_tester_err_callback();
+    }
+
+    virtual void TearDown()
+    {
+        unset_tester_err_callback();
+    }
+};
+
+TEST_F(WorkStealingSchedulerTest, PopWithoutWorkers)
+{
+    WorkStealingScheduler scheduler(2);
+    CountingTask t1, t2;
+    QueueExecutor executor(2, &scheduler);
+
+    executor.queue->push(&t1, false);
+    EXPECT_FALSE(executor.queue->is_empty());
+    executor.queue->push(&t2, true);
+    EXPECT_TRUE(executor.queue->wait_for_tasks(0));
+
+    EXPECT_EQ(&t1, executor.queue->pop());
+    EXPECT_EQ(&t2, executor.queue->pop());
+    EXPECT_EQ(NULL, executor.queue->pop());
+    EXPECT_TRUE(executor.queue->is_empty());
+    EXPECT_FALSE(executor.queue->wait_for_tasks(0));
+}
+
+TEST_F(WorkStealingSchedulerTest, ResetAndClear)
+{
+    WorkStealingScheduler scheduler(2);
+    CountingTask t1;
+    QueueExecutor executor(1, &scheduler);
+
+    executor.queue->push(&t1);
+    EXPECT_THROW(executor.queue->push(&t1), ToolsTesterException);
+    executor.queue->pop()->complete();
+    EXPECT_TRUE(executor.queue->is_full());
+
+    executor.queue->reset();
+    EXPECT_FALSE(executor.queue->is_empty());
+    EXPECT_FALSE(t1.is_complete());
+
+    executor.queue->clear();
+    EXPECT_TRUE(executor.queue->is_empty());
+    EXPECT_EQ(NULL, executor.queue->pop());
+}
+
+TEST_F(WorkStealingSchedulerTest, CompletesTasksOfManyExecutors)
+{
+    const int EXECUTORS_NUM = 8;
+    const int TASKS_NUM = 500;
+    WorkStealingScheduler scheduler(4);
+    EXPECT_EQ(4, scheduler.get_threads_num());
+
+    QueueExecutor * executors[EXECUTORS_NUM];
+    CountingTask * tasks[EXECUTORS_NUM];
+    for(int i = 0; i < EXECUTORS_NUM; ++i)
+    {
+        executors[i] = new QueueExecutor(TASKS_NUM, &scheduler);
+        tasks[i] = new CountingTask[TASKS_NUM];
+    }
+
+    scheduler.start();
+    for(int i = 0; i < EXECUTORS_NUM; ++i)
+    {
+        for(int j = 0; j < TASKS_NUM; ++j)
+            executors[i]->queue->push(&tasks[i][j], j == TASKS_NUM - 1);
+    }
+    // the main thread may help too
+    while( executors[0]->complete_next_task() ) {}
+
+    for(int i = 0; i < EXECUTORS_NUM; ++i)
+    {
+        for(unsigned waited = 0; ! all_complete(tasks[i], TASKS_NUM) && waited < TEST_TIMEOUT_MS; ++waited)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    scheduler.stop();
+    EXPECT_FALSE(scheduler.is_started());
+
+    for(int i = 0; i < EXECUTORS_NUM; ++i)
+    {
+        EXPECT_TRUE(executors[i]->queue->is_empty());
+        for(int j = 0; j < TASKS_NUM; ++j)
+            EXPECT_EQ(1, tasks[i][j].executions_count);
+        delete executors[i];
+        delete[] tasks[i];
+    }
+    EXPECT_EQ(0, scheduler.get_errors_count());
+}
+
+TEST_F(WorkStealingSchedulerTest, AbortsOwnerOnError)
+{
+    WorkStealingScheduler scheduler(2);
+    FailingTask failing_task;
+    CountingTask task;
+    QueueExecutor failing(1, &scheduler);
+    QueueExecutor other(1, &scheduler);
+
+    scheduler.start();
+    failing.queue->push(&failing_task);
+    other.queue->push(&task);
+
+    for(unsigned waited = 0; (0 == failing.aborts_count || ! task.is_complete()) && waited < TEST_TIMEOUT_MS; ++waited)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    scheduler.stop();
+
+    EXPECT_EQ(1, failing.aborts_count);
+    EXPECT_EQ(0, other.aborts_count);
+    EXPECT_TRUE(task.is_complete());
+    EXPECT_EQ(1, scheduler.get_errors_count());
+}
+
+TEST_F(WorkStealingSchedulerTest, WorkerCompletesReleasedSuccessorsFirst)
+{
+    const int OTHER_TASKS_NUM = 10;
+    const int SUCCESSORS_NUM = 3;
+    WorkStealingScheduler scheduler(1);
+    QueueExecutor executor(1 + OTHER_TASKS_NUM + SUCCESSORS_NUM, &scheduler);
+    std::atomic<int> counter(0);
+
+    OrderedTask predecessor;
+    OrderedTask others[OTHER_TASKS_NUM];
+    OrderedTask successors[SUCCESSORS_NUM];
+    AbstractTask * successors_pointers[SUCCESSORS_NUM];
+    predecessor.setup(&counter);
+    for(int i = 0; i < OTHER_TASKS_NUM; ++i)
+        others[i].setup(&counter);
+    for(int i = 0; i < SUCCESSORS_NUM; ++i)
+    {
+        successors[i].setup(&counter);
+        successors_pointers[i] = &successors[i];
+    }
+    predecessor.set_successors(successors_pointers, SUCCESSORS_NUM, executor.queue);
+    for(int i = 0; i < SUCCESSORS_NUM; ++i)
+        successors[i].reset_dependencies();
+
+    // tasks pushed by the main thread are completed in the order of pushing...
+    executor.queue->push(&predecessor, false);
+    for(int i = 0; i < OTHER_TASKS_NUM; ++i)
+        executor.queue->push(&others[i], i == OTHER_TASKS_NUM - 1);
+    scheduler.start();
+    for(unsigned waited = 0; counter < 1 + OTHER_TASKS_NUM + SUCCESSORS_NUM && waited < TEST_TIMEOUT_MS; ++waited)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    scheduler.stop();
+
+    EXPECT_EQ(0, predecessor.order);
+    for(int i = 0; i < OTHER_TASKS_NUM; ++i)
+        EXPECT_EQ(1 + SUCCESSORS_NUM + i, others[i].order);
+    // ...but successors, released by the worker, are completed by it at once, the last released first
+    for(int i = 0; i < SUCCESSORS_NUM; ++i)
+        EXPECT_EQ(SUCCESSORS_NUM - i, successors[i].order);
+    EXPECT_TRUE(executor.queue->is_empty());
+}
+
+TEST_F(WorkStealingSchedulerTest, CompletesTaskGraph)
+{
+    // each task of a layer is a successor of all tasks of the previous one
+    const int LAYERS_NUM = 5;
+    const int LAYER_SIZE = 64;
+    WorkStealingScheduler scheduler(4);
+    QueueExecutor executor(LAYERS_NUM*LAYER_SIZE, &scheduler);
+    std::atomic<int> counter(0);
+
+    OrderedTask tasks[LAYERS_NUM][LAYER_SIZE];
+    AbstractTask * layers[LAYERS_NUM][LAYER_SIZE];
+    for(int l = 0; l < LAYERS_NUM; ++l)
+    {
+        for(int i = 0; i < LAYER_SIZE; ++i)
+        {
+            tasks[l][i].setup(&counter);
+            layers[l][i] = &tasks[l][i];
+        }
+    }
+    for(int l = 0; l + 1 < LAYERS_NUM; ++l)
+    {
+        for(int i = 0; i < LAYER_SIZE; ++i)
+            tasks[l][i].set_successors(layers[l + 1], LAYER_SIZE, executor.queue);
+    }
+    for(int l = 0; l < LAYERS_NUM; ++l)
+    {
+        for(int i = 0; i < LAYER_SIZE; ++i)
+            tasks[l][i].reset_dependencies();
+    }
+
+    scheduler.start();
+    for(int i = 0; i < LAYER_SIZE; ++i)
+        executor.queue->push(&tasks[0][i], i == LAYER_SIZE - 1);
+    for(unsigned waited = 0; ! all_complete(tasks[LAYERS_NUM - 1], LAYER_SIZE) && waited < TEST_TIMEOUT_MS; ++waited)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    scheduler.stop();
+
+    // each task is completed once, and only after all tasks of the previous layer
+    EXPECT_EQ(LAYERS_NUM*LAYER_SIZE, counter);
+    for(int l = 0; l < LAYERS_NUM; ++l)
+    {
+        for(int i = 0; i < LAYER_SIZE; ++i)
+        {
+            EXPECT_TRUE(tasks[l][i].is_complete());
+            EXPECT_LE(l*LAYER_SIZE, tasks[l][i].order);
+            EXPECT_GT((l + 1)*LAYER_SIZE, tasks[l][i].order);
+        }
+    }
+    EXPECT_TRUE(executor.queue->is_empty());
+    EXPECT_EQ(0, scheduler.get_errors_count());
+}